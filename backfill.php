@@ -0,0 +1,61 @@
+<?php
+// backfill.php — попросить устройство дослать архив за период (см. BACKFILL в src/gsm_uplink.cpp)
+// запуск: php backfill.php <device_id> <from> <to>   (from/to — unix-время или дата для strtotime)
+//         php backfill.php <device_id>               — показать текущую просьбу
+//         php backfill.php <device_id> cancel        — снять её
+//
+// просьба уходит устройству в ответах /data и /health (bf_from/bf_to) и снимается,
+// когда оно пришлёт последний кусок POST /backfill
+
+declare(strict_types=1);
+
+require_once __DIR__ . "/config.php";
+require_once __DIR__ . "/db.php";
+
+function parse_ts(string $s): int {
+    if (ctype_digit($s)) return (int)$s;
+    $t = strtotime($s);
+    if ($t === false) {
+        fwrite(STDERR, "bad time: $s\n");
+        exit(2);
+    }
+    return $t;
+}
+
+$device_id = $argv[1] ?? "";
+if ($device_id === "") {
+    fwrite(STDERR, "usage: php backfill.php <device_id> [<from> <to> | cancel]\n");
+    exit(2);
+}
+
+init_db();
+
+if (!is_registered($device_id)) {
+    fwrite(STDERR, "device not registered: $device_id\n");
+    exit(1);
+}
+
+$cur = get_backfill($device_id);
+
+if (!isset($argv[2])) {
+    echo $cur === null
+        ? "no backfill pending\n"
+        : "pending: " . date("Y-m-d H:i:s", $cur["from"]) . " .. " . date("Y-m-d H:i:s", $cur["to"]) . "\n";
+    exit(0);
+}
+
+if ($argv[2] === "cancel") {
+    if ($cur !== null) clear_backfill($device_id, $cur["from"], $cur["to"]);
+    echo "cancelled\n";
+    exit(0);
+}
+
+$from = parse_ts($argv[2]);
+$to   = parse_ts($argv[3] ?? (string)time());
+if ($from > $to) {
+    fwrite(STDERR, "from > to\n");
+    exit(2);
+}
+
+set_backfill($device_id, $from, $to);
+echo "requested: " . date("Y-m-d H:i:s", $from) . " .. " . date("Y-m-d H:i:s", $to) . "\n";
@@ -54,3 +54,58 @@ function aes_decrypt_blob(string $pass, string $blob): array {
 
     return [true, $plain, ""];
 }
+
+/**
+ * Encrypt into the same blob format (used for UDP acks, see udp.php).
+ *
+ * @return string IV(16) || CIPHER || HMAC(32)
+ */
+function aes_encrypt_blob(string $pass, string $plain): string {
+    [$aesKey, $hmacKey] = derive_keys($pass);
+
+    $iv = random_bytes(16);
+    $cipher = openssl_encrypt($plain, 'AES-256-CBC', $aesKey, OPENSSL_RAW_DATA, $iv);
+    if ($cipher === false) throw new RuntimeException("encrypt_fail");
+
+    $mac = hash_hmac('sha256', $iv . $cipher, $hmacKey, true);
+    return $iv . $cipher . $mac;
+}
+
+/**
+ * Unpack optional LZSS stage (see src/lz_pack.h):
+ * plain = 'Z' || ver(1) || origLen(u32 LE) || stream, otherwise plain JSON as is.
+ *
+ * @return array [ok(bool), plain(string), err(string)]
+ */
+function lz_unpack_plain(string $plain): array {
+    if (strlen($plain) < 6 || $plain[0] !== 'Z') return [true, $plain, ""];
+    if (ord($plain[1]) !== 1) return [false, "", "lz_version_bad"];
+
+    $origLen = unpack("V", substr($plain, 2, 4))[1];
+    $in  = substr($plain, 6);
+    $n   = strlen($in);
+    $out = "";
+    $i   = 0;
+
+    while ($i < $n && strlen($out) < $origLen) {
+        $ctrl = ord($in[$i++]);
+        for ($b = 0; $b < 8 && $i < $n && strlen($out) < $origLen; $b++) {
+            if (($ctrl >> $b) & 1) {
+                if ($i + 1 >= $n) return [false, "", "lz_truncated"];
+                $code = (ord($in[$i]) << 8) | ord($in[$i + 1]);
+                $i += 2;
+                $dist = ($code >> 4) + 1;
+                $len  = ($code & 0x0F) + 3;
+                $start = strlen($out) - $dist;
+                if ($start < 0) return [false, "", "lz_dist_bad"];
+                // побайтно: ссылка может перекрывать сама себя
+                for ($k = 0; $k < $len; $k++) $out .= $out[$start + $k];
+            } else {
+                $out .= $in[$i++];
+            }
+        }
+    }
+
+    if (strlen($out) !== $origLen) return [false, "", "lz_len_bad"];
+    return [true, $out, ""];
+}
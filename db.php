@@ -0,0 +1,224 @@
+<?php
+// db.php — общие для HTTP (index.php) и UDP (udp.php) приёмников
+
+declare(strict_types=1);
+
+// -------------------------
+// DB
+// -------------------------
+function pdo(): PDO {
+    static $pdo = null;
+    if ($pdo instanceof PDO) return $pdo;
+
+    $pdo = new PDO("sqlite:" . DB_PATH);
+    $pdo->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
+    return $pdo;
+}
+
+function init_db(): void {
+    $db = pdo();
+
+    $db->exec("
+        CREATE TABLE IF NOT EXISTS devices (
+            id TEXT PRIMARY KEY,
+            created INTEGER
+        );
+    ");
+
+    $db->exec("
+        CREATE TABLE IF NOT EXISTS data (
+            device_id TEXT,
+            ts INTEGER,
+            current_mA INTEGER,
+            power_dW INTEGER,
+            temp_cC INTEGER
+        );
+    ");
+
+    $db->exec("
+        CREATE TABLE IF NOT EXISTS nonces (
+            device_id TEXT,
+            nonce TEXT,
+            ts INTEGER
+        );
+    ");
+
+    $db->exec("
+        CREATE TABLE IF NOT EXISTS acks (
+            device_id TEXT PRIMARY KEY,
+            last_seq INTEGER
+        );
+    ");
+
+    $db->exec("
+        CREATE TABLE IF NOT EXISTS health (
+            device_id TEXT,
+            ts INTEGER,
+            body TEXT
+        );
+    ");
+
+    // просьба дослать архив устройства за период (backfill.php -> ответы /data, /health)
+    $db->exec("
+        CREATE TABLE IF NOT EXISTS backfill (
+            device_id TEXT PRIMARY KEY,
+            ts_from INTEGER,
+            ts_to INTEGER,
+            created INTEGER
+        );
+    ");
+
+    // многоканальные записи (прошивка с SampleRec v2): JSON-массивы по каналам
+    $cols = array_column($db->query("PRAGMA table_info(data)")->fetchAll(PDO::FETCH_ASSOC), "name");
+    if (!in_array("ch_cA", $cols, true)) $db->exec("ALTER TABLE data ADD COLUMN ch_cA TEXT");
+    if (!in_array("t_cC", $cols, true))  $db->exec("ALTER TABLE data ADD COLUMN t_cC TEXT");
+    // 1 — ts не время RTC (запасной uptime устройства или сброшенный RTC), см. data_insert
+    if (!in_array("ts_bad", $cols, true)) $db->exec("ALTER TABLE data ADD COLUMN ts_bad INTEGER NOT NULL DEFAULT 0");
+
+    $db->exec("CREATE INDEX IF NOT EXISTS idx_data_device_ts ON data(device_id, ts);");
+    $db->exec("CREATE INDEX IF NOT EXISTS idx_health_device_ts ON health(device_id, ts);");
+    $db->exec("CREATE INDEX IF NOT EXISTS idx_nonces_device_nonce ON nonces(device_id, nonce);");
+}
+
+function is_registered(string $device_id): bool {
+    $db = pdo();
+    $st = $db->prepare("SELECT 1 FROM devices WHERE id=? LIMIT 1");
+    $st->execute([$device_id]);
+    return (bool)$st->fetchColumn();
+}
+
+function register_device(string $device_id): void {
+    $db = pdo();
+    $st = $db->prepare("INSERT OR IGNORE INTO devices(id, created) VALUES (?, ?)");
+    $st->execute([$device_id, time()]);
+}
+
+function last_ack(string $device_id): int {
+    $db = pdo();
+    $st = $db->prepare("SELECT last_seq FROM acks WHERE device_id=? LIMIT 1");
+    $st->execute([$device_id]);
+    $v = $st->fetchColumn();
+    return $v === false ? 0 : (int)$v;
+}
+
+function set_last_ack(string $device_id, int $seq): void {
+    $db = pdo();
+    $st = $db->prepare("INSERT OR REPLACE INTO acks(device_id, last_seq) VALUES (?, ?)");
+    $st->execute([$device_id, $seq]);
+}
+
+function nonce_seen(string $device_id, string $nonce): bool {
+    $st = pdo()->prepare("SELECT 1 FROM nonces WHERE device_id=? AND nonce=? LIMIT 1");
+    $st->execute([$device_id, $nonce]);
+    return (bool)$st->fetchColumn();
+}
+
+function nonce_store(string $device_id, string $nonce): void {
+    $ins = pdo()->prepare("INSERT INTO nonces(device_id, nonce, ts) VALUES (?, ?, ?)");
+    $ins->execute([$device_id, $nonce, time()]);
+}
+
+function check_nonce(string $device_id, string $nonce): bool {
+    if (nonce_seen($device_id, $nonce)) return false;
+    nonce_store($device_id, $nonce);
+    return true;
+}
+
+// вставка замера (повторяет scripts/udp_ref_receiver.py). Повторы в /data и UDP отсекает цепочка seq/nonce: пакет пишется
+// один раз, уже подтверждённый только подтверждается снова. По ts не сверяем —
+// запасные ts устройства (см. ts_bad) повторяются после каждой перезагрузки
+function data_insert_stmt(): PDOStatement {
+    return pdo()->prepare(
+        "INSERT INTO data(device_id, ts, current_mA, power_dW, temp_cC, ch_cA, t_cC, ts_bad)
+         VALUES (?, ?, ?, ?, ?, ?, ?, ?)"
+    );
+}
+
+// досылка архива идёт вне цепочки: уже записанное отсеиваем по (device_id, ts)
+function backfill_insert_stmt(): PDOStatement {
+    return pdo()->prepare(
+        "INSERT INTO data(device_id, ts, current_mA, power_dW, temp_cC, ch_cA, t_cC, ts_bad)
+         SELECT ?, ?, ?, ?, ?, ?, ?, 0
+         WHERE NOT EXISTS (SELECT 1 FROM data WHERE device_id=? AND ts=?)"
+    );
+}
+
+function int_list($v): ?string {
+    if (!is_array($v) || !$v) return null;
+    return json_encode(array_map("intval", array_values($v)));
+}
+
+// раньше — не время RTC: запасной ts устройства (millis()/1000 от загрузки) или RTC,
+// потерявший питание (2000-01-01). Такие записи храним с пометкой ts_bad
+const MIN_VALID_TS = 1577836800;   // 2020-01-01
+
+function ts_valid(int $ts): bool {
+    return $ts >= MIN_VALID_TS;
+}
+
+// 1 — записано
+function data_insert(PDOStatement $ins, string $device_id, array $r): int {
+    $ts = (int)($r["ts"] ?? 0);
+    $ins->execute([
+        $device_id,
+        $ts,
+        (int)($r["current_mA"] ?? 0),
+        (int)($r["power_dW"] ?? 0),
+        (int)($r["temp_cC"] ?? 0),
+        int_list($r["ch_cA"] ?? null),
+        int_list($r["t_cC"] ?? null),
+        ts_valid($ts) ? 0 : 1
+    ]);
+    return $ins->rowCount();
+}
+
+// 1 — записано, 0 — уже есть или ts не время: такой не с чем сверить, а в архиве
+// устройства запись остаётся
+function backfill_insert(PDOStatement $ins, string $device_id, array $r): int {
+    $ts = (int)($r["ts"] ?? 0);
+    if (!ts_valid($ts)) return 0;
+
+    $ins->execute([
+        $device_id,
+        $ts,
+        (int)($r["current_mA"] ?? 0),
+        (int)($r["power_dW"] ?? 0),
+        (int)($r["temp_cC"] ?? 0),
+        int_list($r["ch_cA"] ?? null),
+        int_list($r["t_cC"] ?? null),
+        $device_id,
+        $ts
+    ]);
+    return $ins->rowCount();
+}
+
+function get_backfill(string $device_id): ?array {
+    $db = pdo();
+    $st = $db->prepare("SELECT ts_from, ts_to FROM backfill WHERE device_id=? LIMIT 1");
+    $st->execute([$device_id]);
+    $r = $st->fetch(PDO::FETCH_ASSOC);
+    return $r === false ? null : ["from" => (int)$r["ts_from"], "to" => (int)$r["ts_to"]];
+}
+
+function set_backfill(string $device_id, int $from, int $to): void {
+    $db = pdo();
+    $st = $db->prepare("INSERT OR REPLACE INTO backfill(device_id, ts_from, ts_to, created) VALUES (?, ?, ?, ?)");
+    $st->execute([$device_id, $from, $to, time()]);
+}
+
+// снимаем только ту просьбу, которую устройство закрыло: новую за другой период не трогаем
+function clear_backfill(string $device_id, int $from, int $to): void {
+    $db = pdo();
+    $st = $db->prepare("DELETE FROM backfill WHERE device_id=? AND ts_from=? AND ts_to=?");
+    $st->execute([$device_id, $from, $to]);
+}
+
+// ответ устройству + bf_from/bf_to, если для него есть просьба досылки
+function with_backfill(string $device_id, array $data): array {
+    $bf = get_backfill($device_id);
+    if ($bf !== null) {
+        $data["bf_from"] = $bf["from"];
+        $data["bf_to"] = $bf["to"];
+    }
+    return $data;
+}
@@ -6,6 +6,7 @@ declare(strict_types=1);
 require_once __DIR__ . "/config.php";
 require_once __DIR__ . "/crypto.php";
 require_once __DIR__ . "/logger.php";
+require_once __DIR__ . "/db.php";
 header("Content-Type: application/json; charset=utf-8");
 $rawBody = file_get_contents("php://input");
 
@@ -29,6 +30,8 @@ log_line("RAW_REQUEST", [
 // response helper
 // -------------------------
 function json_ok(array $data, int $code = 200): void {
+    // время сервера в каждом ответе — устройство подстраивает RTC без /sync_time
+    if (!isset($data["ts"])) $data["ts"] = time();
     if (defined("DEBUG_LOG") && DEBUG_LOG) {
         log_line("RESPONSE", ["code" => $code, "data" => $data]);
     }
@@ -36,75 +39,6 @@ function json_ok(array $data, int $code = 200): void {
     echo json_encode($data, JSON_UNESCAPED_UNICODE);
     exit;
 }
-// -------------------------
-// DB
-// -------------------------
-function pdo(): PDO {
-    static $pdo = null;
-    if ($pdo instanceof PDO) return $pdo;
-
-    $pdo = new PDO("sqlite:" . DB_PATH);
-    $pdo->setAttribute(PDO::ATTR_ERRMODE, PDO::ERRMODE_EXCEPTION);
-    return $pdo;
-}
-
-function init_db(): void {
-    $db = pdo();
-
-    $db->exec("
-        CREATE TABLE IF NOT EXISTS devices (
-            id TEXT PRIMARY KEY,
-            created INTEGER
-        );
-    ");
-
-    $db->exec("
-        CREATE TABLE IF NOT EXISTS data (
-            device_id TEXT,
-            ts INTEGER,
-            current_mA INTEGER,
-            power_dW INTEGER,
-            temp_cC INTEGER
-        );
-    ");
-
-    $db->exec("
-        CREATE TABLE IF NOT EXISTS nonces (
-            device_id TEXT,
-            nonce TEXT,
-            ts INTEGER
-        );
-    ");
-
-    $db->exec("CREATE INDEX IF NOT EXISTS idx_data_device_ts ON data(device_id, ts);");
-    $db->exec("CREATE INDEX IF NOT EXISTS idx_nonces_device_nonce ON nonces(device_id, nonce);");
-}
-
-function is_registered(string $device_id): bool {
-    $db = pdo();
-    $st = $db->prepare("SELECT 1 FROM devices WHERE id=? LIMIT 1");
-    $st->execute([$device_id]);
-    return (bool)$st->fetchColumn();
-}
-
-function register_device(string $device_id): void {
-    $db = pdo();
-    $st = $db->prepare("INSERT OR IGNORE INTO devices(id, created) VALUES (?, ?)");
-    $st->execute([$device_id, time()]);
-}
-
-function check_nonce(string $device_id, string $nonce): bool {
-    $db = pdo();
-
-    $st = $db->prepare("SELECT 1 FROM nonces WHERE device_id=? AND nonce=? LIMIT 1");
-    $st->execute([$device_id, $nonce]);
-    if ($st->fetchColumn()) return false;
-
-    $ins = $db->prepare("INSERT INTO nonces(device_id, nonce, ts) VALUES (?, ?, ?)");
-    $ins->execute([$device_id, $nonce, time()]);
-    return true;
-}
-
 // -------------------------
 // Router
 // -------------------------
@@ -176,6 +110,12 @@ if (DEBUG_LOG) {
         log_line("DECRYPT_OK", ["plain_len" => strlen($plain)]);
     }
 
+    [$ok, $plain, $err] = lz_unpack_plain($plain);
+    if (!$ok) {
+        if (DEBUG_LOG) log_line("LZ_FAIL", ["err" => $err]);
+        json_ok(["status" => "badenc", "err" => $err], 400);
+    }
+
     $payload = json_decode($plain, true);
     if (!is_array($payload)) {
         if (DEBUG_LOG) log_line("JSON_FAIL");
@@ -210,7 +150,11 @@ if ($method === "POST" && $path === "/register") {
 
 // -------------------------
 // POST /data
-// expects: device_id, nonce, records[]
+// expects: device_id, nonce, records[] — {ts, current_mA, power_dW, temp_cC}
+//   + ch_cA[] (ток по каналам, A*100) и t_cC[] (все датчики), если их больше одного
+// optional: seq + prev — конвейерная выгрузка бэклога (см. sendData в прошивке):
+//   пакет принимается, если prev <= last_ack (цепочка не разорвана),
+//   ответ несёт кумулятивный "ack" = старший seq непрерывной цепочки
 // -------------------------
 if ($method === "POST" && $path === "/data") {
     $device_id = $payload["device_id"] ?? "";
@@ -244,8 +188,17 @@ if ($method === "POST" && $path === "/data") {
         json_ok(["status" => "notreg"], 403);
     }
 
+    // ---- цепочка seq/prev ----
+    $chained = isset($payload["seq"], $payload["prev"]);
+    $seq  = (int)($payload["seq"] ?? 0);
+    $prev = (int)($payload["prev"] ?? 0);
+    $ack  = last_ack($device_id);
+
     // ---- защита от повторов ----
-    if (!check_nonce($device_id, $nonce)) {
+    // пакет цепочки устройство повторяет тем же блобом (после обрыва или gap):
+    // от повторов его защищает сама цепочка — уже принятый seq только подтверждаем
+    $fresh = check_nonce($device_id, $nonce);
+    if (!$fresh && !$chained) {
         if (DEBUG_LOG) {
             log_line("DATA_REPLAY", [
                 "device_id" => $device_id,
@@ -254,60 +207,157 @@ if ($method === "POST" && $path === "/data") {
         }
         json_ok(["status" => "replay"], 403);
     }
+    if (!$fresh && $seq <= $ack) {
+        json_ok(["status" => "OK", "ack" => $ack]);
+    }
+
+    if ($chained && $prev > $ack) {
+        // предыдущий пакет окна не дошёл — этот не принимаем, устройство перешлёт
+        if (DEBUG_LOG) {
+            log_line("DATA_GAP", [
+                "device_id" => $device_id,
+                "seq" => $seq,
+                "prev" => $prev,
+                "ack" => $ack
+            ]);
+        }
+        json_ok(["status" => "gap", "ack" => $ack], 409);
+    }
 
     // ---- запись ----
+    // повтор уже принятого пакета сюда не доходит (см. выше): пишем все записи
     $db = pdo();
     $db->beginTransaction();
 
-    $ins = $db->prepare(
-        "INSERT INTO data(device_id, ts, current_mA, power_dW, temp_cC)
-         VALUES (?, ?, ?, ?, ?)"
-    );
+    $ins = data_insert_stmt();
 
     $saved = 0;
 
   foreach ($records as $r) {
     if (!is_array($r)) continue;
 
-    $ts         = (int)($r["ts"] ?? 0);
-    $current_mA = (int)($r["current_mA"] ?? 0);
-    $power_dW   = (int)($r["power_dW"] ?? 0);
-    $temp_cC    = (int)($r["temp_cC"] ?? 0);
-
     if (DEBUG_LOG) {
         log_line("DATA_RECORD", [
             "device_id" => $device_id,
-            "ts" => $ts,
-            "current_mA" => $current_mA,
-            "power_dW" => $power_dW,
-            "temp_cC" => $temp_cC
+            "ts" => (int)($r["ts"] ?? 0),
+            "current_mA" => (int)($r["current_mA"] ?? 0),
+            "power_dW" => (int)($r["power_dW"] ?? 0),
+            "temp_cC" => (int)($r["temp_cC"] ?? 0),
+            "ch_cA" => $r["ch_cA"] ?? null,
+            "t_cC" => $r["t_cC"] ?? null
         ]);
     }
 
-    if ($ts <= 0) continue;
+    $saved += data_insert($ins, $device_id, $r);
+}
+
 
-    $ins->execute([
-        $device_id,
-        $ts,
-        $current_mA,
-        $power_dW,
-        $temp_cC
-    ]);
+    if ($chained && $seq > $ack) {
+        set_last_ack($device_id, $seq);
+        $ack = $seq;
+    }
 
-    $saved++;
+    $db->commit();
+
+    if (DEBUG_LOG) {
+        log_line("DATA_SAVED", [
+            "device_id" => $device_id,
+            "saved_rows" => $saved,
+            "ack" => $ack
+        ]);
+    }
+
+    json_ok(with_backfill($device_id, ["status" => "OK", "ack" => $ack]));
 }
 
+// -------------------------
+// POST /backfill
+// expects: device_id, nonce, from, to, records[], done
+// досылка архива устройства по просьбе (см. backfill.php); вне цепочки seq/prev —
+// записи, которые уже есть, отсеиваются по ts; done снимает просьбу
+// -------------------------
+if ($method === "POST" && $path === "/backfill") {
+    $device_id = $payload["device_id"] ?? "";
+    $nonce     = $payload["nonce"] ?? "";
+    $records   = $payload["records"] ?? null;
+    $from      = (int)($payload["from"] ?? 0);
+    $to        = (int)($payload["to"] ?? 0);
+    $done      = ($payload["done"] ?? false) === true;
+
+    if (!is_string($device_id) || $device_id === "" ||
+        !is_string($nonce) || $nonce === "" ||
+        !is_array($records)) {
+        json_ok(["status" => "badreq"], 400);
+    }
+
+    if (!is_registered($device_id)) {
+        json_ok(["status" => "notreg"], 403);
+    }
+
+    if (!check_nonce($device_id, $nonce)) {
+        json_ok(["status" => "replay"], 403);
+    }
+
+    $db = pdo();
+    $db->beginTransaction();
+
+    $ins = backfill_insert_stmt();
+
+    $saved = 0;
+    foreach ($records as $r) {
+        if (is_array($r)) $saved += backfill_insert($ins, $device_id, $r);
+    }
+
+    if ($done) clear_backfill($device_id, $from, $to);
 
     $db->commit();
 
     if (DEBUG_LOG) {
-        log_line("DATA_SAVED", [
+        log_line("BACKFILL", [
             "device_id" => $device_id,
-            "saved_rows" => $saved
+            "from" => $from,
+            "to" => $to,
+            "records_n" => count($records),
+            "saved_rows" => $saved,
+            "done" => $done
         ]);
     }
 
-    json_ok(["status" => "OK"]);
+    json_ok(with_backfill($device_id, ["status" => "OK", "saved" => $saved]));
+}
+
+// -------------------------
+// POST /health
+// expects: device_id, nonce, health{} — сводка метрик устройства за интервал
+// (up, heap, heap_min, stack{}, c{} счётчики, h{} = [count, avg_ms, p50_us, p95_us, max_us])
+// -------------------------
+if ($method === "POST" && $path === "/health") {
+    $device_id = $payload["device_id"] ?? "";
+    $nonce     = $payload["nonce"] ?? "";
+    $health    = $payload["health"] ?? null;
+
+    if (!is_string($device_id) || $device_id === "" ||
+        !is_string($nonce) || $nonce === "" ||
+        !is_array($health)) {
+        json_ok(["status" => "badreq"], 400);
+    }
+
+    if (!is_registered($device_id)) {
+        json_ok(["status" => "notreg"], 403);
+    }
+
+    if (!check_nonce($device_id, $nonce)) {
+        json_ok(["status" => "replay"], 403);
+    }
+
+    $st = pdo()->prepare("INSERT INTO health(device_id, ts, body) VALUES (?, ?, ?)");
+    $st->execute([$device_id, time(), json_encode($health, JSON_UNESCAPED_UNICODE)]);
+
+    if (DEBUG_LOG) {
+        log_line("HEALTH", ["device_id" => $device_id, "health" => $health]);
+    }
+
+    json_ok(with_backfill($device_id, ["status" => "OK"]));
 }
 
 json_ok(["status" => "nf"], 404);
@@ -0,0 +1,44 @@
+# PlatformIO pre-script: web/index.html -> src/web_ui.h (gzip, массив байт во flash).
+# Пересобирается только если html новее заголовка; mtime=0 — вывод воспроизводим.
+#
+#   extra_scripts = pre:scripts/embed_web.py
+# Можно запускать и вручную: python scripts/embed_web.py
+
+import gzip
+import os
+
+try:
+    Import("env")  # noqa: F821
+    ROOT = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+SRC = os.path.join(ROOT, "web", "index.html")
+DST = os.path.join(ROOT, "src", "web_ui.h")
+
+
+def embed():
+    if os.path.exists(DST) and os.path.getmtime(DST) >= os.path.getmtime(SRC):
+        return
+
+    with open(SRC, "rb") as f:
+        raw = f.read()
+    gz = gzip.compress(raw, compresslevel=9, mtime=0)
+
+    lines = []
+    for i in range(0, len(gz), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in gz[i:i + 16]) + ",")
+
+    with open(DST, "w", newline="\n") as f:
+        f.write("#pragma once\n")
+        f.write("// Сгенерировано scripts/embed_web.py из web/index.html — не править руками\n")
+        f.write("#include <Arduino.h>\n\n")
+        f.write("// %d -> %d байт (gzip)\n" % (len(raw), len(gz)))
+        f.write("static const size_t WEB_INDEX_GZ_LEN = %d;\n" % len(gz))
+        f.write("static const uint8_t WEB_INDEX_GZ[] PROGMEM = {\n")
+        f.write("\n".join(lines) + "\n};\n")
+
+    print("embed_web: %s (%d -> %d bytes)" % (os.path.relpath(DST, ROOT), len(raw), len(gz)))
+
+
+embed()
@@ -0,0 +1,259 @@
+# Эталонный приёмник датаграммного аплинка для тестов на хосте: dg_handle() из
+# udp.php и правила записи db.php (цепочка seq/nonce, ts_bad) на настоящем
+# UDP-сокете, без PHP. Отличия от udp.php: blob не шифрован (JSON, можно
+# сжатый LZ как на устройстве), база — sqlite в памяти. Менять вместе с udp.php
+# и db.php.
+#
+#   python scripts/udp_ref_receiver.py [port]     (0 — любой свободный)
+#
+# Печатает "listening on :PORT", дальше отвечает как udp.php. Датаграммы,
+# начинающиеся с 'C', — управление тестом (udp.php их молча отбрасывает):
+#   Creset               — пустая база
+#   Cregister <id>       — is_registered(id) = true
+#   Cdrop-req <n>        — следующие n запросов потерялись по дороге к серверу
+#   Cdrop-ack <n>        — следующие n ответов потерялись (запрос принят)
+#   Crows <id>           — ответ 'C' + {"rows":[[ts,ts_bad],...],"last_ack":N}
+
+import json
+import socket
+import sqlite3
+import struct
+import sys
+import time
+
+DG_REQ = ord("D")
+DG_ACK = b"A"
+DG_VERSION = 1
+CTRL = ord("C")
+
+# db.php: MIN_VALID_TS
+MIN_VALID_TS = 1577836800
+
+
+def php_int(v):
+    # (int) из PHP для значений JSON
+    if isinstance(v, bool):
+        return int(v)
+    if isinstance(v, (int, float)):
+        return int(v)
+    if isinstance(v, str):
+        s = v.strip()
+        n = 0
+        while n < len(s) and (s[n].isdigit() or (n == 0 and s[n] in "+-")):
+            n += 1
+        try:
+            return int(s[:n])
+        except ValueError:
+            return 0
+    return 0
+
+
+def int_list(v):
+    if not isinstance(v, (list, dict)) or not v:
+        return None
+    vals = v.values() if isinstance(v, dict) else v
+    return json.dumps([php_int(x) for x in vals], separators=(",", ":"))
+
+
+# ===================== crypto.php =====================
+def lz_unpack_plain(plain):
+    if len(plain) < 6 or plain[0] != ord("Z"):
+        return True, plain
+    if plain[1] != 1:
+        return False, b""
+
+    orig_len = struct.unpack_from("<I", plain, 2)[0]
+    src = plain[6:]
+    out = bytearray()
+    i = 0
+    while i < len(src) and len(out) < orig_len:
+        ctrl = src[i]
+        i += 1
+        b = 0
+        while b < 8 and i < len(src) and len(out) < orig_len:
+            if (ctrl >> b) & 1:
+                if i + 1 >= len(src):
+                    return False, b""
+                code = (src[i] << 8) | src[i + 1]
+                i += 2
+                dist = (code >> 4) + 1
+                ln = (code & 0x0F) + 3
+                start = len(out) - dist
+                if start < 0:
+                    return False, b""
+                for k in range(ln):  # ссылка может перекрывать сама себя
+                    out.append(out[start + k])
+            else:
+                out.append(src[i])
+                i += 1
+            b += 1
+
+    if len(out) != orig_len:
+        return False, b""
+    return True, bytes(out)
+
+
+# ===================== db.php =====================
+class Db:
+    def __init__(self):
+        self.db = sqlite3.connect(":memory:", isolation_level=None)
+        self.db.executescript("""
+            CREATE TABLE devices (id TEXT PRIMARY KEY, created INTEGER);
+            CREATE TABLE data (device_id TEXT, ts INTEGER, current_mA INTEGER, power_dW INTEGER,
+                               temp_cC INTEGER, ch_cA TEXT, t_cC TEXT,
+                               ts_bad INTEGER NOT NULL DEFAULT 0);
+            CREATE TABLE nonces (device_id TEXT, nonce TEXT, ts INTEGER);
+            CREATE TABLE acks (device_id TEXT PRIMARY KEY, last_seq INTEGER);
+        """)
+
+    def is_registered(self, device_id):
+        return self.db.execute("SELECT 1 FROM devices WHERE id=? LIMIT 1", (device_id,)).fetchone() is not None
+
+    def register_device(self, device_id):
+        self.db.execute("INSERT OR IGNORE INTO devices(id, created) VALUES (?, ?)", (device_id, int(time.time())))
+
+    def last_ack(self, device_id):
+        r = self.db.execute("SELECT last_seq FROM acks WHERE device_id=? LIMIT 1", (device_id,)).fetchone()
+        return 0 if r is None else int(r[0])
+
+    def set_last_ack(self, device_id, seq):
+        self.db.execute("INSERT OR REPLACE INTO acks(device_id, last_seq) VALUES (?, ?)", (device_id, seq))
+
+    def nonce_seen(self, device_id, nonce):
+        return self.db.execute("SELECT 1 FROM nonces WHERE device_id=? AND nonce=? LIMIT 1",
+                               (device_id, nonce)).fetchone() is not None
+
+    def nonce_store(self, device_id, nonce):
+        self.db.execute("INSERT INTO nonces(device_id, nonce, ts) VALUES (?, ?, ?)",
+                        (device_id, nonce, int(time.time())))
+
+    # data_insert(): пишется каждая запись, ts раньше 2020 — с пометкой ts_bad
+    def data_insert(self, device_id, r):
+        ts = php_int(r.get("ts", 0))
+        cur = self.db.execute(
+            "INSERT INTO data(device_id, ts, current_mA, power_dW, temp_cC, ch_cA, t_cC, ts_bad)"
+            " VALUES (?, ?, ?, ?, ?, ?, ?, ?)",
+            (device_id, ts, php_int(r.get("current_mA", 0)), php_int(r.get("power_dW", 0)),
+             php_int(r.get("temp_cC", 0)), int_list(r.get("ch_cA")), int_list(r.get("t_cC")),
+             0 if ts >= MIN_VALID_TS else 1))
+        return cur.rowcount
+
+    def rows(self, device_id):
+        return [list(r) for r in self.db.execute(
+            "SELECT ts, ts_bad FROM data WHERE device_id=? ORDER BY rowid", (device_id,))]
+
+
+# ===================== udp.php =====================
+def dg_ack(seq, data):
+    data["ts"] = int(time.time())
+    blob = json.dumps(data, separators=(",", ":")).encode()
+    return DG_ACK + bytes([DG_VERSION]) + struct.pack("<I", seq) + struct.pack("<H", len(blob)) + blob
+
+
+def dg_handle(db, pkt):
+    n = len(pkt)
+    if n < 3 or pkt[0] != DG_REQ or pkt[1] != DG_VERSION:
+        return None
+
+    id_len = pkt[2]
+    if n < 3 + id_len + 6:
+        return None
+    hdr_id = pkt[3:3 + id_len].decode("utf-8", "replace")
+    seq = struct.unpack_from("<I", pkt, 3 + id_len)[0]
+    blob_len = struct.unpack_from("<H", pkt, 7 + id_len)[0]
+    if n != 9 + id_len + blob_len:
+        return None
+
+    ok, plain = lz_unpack_plain(pkt[9 + id_len:])
+    if not ok:
+        return None
+
+    try:
+        payload = json.loads(plain)
+    except ValueError:
+        payload = None
+    if not isinstance(payload, dict):
+        payload = {}
+    device_id = payload.get("device_id", "")
+    nonce = payload.get("nonce", "")
+    records = payload.get("records")
+    if isinstance(records, dict):
+        records = list(records.values())
+
+    if (not isinstance(device_id, str) or device_id != hdr_id or
+            not isinstance(nonce, str) or nonce == "" or
+            not isinstance(records, list) or php_int(payload.get("seq", -1)) != seq):
+        return dg_ack(seq, {"status": "badreq"})
+
+    if not db.is_registered(device_id):
+        return dg_ack(seq, {"status": "notreg"})
+
+    chained = payload.get("prev") is not None
+    prev = php_int(payload.get("prev", 0))
+
+    # повтор той же датаграммы — уже записано, подтверждаем снова
+    if db.nonce_seen(device_id, nonce):
+        return dg_ack(seq, {"status": "OK", "ack": seq})
+
+    ack = db.last_ack(device_id)
+    if chained and prev > ack:
+        return dg_ack(seq, {"status": "gap", "ack": ack})
+
+    db.db.execute("BEGIN")
+    for r in records:
+        if isinstance(r, dict):
+            db.data_insert(device_id, r)
+    if chained and seq > ack:
+        db.set_last_ack(device_id, seq)
+    db.nonce_store(device_id, nonce)
+    db.db.execute("COMMIT")
+
+    return dg_ack(seq, {"status": "OK", "ack": seq})
+
+
+# ===================== main loop =====================
+def main():
+    port = int(sys.argv[1]) if len(sys.argv) > 1 else 5684
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("127.0.0.1", port))
+    print("listening on :%d" % sock.getsockname()[1], flush=True)
+
+    db = Db()
+    drop_req = 0
+    drop_ack = 0
+    while True:
+        pkt, peer = sock.recvfrom(65535)
+        if not pkt:
+            continue
+
+        if pkt[0] == CTRL:
+            cmd, _, arg = pkt[1:].decode().partition(" ")
+            reply = {}
+            if cmd == "reset":
+                db = Db()
+                drop_req = drop_ack = 0
+            elif cmd == "register":
+                db.register_device(arg)
+            elif cmd == "drop-req":
+                drop_req = int(arg)
+            elif cmd == "drop-ack":
+                drop_ack = int(arg)
+            elif cmd == "rows":
+                reply = {"rows": db.rows(arg), "last_ack": db.last_ack(arg)}
+            sock.sendto(b"C" + json.dumps(reply).encode(), peer)
+            continue
+
+        if drop_req:
+            drop_req -= 1
+            continue
+        reply = dg_handle(db, pkt)
+        if reply is None:
+            continue
+        if drop_ack:
+            drop_ack -= 1
+            continue
+        sock.sendto(reply, peer)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,7 @@
+#pragma once
+#include <Arduino.h>
+
+// Метка фазы загрузки в Serial: время от сброса (millis считает с reset).
+inline void BootMark(const char* phase) {
+  Serial.printf("BOOT %-14s %7lu ms\n", phase, (unsigned long)millis());
+}
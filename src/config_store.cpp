@@ -0,0 +1,136 @@
+#include "config_store.h"
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static Preferences prefs;
+static SemaphoreHandle_t mtx = nullptr;
+static ConfigSnapshot current;
+static ConfigSnapshot defaultsCfg;
+
+struct Listener { ConfigListener fn; uint32_t mask; void* arg; };
+static const size_t MAX_LISTENERS = 6;
+static Listener listeners[MAX_LISTENERS];
+static size_t listenersCount = 0;
+
+// ===================== NVS =====================
+static void loadFromNvs(Config& c, const Config& def) {
+  prefs.begin("cfg", true);
+  c.serverHost = prefs.getString("serverHost", def.serverHost);
+  c.serverPort = prefs.getUShort("serverPort", def.serverPort);
+  c.location   = prefs.getString("location",   def.location);
+  c.cryptoPass = prefs.getString("cryptoPass", def.cryptoPass);
+  c.adminLogin = prefs.getString("adminLogin", def.adminLogin);
+  c.adminPass  = prefs.getString("adminPass",  def.adminPass);
+  c.voltage    = prefs.getFloat("voltage",     def.voltage);
+  c.wifiSsid   = prefs.getString("wifiSsid",   def.wifiSsid);
+  c.wifiPass   = prefs.getString("wifiPass",   def.wifiPass);
+  c.udpPort    = prefs.getUShort("udpPort",    def.udpPort);
+  c.uplinkMaxS = prefs.getUShort("upMaxS",     def.uplinkMaxS);
+  c.ctChannels = prefs.getUChar("ctN",         def.ctChannels);
+  c.ctNeutral  = prefs.getBool("ctNeu",        def.ctNeutral);
+  if (prefs.getBytes("ctCal", c.ct, sizeof(c.ct)) != sizeof(c.ct)) memcpy(c.ct, def.ct, sizeof(c.ct));
+  c.heatMinOnS  = prefs.getUShort("htMinOn",   def.heatMinOnS);
+  c.heatMinOffS = prefs.getUShort("htMinOff",  def.heatMinOffS);
+  prefs.end();
+
+  c.ctChannels = constrain(c.ctChannels, (uint8_t)1, CT_MAX_CHANNELS);
+  c.heatMinOnS  = min(c.heatMinOnS, (uint16_t)3600);
+  c.heatMinOffS = min(c.heatMinOffS, (uint16_t)3600);
+
+  if (c.location.length() > 500) c.location = c.location.substring(0, 500);
+}
+
+static uint32_t diff(const Config& a, const Config& b) {
+  uint32_t m = 0;
+  if (a.serverHost != b.serverHost || a.serverPort != b.serverPort || a.udpPort != b.udpPort ||
+      a.uplinkMaxS != b.uplinkMaxS) m |= CFG_CH_SERVER;
+  if (a.cryptoPass != b.cryptoPass) m |= CFG_CH_CRYPTO;
+  if (a.wifiSsid != b.wifiSsid || a.wifiPass != b.wifiPass) m |= CFG_CH_WIFI;
+  if (a.voltage != b.voltage) m |= CFG_CH_VOLTAGE;
+  if (a.adminLogin != b.adminLogin || a.adminPass != b.adminPass) m |= CFG_CH_ADMIN;
+  if (a.location != b.location) m |= CFG_CH_LOCATION;
+  if (a.ctChannels != b.ctChannels || a.ctNeutral != b.ctNeutral ||
+      memcmp(a.ct, b.ct, sizeof(a.ct)) != 0) m |= CFG_CH_CT;
+  if (a.heatMinOnS != b.heatMinOnS || a.heatMinOffS != b.heatMinOffS) m |= CFG_CH_HEATER;
+  return m;
+}
+
+// только изменившиеся группы — меньше износ flash
+static void writeToNvs(const Config& c, uint32_t changed) {
+  prefs.begin("cfg", false);
+  if (changed & CFG_CH_SERVER) {
+    prefs.putString("serverHost", c.serverHost);
+    prefs.putUShort("serverPort", c.serverPort);
+    prefs.putUShort("udpPort", c.udpPort);
+    prefs.putUShort("upMaxS", c.uplinkMaxS);
+  }
+  if (changed & CFG_CH_CRYPTO)   prefs.putString("cryptoPass", c.cryptoPass);
+  if (changed & CFG_CH_WIFI) {
+    prefs.putString("wifiSsid", c.wifiSsid);
+    prefs.putString("wifiPass", c.wifiPass);
+  }
+  if (changed & CFG_CH_VOLTAGE)  prefs.putFloat("voltage", c.voltage);
+  if (changed & CFG_CH_ADMIN) {
+    prefs.putString("adminLogin", c.adminLogin);
+    prefs.putString("adminPass",  c.adminPass);
+  }
+  if (changed & CFG_CH_LOCATION) prefs.putString("location", c.location);
+  if (changed & CFG_CH_CT) {
+    prefs.putUChar("ctN", c.ctChannels);
+    prefs.putBool("ctNeu", c.ctNeutral);
+    prefs.putBytes("ctCal", c.ct, sizeof(c.ct));
+  }
+  if (changed & CFG_CH_HEATER) {
+    prefs.putUShort("htMinOn", c.heatMinOnS);
+    prefs.putUShort("htMinOff", c.heatMinOffS);
+  }
+  prefs.end();
+}
+
+// ===================== API =====================
+void ConfigStoreBegin(const Config& defaults) {
+  if (!mtx) mtx = xSemaphoreCreateMutex();
+  defaultsCfg = std::make_shared<const Config>(defaults);
+
+  Config c;
+  loadFromNvs(c, defaults);
+  current = std::make_shared<const Config>(c);
+}
+
+ConfigSnapshot ConfigGet() {
+  xSemaphoreTake(mtx, portMAX_DELAY);
+  ConfigSnapshot s = current;
+  xSemaphoreGive(mtx);
+  return s;
+}
+
+ConfigSnapshot ConfigDefaults() {
+  return defaultsCfg;   // не меняется после ConfigStoreBegin
+}
+
+bool ConfigSave(const Config& cfg) {
+  ConfigSnapshot next = std::make_shared<const Config>(cfg);
+
+  xSemaphoreTake(mtx, portMAX_DELAY);
+  uint32_t changed = current ? diff(*current, *next) : CFG_CH_ALL;
+  if (changed) {
+    writeToNvs(*next, changed);
+    current = next;
+  }
+  xSemaphoreGive(mtx);
+
+  if (!changed) return false;
+
+  for (size_t i = 0; i < listenersCount; i++) {
+    if (listeners[i].mask & changed) listeners[i].fn(*next, changed, listeners[i].arg);
+  }
+  return true;
+}
+
+bool ConfigSubscribe(ConfigListener fn, uint32_t mask, void* arg) {
+  if (!fn || listenersCount >= MAX_LISTENERS) return false;
+  listeners[listenersCount] = { fn, mask, arg };
+  listenersCount++;
+  return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+#include <memory>
+#include "wifi_config.h"
+
+// Единственный владелец namespace "cfg" в NVS.
+// Config читается из NVS один раз при старте, дальше — неизменяемые снимки из RAM.
+// NVS пишется только в ConfigSave(), и только изменившиеся ключи.
+typedef std::shared_ptr<const Config> ConfigSnapshot;
+
+// что изменилось (маска для подписчиков)
+enum : uint32_t {
+  CFG_CH_SERVER   = 1u << 0,   // serverHost / serverPort / udpPort / uplinkMaxS
+  CFG_CH_CRYPTO   = 1u << 1,   // cryptoPass
+  CFG_CH_WIFI     = 1u << 2,   // wifiSsid / wifiPass
+  CFG_CH_VOLTAGE  = 1u << 3,
+  CFG_CH_ADMIN    = 1u << 4,   // adminLogin / adminPass
+  CFG_CH_LOCATION = 1u << 5,
+  CFG_CH_CT       = 1u << 6,   // ctChannels / ctNeutral / ct[] (калибровка)
+  CFG_CH_HEATER   = 1u << 7,   // heatMinOnS / heatMinOffS
+  CFG_CH_ALL      = 0xFFFFFFFFu
+};
+
+// вызывается в контексте того, кто сохранил конфиг — только короткая работа
+typedef void (*ConfigListener)(const Config& cfg, uint32_t changed, void* arg);
+
+void ConfigStoreBegin(const Config& defaults);  // для ключей, которых нет в NVS
+ConfigSnapshot ConfigGet();
+ConfigSnapshot ConfigDefaults();                // то, что передано в ConfigStoreBegin (замена пустых полей)
+bool ConfigSave(const Config& cfg);             // false — ничего не изменилось
+bool ConfigSubscribe(ConfigListener fn, uint32_t mask, void* arg = nullptr);
@@ -2,6 +2,7 @@
 #include <vector>
 #include "mbedtls/aes.h"
 #include "mbedtls/md.h"
+#include "metrics.h"
 
 static void sha256(const uint8_t* data, size_t len, uint8_t out[32]) {
   mbedtls_md_context_t ctx;
@@ -62,10 +63,15 @@ static bool pkcs7Unpad(std::vector<uint8_t>& buf) {
   return true;
 }
 
-bool aesEncryptBlob(const String& pass, const uint8_t* plain, size_t plainLen,
-                    std::vector<uint8_t>& outBlob) {
-  uint8_t aesKey[32], hKey[32];
-  deriveKey(pass, aesKey, hKey);
+void CryptoSession::setPass(const String& pass) {
+  deriveKey(pass, aesKey, hmacKey);
+  keyed = true;
+}
+
+bool CryptoSession::encrypt(const uint8_t* plain, size_t plainLen,
+                            std::vector<uint8_t>& outBlob) const {
+  if (!keyed) return false;
+  MetricScope m(MH_CRYPTO);
 
   uint8_t iv[16];
   randomIV(iv);
@@ -97,15 +103,16 @@ bool aesEncryptBlob(const String& pass, const uint8_t* plain, size_t plainLen,
   memcpy(outBlob.data() + 16, cipher.data(), cipher.size());
 
   uint8_t mac[32];
-  hmacSha256(hKey, outBlob.data(), 16 + cipher.size(), mac);
+  hmacSha256(hmacKey, outBlob.data(), 16 + cipher.size(), mac);
   memcpy(outBlob.data() + 16 + cipher.size(), mac, 32);
 
   return true;
 }
 
-bool aesDecryptBlob(const String& pass, const uint8_t* blob, size_t blobLen,
-                    std::vector<uint8_t>& outPlain) {
-  if (blobLen < 16 + 32) return false;
+bool CryptoSession::decrypt(const uint8_t* blob, size_t blobLen,
+                            std::vector<uint8_t>& outPlain) const {
+  if (!keyed || blobLen < 16 + 32) return false;
+  MetricScope m(MH_CRYPTO);
 
   size_t cipherLen = blobLen - 16 - 32;
   if ((cipherLen % 16) != 0) return false;
@@ -114,12 +121,9 @@ bool aesDecryptBlob(const String& pass, const uint8_t* blob, size_t blobLen,
   const uint8_t* cipher = blob + 16;
   const uint8_t* macIn = blob + 16 + cipherLen;
 
-  uint8_t aesKey[32], hKey[32];
-  deriveKey(pass, aesKey, hKey);
-
   // verify HMAC
   uint8_t mac[32];
-  hmacSha256(hKey, blob, 16 + cipherLen, mac);
+  hmacSha256(hmacKey, blob, 16 + cipherLen, mac);
   if (memcmp(mac, macIn, 32) != 0) return false;
 
   outPlain.resize(cipherLen);
@@ -145,3 +149,17 @@ bool aesDecryptBlob(const String& pass, const uint8_t* blob, size_t blobLen,
   if (!pkcs7Unpad(outPlain)) return false;
   return true;
 }
+
+bool aesEncryptBlob(const String& pass, const uint8_t* plain, size_t plainLen,
+                    std::vector<uint8_t>& outBlob) {
+  CryptoSession cs;
+  cs.setPass(pass);
+  return cs.encrypt(plain, plainLen, outBlob);
+}
+
+bool aesDecryptBlob(const String& pass, const uint8_t* blob, size_t blobLen,
+                    std::vector<uint8_t>& outPlain) {
+  CryptoSession cs;
+  cs.setPass(pass);
+  return cs.decrypt(blob, blobLen, outPlain);
+}
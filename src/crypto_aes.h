@@ -8,3 +8,19 @@ bool aesEncryptBlob(const String& pass, const uint8_t* plain, size_t plainLen,
 
 bool aesDecryptBlob(const String& pass, const uint8_t* blob, size_t blobLen,
                     std::vector<uint8_t>& outPlain);
+
+// Ключи AES/HMAC, выведенные из пароля один раз (два SHA256 на каждый пакет
+// в aesEncryptBlob/aesDecryptBlob не нужны). Пересобирать при смене cryptoPass.
+class CryptoSession {
+public:
+  void setPass(const String& pass);
+  bool ready() const { return keyed; }
+
+  bool encrypt(const uint8_t* plain, size_t plainLen, std::vector<uint8_t>& outBlob) const;
+  bool decrypt(const uint8_t* blob, size_t blobLen, std::vector<uint8_t>& outPlain) const;
+
+private:
+  uint8_t aesKey[32];
+  uint8_t hmacKey[32];
+  bool keyed = false;
+};
@@ -0,0 +1,78 @@
+#include "current_sampler.h"
+#include "esp_timer.h"
+
+static const uint32_t ADC_COUNTS = 4096;
+static const float    ADC_VREF   = 3.3;
+
+struct CtAcc {
+  uint32_t sum;
+  uint64_t sumSq;
+};
+
+static uint8_t nCh = 1;
+static CtCal cal[CT_MAX_CHANNELS] = { { 50.0, 0.0 }, { 50.0, 0.0 }, { 50.0, 0.0 }, { 50.0, 0.0 } };
+static portMUX_TYPE calMux = portMUX_INITIALIZER_UNLOCKED;
+
+void CurrentSamplerBegin(uint8_t channels) {
+  channels = constrain(channels, (uint8_t)1, CT_MAX_CHANNELS);
+  for (uint8_t i = 0; i < channels; i++) pinMode(CT_PINS[i], INPUT);
+  nCh = channels;
+}
+
+void CurrentSamplerSetCal(uint8_t ch, const CtCal& c) {
+  if (ch >= CT_MAX_CHANNELS) return;
+  portENTER_CRITICAL(&calMux);
+  cal[ch] = c;
+  portEXIT_CRITICAL(&calMux);
+}
+
+uint8_t CurrentSamplerChannels() {
+  return nCh;
+}
+
+// ===================== WINDOW =====================
+void CurrentSamplerRun(CtWindow& out) {
+  out = CtWindow{};
+  const uint8_t n = nCh;
+  const uint32_t periodUs = 1000000 / CT_SAMPLE_HZ;
+  uint32_t total = CT_SAMPLE_HZ * CT_WINDOW_MS / 1000;
+  total -= total % n;   // всем каналам поровну
+
+  uint8_t pins[CT_MAX_CHANNELS];
+  memcpy(pins, CT_PINS, sizeof(pins));
+  CtAcc acc[CT_MAX_CHANNELS] = {};
+
+  // сроки выборок — от начала окна: опоздание одной не сдвигает остальные
+  int64_t next = esp_timer_get_time();
+  uint8_t ch = 0;
+  for (uint32_t i = 0; i < total; i++) {
+    int64_t now;
+    while ((now = esp_timer_get_time()) < next) {}
+    if (now - next > periodUs) {
+      // вытеснили дольше периода — догонять пачкой нельзя, это исказит форму волны
+      next = now;
+      out.late++;
+    }
+    next += periodUs;
+
+    uint32_t v = analogRead(pins[ch]);
+    acc[ch].sum += v;
+    acc[ch].sumSq += v * v;
+    if (++ch == n) ch = 0;
+  }
+
+  CtCal c[CT_MAX_CHANNELS];
+  portENTER_CRITICAL(&calMux);
+  memcpy(c, cal, sizeof(c));
+  portEXIT_CRITICAL(&calMux);
+
+  out.samples = total / n;
+  const float k = ADC_VREF / ADC_COUNTS;
+  for (uint8_t i = 0; i < n; i++) {
+    // разность близких величин (~2048² каждая) — в double, во float слабый ток тонет
+    double mean = (double)acc[i].sum / out.samples;
+    double var = (double)acc[i].sumSq / out.samples - mean * mean;
+    float irms = (float)sqrt(var > 0 ? var : 0) * k * c[i].ical - c[i].offsetA;
+    out.irmsA[i] = irms > 0 ? irms : 0;
+  }
+}
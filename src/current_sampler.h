@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+
+// Общий планировщик выборок для всех каналов тока.
+// АЦП обходит каналы по кругу (ch0, ch1, ..., chN-1, ch0, ...) с постоянной
+// суммарной частотой CT_SAMPLE_HZ: каналы идут вперемешку в одном окне, а не
+// по очереди окно за окном, поэтому окно длится CT_WINDOW_MS при любом N.
+// На выборку — одно чтение АЦП и два сложения; на канал за окно — один корень.
+//
+// Окно — целое число периодов сети, у каждого канала выборки равномерно
+// покрывают его целиком, поэтому смещение средней точки вычитается точно:
+// Irms = sqrt(Σx²/n − (Σx/n)²), без фильтра, которому нужно время на разгон.
+
+static const uint8_t  CT_MAX_CHANNELS = 4;
+static const uint32_t CT_SAMPLE_HZ    = 8000;  // суммарно по всем каналам
+static const uint32_t CT_WINDOW_MS    = 200;   // 10 периодов 50 Гц
+
+// только ADC1: ADC2 занят WiFi
+static const uint8_t CT_PINS[CT_MAX_CHANNELS] = { 34, 35, 32, 33 };
+
+struct CtCal {
+  float ical;      // как в EmonLib current(pin, ical): А на полную шкалу
+  float offsetA;   // вычитается из Irms (шум тракта без нагрузки)
+};
+
+struct CtWindow {
+  float    irmsA[CT_MAX_CHANNELS];
+  uint16_t samples;   // на канал
+  uint16_t late;      // выборок, снятых позже срока (задачу вытесняли)
+};
+
+// число каналов можно менять на ходу (между окнами); калибровка сохраняется
+void CurrentSamplerBegin(uint8_t channels);
+void CurrentSamplerSetCal(uint8_t ch, const CtCal& cal);
+uint8_t CurrentSamplerChannels();
+
+// одно окно по всем каналам; занимает вызывающую задачу на CT_WINDOW_MS
+void CurrentSamplerRun(CtWindow& out);
@@ -0,0 +1,116 @@
+#include "datagram.h"
+#include "uplink_window.h"
+
+static void putU32LE(std::vector<uint8_t>& v, uint32_t x) {
+  for (int i = 0; i < 4; i++) v.push_back((uint8_t)(x >> (8 * i)));
+}
+
+static uint32_t getU32LE(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool DatagramFrame(std::vector<uint8_t>& frame, const String& deviceId, uint32_t seq,
+                   const std::vector<uint8_t>& blob) {
+  if (deviceId.length() > 0xFF || blob.size() > 0xFFFF) return false;
+
+  frame.clear();
+  frame.reserve(9 + deviceId.length() + blob.size());
+  frame.push_back(DG_REQ);
+  frame.push_back(DG_VERSION);
+  frame.push_back((uint8_t)deviceId.length());
+  frame.insert(frame.end(), deviceId.c_str(), deviceId.c_str() + deviceId.length());
+  putU32LE(frame, seq);
+  frame.push_back((uint8_t)blob.size());
+  frame.push_back((uint8_t)(blob.size() >> 8));
+  frame.insert(frame.end(), blob.begin(), blob.end());
+  return true;
+}
+
+DgParse DatagramParseAck(const uint8_t* buf, size_t len, size_t cap, DgAck& ack, size_t& frameLen) {
+  if (len >= 1 && buf[0] != DG_ACK) return DG_GARBAGE;
+  if (len >= 2 && buf[1] != DG_VERSION) return DG_GARBAGE;
+  if (len < DG_ACK_HEADER) return DG_NEED_MORE;
+
+  size_t blobLen = buf[6] | (buf[7] << 8);
+  if (DG_ACK_HEADER + blobLen > cap) return DG_GARBAGE;
+  if (len < DG_ACK_HEADER + blobLen) return DG_NEED_MORE;
+
+  ack.seq = getU32LE(buf + 2);
+  ack.blob = buf + DG_ACK_HEADER;
+  ack.blobLen = blobLen;
+  frameLen = DG_ACK_HEADER + blobLen;
+  return DG_FRAME;
+}
+
+int DatagramAckVerdict(const String& body, uint32_t seq) {
+  uint32_t ack = 0;
+  bool ok = JsonGetUInt(body, "ack", ack) && ack == seq && body.indexOf("\"OK\"") >= 0;
+  return ok ? 1 : -1;
+}
+
+// ===================== EXCHANGE =====================
+// ждём ответ именно на seq: 1 / -1 — вердикт, 0 — тишина до срока
+static int waitAck(const DgOps& ops, uint32_t seq, uint32_t sentMs, String& body) {
+  uint8_t buf[256];
+  size_t len = 0;
+
+  while (millis() - sentMs < DG_ACK_TIMEOUT) {
+    int n = ops.recv(buf + len, sizeof(buf) - len);
+    if (n < 0) return 0;
+    if (n == 0) {
+      ops.pause();
+      continue;
+    }
+    len += n;
+
+    for (;;) {
+      DgAck a;
+      size_t frame;
+      DgParse p = DatagramParseAck(buf, len, sizeof(buf), a, frame);
+      if (p == DG_NEED_MORE) break;
+      if (p == DG_GARBAGE) { len = 0; break; }
+
+      std::vector<uint8_t> plain;
+      bool auth = ops.decrypt(a.blob, a.blobLen, plain);
+      memmove(buf, buf + frame, len - frame);
+      len -= frame;
+
+      if (!auth || a.seq != seq) continue;
+      // расшифровка без завершающего нуля — длину задаём явно
+      body = String((const char*)plain.data(), plain.size());
+      return DatagramAckVerdict(body, seq);
+    }
+  }
+  return 0;
+}
+
+int DatagramExchange(const DgOps& ops, const std::vector<uint8_t>& frame, uint32_t seq, DgResult& r) {
+  for (uint8_t attempt = 0; attempt < DG_RETRIES; attempt++) {
+    r.sentMs = millis();
+    uint32_t t0 = micros();
+    if (!ops.send(frame.data(), frame.size())) return 0;
+    r.sendUs = micros() - t0;
+
+    int v = waitAck(ops, seq, r.sentMs, r.body);
+    if (v) {
+      r.rttMs = millis() - r.sentMs;
+      return v;
+    }
+  }
+  return 0;
+}
+
+bool DatagramAllowed(const DgHoldoff& h, uint32_t nowMs) {
+  return !h.downUntilMs || (int32_t)(nowMs - h.downUntilMs) >= 0;
+}
+
+void DatagramReached(DgHoldoff& h) {
+  h.fails = 0;
+}
+
+bool DatagramFailed(DgHoldoff& h, uint32_t nowMs) {
+  if (++h.fails < DG_FAILS_TO_HOLDOFF) return false;
+  h.fails = 0;
+  h.downUntilMs = nowMs + DG_HOLDOFF;
+  return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+
+// Кадры датаграммного аплинка (приёмник — udp.php):
+// запрос: 'D' | ver | idLen | device_id | seq u32 LE | blobLen u16 LE | blob
+// ответ:  'A' | ver | seq u32 LE | blobLen u16 LE | blob({"status":"OK","ack":seq,"ts":...})
+// Эталонный приёмник без железа и PHP — scripts/udp_ref_receiver.py.
+static const uint8_t DG_REQ = 'D';
+static const uint8_t DG_ACK = 'A';
+static const uint8_t DG_VERSION = 1;
+static const size_t  DG_ACK_HEADER = 8;
+
+// false — не влезает в формат (device_id длиннее 255, blob длиннее 65535)
+bool DatagramFrame(std::vector<uint8_t>& frame, const String& deviceId, uint32_t seq,
+                   const std::vector<uint8_t>& blob);
+
+// Ответы читаются в буфер ёмкостью cap и могут прийти слитно или по кускам.
+// DG_FRAME — в начале буфера целый кадр длиной frameLen (blob указывает внутрь buf);
+// DG_GARBAGE — не ответ или не влезет в буфер: буфер сбросить
+enum DgParse { DG_NEED_MORE, DG_FRAME, DG_GARBAGE };
+struct DgAck {
+  uint32_t       seq;
+  const uint8_t* blob;
+  size_t         blobLen;
+};
+DgParse DatagramParseAck(const uint8_t* buf, size_t len, size_t cap, DgAck& ack, size_t& frameLen);
+
+// расшифрованный ответ на seq: 1 — принято, -1 — отказ (gap/notreg/badreq — разберётся HTTP-путь)
+int DatagramAckVerdict(const String& body, uint32_t seq);
+
+// Обмен: кадр уходит до DG_RETRIES раз (повтор — тот же nonce, сервер не запишет
+// дважды), на каждую попытку ждём ответ на свой seq DG_ACK_TIMEOUT; чужие и
+// устаревшие ответы пропускаются. Канал и ключ — через ops: на железе Transport
+// и CryptoSession (gsm_uplink.cpp), на хосте — сокет и эталонный приёмник.
+static const uint8_t  DG_RETRIES = 3;
+static const uint32_t DG_ACK_TIMEOUT = 3000;
+static const uint8_t  DG_FAILS_TO_HOLDOFF = 3;
+static const uint32_t DG_HOLDOFF = 600000;  // после серии отказов — только HTTP
+
+struct DgOps {
+  bool (*send)(const uint8_t* data, size_t len);
+  int  (*recv)(uint8_t* buf, size_t maxLen);  // сколько прочитано, 0 — пока ничего, <0 — сокет закрыт
+  bool (*decrypt)(const uint8_t* blob, size_t len, std::vector<uint8_t>& plain);
+  void (*pause)();                           // между опросами recv
+};
+
+struct DgResult {
+  uint32_t sentMs;   // отправка последней попытки
+  uint32_t rttMs;
+  uint32_t sendUs;   // чистое время записи кадра
+  String   body;     // расшифрованный ответ
+};
+
+// 1 — принято, -1 — сервер отказал (gap/notreg/badreq), 0 — ответа нет
+int DatagramExchange(const DgOps& ops, const std::vector<uint8_t>& frame, uint32_t seq, DgResult& r);
+
+// серия обменов без ответа — UDP на DG_HOLDOFF выключается
+struct DgHoldoff {
+  uint8_t  fails;
+  uint32_t downUntilMs;   // 0 — не выключен
+};
+bool DatagramAllowed(const DgHoldoff& h, uint32_t nowMs);
+void DatagramReached(DgHoldoff& h);                   // сервер ответил (хоть и отказом)
+bool DatagramFailed(DgHoldoff& h, uint32_t nowMs);    // true — ушли в holdoff
@@ -0,0 +1,152 @@
+#include "dlog.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "pipeline.h"
+
+// ===================== RING =====================
+// Ограниченная MPSC-очередь (схема Вьюкова): у каждой ячейки свой seq,
+// производители резервируют позицию CAS-ом, потребитель один.
+struct DlogEvent {
+  std::atomic<uint32_t> seq;
+  const char* fmt;
+  uint32_t ms;
+  uint8_t  level;
+  uint8_t  n;
+  uint32_t a[DLOG_MAX_ARGS];
+};
+
+static const uint32_t DLOG_SLOTS = 128;   // степень двойки
+static DlogEvent ring[DLOG_SLOTS];
+static std::atomic<uint32_t> enqPos{0};
+static uint32_t deqPos = 0;
+static std::atomic<uint32_t> dropped{0};
+static bool started = false;
+
+void dlogPush(uint8_t level, const char* fmt, uint8_t n, const uint32_t* args) {
+  if (!started) return;
+
+  uint32_t pos = enqPos.load(std::memory_order_relaxed);
+  DlogEvent* e;
+  while (true) {
+    e = &ring[pos & (DLOG_SLOTS - 1)];
+    int32_t dif = (int32_t)(e->seq.load(std::memory_order_acquire) - pos);
+    if (dif == 0) {
+      if (enqPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (dif < 0) {
+      dropped.fetch_add(1, std::memory_order_relaxed);   // полно
+      return;
+    } else {
+      pos = enqPos.load(std::memory_order_relaxed);
+    }
+  }
+
+  e->fmt = fmt;
+  e->ms = millis();
+  e->level = level;
+  e->n = n;
+  for (uint8_t i = 0; i < n; i++) e->a[i] = args[i];
+  e->seq.store(pos + 1, std::memory_order_release);
+}
+
+static bool dlogPop(DlogEvent& out) {
+  DlogEvent& e = ring[deqPos & (DLOG_SLOTS - 1)];
+  if ((int32_t)(e.seq.load(std::memory_order_acquire) - (deqPos + 1)) < 0) return false;
+
+  out.fmt = e.fmt;
+  out.ms = e.ms;
+  out.level = e.level;
+  out.n = e.n;
+  memcpy(out.a, e.a, sizeof(out.a));
+  e.seq.store(deqPos + DLOG_SLOTS, std::memory_order_release);
+  deqPos++;
+  return true;
+}
+
+// ===================== FORMAT =====================
+// проходим формат по спецификаторам и подставляем слова по типу конверсии
+static size_t dlogFormat(char* out, size_t cap, const DlogEvent& e) {
+  size_t len = 0;
+  uint8_t ai = 0;
+  const char* p = e.fmt;
+
+  while (*p && len + 1 < cap) {
+    if (*p != '%') { out[len++] = *p++; continue; }
+    if (p[1] == '%') { out[len++] = '%'; p += 2; continue; }
+
+    // выделяем один спецификатор: %[флаги][ширина][.точность][длина]тип
+    char spec[16];
+    size_t sl = 0;
+    spec[sl++] = *p++;
+    while (*p && strchr("-+ #0123456789.", *p) && sl < sizeof(spec) - 3) spec[sl++] = *p++;
+    while (*p && strchr("hlzjt", *p)) p++;          // слова всегда 32 бита
+    char conv = *p ? *p++ : 'd';
+    spec[sl++] = conv;
+    spec[sl] = 0;
+
+    uint32_t w = ai < e.n ? e.a[ai++] : 0;
+    int n;
+    switch (conv) {
+      case 'f': case 'e': case 'g': {
+        float f;
+        memcpy(&f, &w, 4);
+        n = snprintf(out + len, cap - len, spec, (double)f);
+        break;
+      }
+      case 's':
+        n = snprintf(out + len, cap - len, spec, (const char*)(uintptr_t)w);
+        break;
+      case 'c':
+        n = snprintf(out + len, cap - len, spec, (int)w);
+        break;
+      case 'd': case 'i':
+        n = snprintf(out + len, cap - len, spec, (int)(int32_t)w);
+        break;
+      default:   // u x X o p
+        n = snprintf(out + len, cap - len, spec, (unsigned)w);
+        break;
+    }
+    if (n > 0) len += min((size_t)n, cap - 1 - len);
+  }
+  out[len] = 0;
+  return len;
+}
+
+// ===================== TASK =====================
+static void dlogTask(void* pv) {
+  (void)pv;
+  static const char LEVEL_CH[] = "?EWID";
+  uint32_t reportedDrops = 0;
+  char line[192];
+  DlogEvent e;
+
+  while (true) {
+    bool any = false;
+    while (dlogPop(e)) {
+      any = true;
+      int h = snprintf(line, sizeof(line), "[%7lu] %c ", (unsigned long)e.ms, LEVEL_CH[e.level <= DLOG_LVL_DEBUG ? e.level : 0]);
+      size_t n = h + dlogFormat(line + h, sizeof(line) - h - 1, e);
+      if (n && line[n - 1] != '\n') line[n++] = '\n';
+      Serial.write((const uint8_t*)line, n);
+    }
+
+    uint32_t d = dropped.load(std::memory_order_relaxed);
+    if (d != reportedDrops) {
+      Serial.printf("[dlog] dropped %lu events\n", (unsigned long)(d - reportedDrops));
+      reportedDrops = d;
+    }
+
+    if (!any) vTaskDelay(pdMS_TO_TICKS(20));
+  }
+}
+
+void DlogStart() {
+  if (started) return;
+  for (uint32_t i = 0; i < DLOG_SLOTS; i++) ring[i].seq.store(i, std::memory_order_relaxed);
+  started = true;
+  xTaskCreatePinnedToCore(dlogTask, "dlog", 3072, nullptr, PRIO_LOG, nullptr, CORE_IO);
+}
+
+uint32_t DlogDropped() {
+  return dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+#include <type_traits>
+
+// Отложенный лог: вызов кладёт в lock-free кольцо только указатель на формат
+// (он же ID события), время и до 6 аргументов по 32 бита; текст собирает и
+// печатает задача низкого приоритета. При переполнении событие теряется
+// и считается, вызывающая задача никогда не ждёт UART.
+//
+// Ограничения формата: не больше DLOG_MAX_ARGS аргументов; %s — только строки
+// со статическим временем жизни (литералы, name() транспортов); %f — float/double
+// (хранится как float). Длинные модификаторы (%ld, %lu) допустимы.
+//
+// Уровень отсекается при компиляции: вызовы выше DLOG_LEVEL не попадают в прошивку.
+
+#define DLOG_LVL_ERROR 1
+#define DLOG_LVL_WARN  2
+#define DLOG_LVL_INFO  3
+#define DLOG_LVL_DEBUG 4
+
+#ifndef DLOG_LEVEL
+#define DLOG_LEVEL DLOG_LVL_INFO
+#endif
+
+static const uint8_t DLOG_MAX_ARGS = 6;
+
+void DlogStart();                 // задача вывода (приоритет 1)
+uint32_t DlogDropped();           // потеряно событий с момента старта
+void dlogPush(uint8_t level, const char* fmt, uint8_t n, const uint32_t* args);
+
+// упаковка аргумента в 32-битное слово
+template <typename T>
+static inline uint32_t dlogWord(T v) {
+  if constexpr (std::is_floating_point<T>::value) {
+    float f = (float)v;
+    uint32_t w;
+    memcpy(&w, &f, 4);
+    return w;
+  } else if constexpr (std::is_pointer<T>::value) {
+    return (uint32_t)(uintptr_t)v;
+  } else {
+    return (uint32_t)v;
+  }
+}
+
+template <typename... A>
+static inline void dlogEmit(uint8_t level, const char* fmt, A... a) {
+  static_assert(sizeof...(A) <= DLOG_MAX_ARGS, "dlog: too many arguments");
+  uint32_t w[sizeof...(A) ? sizeof...(A) : 1] = { dlogWord(a)... };
+  dlogPush(level, fmt, (uint8_t)sizeof...(A), w);
+}
+
+#define DLOG_AT(lvl, fmt, ...) \
+  do { if ((lvl) <= DLOG_LEVEL) dlogEmit((lvl), fmt, ##__VA_ARGS__); } while (0)
+
+#define DLOGE(fmt, ...) DLOG_AT(DLOG_LVL_ERROR, fmt, ##__VA_ARGS__)
+#define DLOGW(fmt, ...) DLOG_AT(DLOG_LVL_WARN,  fmt, ##__VA_ARGS__)
+#define DLOGI(fmt, ...) DLOG_AT(DLOG_LVL_INFO,  fmt, ##__VA_ARGS__)
+#define DLOGD(fmt, ...) DLOG_AT(DLOG_LVL_DEBUG, fmt, ##__VA_ARGS__)
@@ -0,0 +1,132 @@
+#include "endpoints.h"
+#include <vector>
+#include "dlog.h"
+
+static const size_t   MAX_ENDPOINTS   = 4;
+static const uint32_t DNS_TTL_MS      = 3600UL * 1000UL; // модем TTL не отдаёт — держим час
+static const uint32_t ORDER_BIAS_MS   = 1500;  // резервный должен быть заметно быстрее, чтобы победить
+static const uint32_t FAIL_SAMPLE_MS  = 15000; // неудача считается как очень медленный обмен
+static const uint8_t  FAILS_TO_DOWN   = 2;
+static const uint32_t DOWN_MIN_MS     = 60000;
+static const uint32_t DOWN_MAX_MS     = 600000;
+static const uint32_t REMEASURE_MS    = 300000; // без обменов дольше — оценка сбрасывается и сервер пробуется заново
+
+static std::vector<Endpoint> eps;
+static String configured;
+static uint16_t configuredPort;
+
+static bool isIpLiteral(const String& h) {
+  if (!h.length()) return false;
+  for (size_t i = 0; i < h.length(); i++) {
+    char c = h[i];
+    if (c != '.' && (c < '0' || c > '9')) return false;
+  }
+  return true;
+}
+
+void EndpointsConfigure(const String& hostList, uint16_t defPort) {
+  if (hostList == configured && defPort == configuredPort && !eps.empty()) return;
+  configured = hostList;
+  configuredPort = defPort;
+  eps.clear();
+
+  int start = 0;
+  while (start <= (int)hostList.length() && eps.size() < MAX_ENDPOINTS) {
+    int comma = hostList.indexOf(',', start);
+    String item = comma < 0 ? hostList.substring(start) : hostList.substring(start, comma);
+    item.trim();
+
+    if (item.length()) {
+      Endpoint e{};
+      int colon = item.indexOf(':');
+      e.host = colon < 0 ? item : item.substring(0, colon);
+      e.port = colon < 0 ? defPort : (uint16_t)item.substring(colon + 1).toInt();
+      if (!e.port) e.port = defPort;
+      if (isIpLiteral(e.host)) e.ip = e.host;
+      eps.push_back(e);
+    }
+
+    if (comma < 0) break;
+    start = comma + 1;
+  }
+
+  Serial.printf("Endpoints: %u configured\n", (unsigned)eps.size());
+}
+
+size_t EndpointsCount() {
+  return eps.size();
+}
+
+const Endpoint& EndpointsGet(int idx) {
+  return eps[idx];
+}
+
+// меньше — лучше; порядок в списке даёт небольшой перевес основному (fail-back)
+static uint32_t score(size_t i) {
+  return eps[i].latencyMs + i * ORDER_BIAS_MS;
+}
+
+int EndpointsPick(uint32_t triedMask) {
+  uint32_t now = millis();
+  int best = -1;
+  int soonest = -1;
+
+  for (size_t i = 0; i < eps.size(); i++) {
+    if (triedMask & (1UL << i)) continue;
+    Endpoint& e = eps[i];
+    if (e.downUntilMs && (int32_t)(now - e.downUntilMs) < 0) {
+      if (soonest < 0 || (int32_t)(e.downUntilMs - eps[soonest].downUntilMs) < 0) soonest = i;
+      continue;
+    }
+    e.downUntilMs = 0;
+    // проигравший (чаще всего основной после случайной неудачи) иначе не мерился бы
+    // никогда: старая оценка сбрасывается, и он снова в выборе по порядку
+    if (e.latencyMs && now - e.measuredMs >= REMEASURE_MS) e.latencyMs = 0;
+    if (best < 0 || score(i) < score(best)) best = i;
+  }
+
+  // все в карантине — пробуем тот, что выйдет раньше
+  return best >= 0 ? best : soonest;
+}
+
+bool EndpointsResolve(int idx, EndpointResolver resolve, String& ip) {
+  Endpoint& e = eps[idx];
+  if (isIpLiteral(e.host)) {
+    ip = e.host;
+    return true;
+  }
+  if (e.ip.length() && (int32_t)(millis() - e.ipExpiresMs) < 0) {
+    ip = e.ip;
+    return true;
+  }
+  if (!resolve(e.host, ip)) return false;
+
+  e.ip = ip;
+  e.ipExpiresMs = millis() + DNS_TTL_MS;
+  DLOGD("DNS ep=%d resolved", idx);
+  return true;
+}
+
+void EndpointsReport(int idx, bool ok, uint32_t latencyMs) {
+  if (idx < 0 || (size_t)idx >= eps.size()) return;
+  Endpoint& e = eps[idx];
+  e.measuredMs = millis();
+
+  if (ok) {
+    e.fails = 0;
+    e.latencyMs = e.latencyMs ? (e.latencyMs * 3 + latencyMs) / 4 : latencyMs;
+    return;
+  }
+
+  e.fails++;
+  e.latencyMs = e.latencyMs ? (e.latencyMs * 3 + FAIL_SAMPLE_MS) / 4 : FAIL_SAMPLE_MS;
+  if (!isIpLiteral(e.host)) e.ip = "";  // адрес мог смениться
+
+  if (e.fails >= FAILS_TO_DOWN) {
+    uint32_t down = DOWN_MIN_MS << min<uint8_t>(e.fails - FAILS_TO_DOWN, 4);
+    if (down > DOWN_MAX_MS) down = DOWN_MAX_MS;
+    e.downUntilMs = millis() + down;
+    e.latencyMs = 0;  // после карантина меряем заново
+    DLOGW("Endpoint %d (port %u) down for %u s", idx, e.port, (unsigned)(down / 1000));
+  }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <Arduino.h>
+
+// Список серверов аплинка по приоритету с кэшем DNS и оценкой здоровья.
+// serverHost в конфиге: "host[:port][,host2[:port]...]".
+struct Endpoint {
+  String   host;
+  uint16_t port;
+  String   ip;           // кэш DNS ("" — не разрешён)
+  uint32_t ipExpiresMs;
+  uint32_t latencyMs;    // EWMA RTT успешных обменов (0 — ещё не мерили)
+  uint32_t measuredMs;   // когда был последний обмен (устаревший замер меряем заново)
+  uint8_t  fails;        // подряд
+  uint32_t downUntilMs;  // в карантине до (0 — здоров)
+};
+
+typedef bool (*EndpointResolver)(const String& host, String& ip);
+
+void EndpointsConfigure(const String& hostList, uint16_t defPort); // пересобирает только при изменении
+size_t EndpointsCount();
+int  EndpointsPick(uint32_t triedMask = 0);               // лучший доступный, кроме отмеченных битом 1<<idx; -1 — некого
+const Endpoint& EndpointsGet(int idx);
+bool EndpointsResolve(int idx, EndpointResolver resolve, String& ip); // из кэша или через resolve
+void EndpointsReport(int idx, bool ok, uint32_t latencyMs = 0);
@@ -2,11 +2,28 @@
 
 #include <TinyGsmClient.h>
 #include <ArduinoHttpClient.h>
-#include <Preferences.h>
+#include <atomic>
 
 #include "sensors.h"
 #include "ring_store.h"
+#include "history.h"
 #include "crypto_aes.h"
+#include "lz_pack.h"
+#include "http_resp.h"
+#include "time_sync.h"
+#include "boot_timing.h"
+#include "endpoints.h"
+#include "transport.h"
+#include "config_store.h"
+#include "metrics.h"
+#include "dlog.h"
+#include "pipeline.h"
+#include "power.h"
+#include "uplink_fsm.h"
+#include "uplink_window.h"
+#include "seq_lease.h"
+#include "modem_baud.h"
+#include "datagram.h"
 
 // ===================== Serial =====================
 #define SerialMon Serial
@@ -24,34 +41,80 @@ static TinyGsm modem(SerialAT);
 static TinyGsmClient gsmClient(modem);
 
 // ===================== CONFIG =====================
-static Preferences prefs;
+// значения берутся из снимка config_store; пересборка — только по уведомлению
 static String cfgHost;
 static uint16_t cfgPort;
-static String cryptoPass;
+static String wifiSsid;
+static String wifiPass;
+static uint16_t cfgUdpPort;   // датаграммный аплинк, 0 — выкл
+static CryptoSession crypto;
+static std::atomic<uint32_t> cfgChanged{CFG_CH_ALL};  // группы, ждущие применения
 
 // ===================== DEVICE =====================
 static String deviceId;
+static EventGroupHandle_t gsmEvents = nullptr;
+
+static bool modemReady() {
+  return gsmEvents && (xEventGroupGetBits(gsmEvents) & GSM_EV_MODEM_READY);
+}
+
+// ===================== BATCH =====================
+#define UPLINK_COMPRESS 1          // сжимать пакеты бэклога перед шифрованием
 
 // ===================== HELPERS =====================
-static void loadUplinkCfg() {
-  prefs.begin("cfg", true);
-  cfgHost    = prefs.getString("serverHost", "78.138.169.178");
-  cfgPort    = prefs.getUShort("serverPort", 33775);
-  cryptoPass = prefs.getString("cryptoPass", "12345678");
-  prefs.end();
+// слушатель config_store: выполняется в задаче, сохранившей конфиг,
+// поэтому только помечаем — применяет сам gsmTask между обменами
+static void onConfigChanged(const Config&, uint32_t changed, void*) {
+  cfgChanged |= changed;
+}
+
+static void noteBackfill(const String& body);
+static void wifiApply();
+
+static void applyUplinkCfg() {
+  uint32_t changed = cfgChanged.exchange(0);
+  if (!changed) return;
+
+  ConfigSnapshot c = ConfigGet();
+  if (changed & CFG_CH_SERVER) {
+    cfgHost    = c->serverHost;
+    cfgPort    = c->serverPort;
+    cfgUdpPort = c->udpPort;
+    // пакетный режим: наибольшая задержка доставки, 0 — GPRS всегда
+    UplinkFsmSetMaxLatency(c->uplinkMaxS ? max((uint32_t)c->uplinkMaxS, (uint32_t)60) * 1000 : 0);
+    EndpointsConfigure(cfgHost, cfgPort);
+  }
+  if (changed & CFG_CH_CRYPTO) {
+    crypto.setPass(c->cryptoPass);
+    UplinkWindowReset();
+  }
+  if (changed & CFG_CH_WIFI) {
+    wifiSsid = c->wifiSsid;
+    wifiPass = c->wifiPass;
+    wifiApply();
+  }
 }
 
-static uint32_t loadSeq() {
-  prefs.begin("uplink", false);
-  uint32_t seq = prefs.getUInt("seq", 1);
-  prefs.end();
-  return seq;
+// размер шифротекста после PKCS7 (кратно 16, минимум +1 байт паддинга)
+static size_t paddedLen(size_t n) {
+  return (n / 16 + 1) * 16;
 }
 
-static void saveSeq(uint32_t seq) {
-  prefs.begin("uplink", false);
-  prefs.putUInt("seq", seq);
-  prefs.end();
+// JSON -> (LZ, если реально экономит блоки AES) -> AES blob
+static bool encryptPayload(const String& plain, std::vector<uint8_t>& blob) {
+  const uint8_t* p = (const uint8_t*)plain.c_str();
+  size_t len = plain.length();
+
+#if UPLINK_COMPRESS
+  std::vector<uint8_t> packed;
+  if (len > 64 && lzPack(p, len, packed) &&
+      paddedLen(packed.size()) < paddedLen(len)) {
+    DLOGD("LZ: %u -> %u", (unsigned)len, (unsigned)packed.size());
+    return crypto.encrypt(packed.data(), packed.size(), blob);
+  }
+#endif
+
+  return crypto.encrypt(p, len, blob);
 }
 
 static String makeDeviceId() {
@@ -90,98 +153,315 @@ static String makeDeviceId() {
 */
 /**/
 
-static bool postBlob(const char* path,
-                     const uint8_t* blob,
-                     size_t blobLen,
-                     int& outStatus,
-                     String& outBody) {
+// ===================== HTTP CONNECTION =====================
+// байты, прочитанные из сокета, но ещё не разобранные
+// (при конвейерной отправке там может лежать начало следующего ответа)
+static uint8_t rxBuf[128];
+static size_t rxPos = 0;
+static size_t rxLen = 0;
+
+// время отправки запросов, ответ на которые ещё не прочитан (FIFO) —
+// из него и времени сервера в ответе получаем выборку для подстройки RTC
+struct SentReq {
+  uint32_t ms;
+  uint32_t bytes;
+  uint32_t writeUs;   // сколько шла запись запроса (для оценки скорости канала)
+};
+static SentReq sentAt[8];
+static uint8_t sentHead = 0;
+static uint8_t sentCount = 0;
+
+static void noteServerTime(uint32_t sentMs, const HttpResp& resp) {
+  uint32_t ts = 0;
+  if (!JsonGetUInt(resp.body, "ts", ts)) ts = resp.date;
+  TimeSyncSample(sentMs, millis(), ts);
+}
 
-  SerialMon.println("---- HTTP POST BEGIN ----");
-    SerialMon.println(path);
+static int curEp = -1;  // сервер текущего соединения
 
-  if (!modem.isGprsConnected()) {
-    SerialMon.println("GPRS NOT CONNECTED!");
-    outStatus = -100;
+// DNS через модем: AT+CDNSGIP -> OK, затем +CDNSGIP: 1,"host","ip"[,"ip2"]
+static bool modemResolve(const String& host, String& ip) {
+  modem.sendAT(GF("+CDNSGIP=\""), host.c_str(), GF("\""));
+  if (modem.waitResponse(2000) != 1) return false;
+  if (modem.waitResponse(15000, GF("+CDNSGIP:")) != 1) return false;
+
+  String line = modem.stream.readStringUntil('\n');
+  line.trim();
+  if (!line.startsWith("1,")) {
+    DLOGW("DNS failed (modem)");
     return false;
   }
 
-  gsmClient.stop();
-  delay(100);
+  int c2 = line.indexOf(',', 2);              // после "host"
+  int q1 = c2 < 0 ? -1 : line.indexOf('"', c2);
+  int q2 = q1 < 0 ? -1 : line.indexOf('"', q1 + 1);
+  if (q2 <= q1 + 1) return false;
+  ip = line.substring(q1 + 1, q2);
+  return true;
+}
 
-  SerialMon.println("Opening TCP...");
+// ===================== TRANSPORT =====================
+// UDP через SIM900: TinyGSM умеет только TCP, поэтому сокет на mux 1
+// открываем сами (AT+CIPSTART=1,"UDP",...); отправка/приём — штатные
+// CIPSEND/CIPRXGET клиента, каждый write уходит одной датаграммой
+class GsmUdpClient : public TinyGsmClient {
+public:
+  explicit GsmUdpClient(TinyGsm& m) : TinyGsmClient(m, 1) {}
+
+  bool openUdp(const String& ip, uint16_t port) {
+    stop();
+    modem.sendAT(GF("+CIPSTART="), 1, GF(",\"UDP\",\""), ip.c_str(), GF("\","), port);
+    if (modem.waitResponse(2000) != 1) return false;
+    if (modem.waitResponse(10000, GF("1, CONNECT OK" GSM_NL), GF("1, ALREADY CONNECT" GSM_NL)) == 0) {
+      return false;
+    }
+    sock_connected = true;
+    return true;
+  }
+};
+
+static GsmUdpClient gsmUdp(modem);
+
+class GsmTransport : public Transport {
+public:
+  GsmTransport() { priorBps = 1000; }
+  const char* name() const override { return "gsm"; }
+  bool begin() override { return true; }  // модем поднимает MODEM_INIT
+  bool linkUp() override { return modemReady() && modem.isGprsConnected(); }
+  bool resolve(const String& host, String& ip) override { return modemResolve(host, ip); }
+  Client& client() override { return gsmClient; }
+
+  bool udpOpen(const String& ip, uint16_t port) override { return gsmUdp.openUdp(ip, port); }
+  bool udpSend(const uint8_t* data, size_t len) override { return gsmUdp.write(data, len) == len; }
+  int  udpRecv(uint8_t* buf, size_t maxLen) override {
+    int avail = gsmUdp.available();
+    if (avail <= 0) return gsmUdp.connected() ? 0 : -1;
+    return gsmUdp.read(buf, min((size_t)avail, maxLen));
+  }
+  void udpClose() override { gsmUdp.stop(); }
+};
 
-  if (!gsmClient.connect(cfgHost.c_str(), cfgPort)) {
-    SerialMon.println("TCP connect FAILED");
-    outStatus = -101;
-    return false;
+static GsmTransport gsmTransport;
+static Transport* net = &gsmTransport;  // канал текущего соединения
+
+static bool netResolve(const String& host, String& ip) {
+  return net->resolve(host, ip);
+}
+
+// Ethernet в списке только после удачного begin(): без DHCP-адреса он не канал.
+// Не поднялся (кабель, DHCP) — повторяем не чаще ETH_RETRY_MS из CONNECT
+static const uint32_t ETH_RETRY_MS = 300000;
+static Transport* ethPending = nullptr;
+static uint32_t ethTriedMs = 0;
+
+static void ethTryBegin() {
+  if (!ethPending) return;
+  if (ethTriedMs && millis() - ethTriedMs < ETH_RETRY_MS) return;
+  ethTriedMs = millis();
+  if (!ethPending->begin()) return;
+  TransportAdd(ethPending);
+  ethPending = nullptr;
+}
+
+static bool transportsUp = false;
+static bool wifiAdded = false;
+
+// WiFi по текущему конфигу: новый ssid/пароль — переподключение, пустой — радио
+// выключено (канал остаётся в списке, но не поднят). Пока WiFi включён, light sleep нельзя
+static void wifiApply() {
+  if (!transportsUp) return;   // до transportsBegin конфиг только запоминаем
+  Transport* wifi = TransportWifiSta(wifiSsid, wifiPass);
+  bool on = wifi->begin();
+  if (on && !wifiAdded) {
+    TransportAdd(wifi);
+    wifiAdded = true;
   }
+  PowerKeepRadio(on);
+}
 
-  SerialMon.println("TCP connected");
+// один раз: регистрируем каналы; Ethernet/WiFi поднимаются в фоне от модема
+static void transportsBegin() {
+  if (transportsUp) return;
+  transportsUp = true;
 
-  // ===== HTTP HEADER =====
-  gsmClient.print("POST ");
-  gsmClient.print(path);
-  gsmClient.println(" HTTP/1.1");
+  TransportAdd(&gsmTransport);
 
-  gsmClient.print("Host: ");
-  gsmClient.println(cfgHost);
+  ethPending = TransportEthernet();
+  ethTryBegin();
 
-  gsmClient.println("Connection: close");
-  gsmClient.println("Content-Type: application/octet-stream");
+  wifiApply();
+}
 
-  gsmClient.print("Content-Length: ");
-  gsmClient.println(blobLen);
+static int httpOpen() {
+  net = TransportSelect();
+  if (!net) {
+    DLOGW("NO UPLINK LINK!");
+    return -100;
+  }
+
+  net->client().stop();
+  rxPos = rxLen = 0;
+  sentCount = 0;
+
+  // перебираем серверы по оценке здоровья, пока один не примет TCP
+  uint32_t tried = 0;   // битовая маска: каждый сервер — не больше одного раза
+  for (size_t attempt = 0; attempt < EndpointsCount(); attempt++) {
+    curEp = EndpointsPick(tried);
+    if (curEp < 0) break;
+    const Endpoint& ep = EndpointsGet(curEp);
+
+    String ip;
+    if (!EndpointsResolve(curEp, netResolve, ip)) {
+      EndpointsReport(curEp, false);
+      tried |= 1UL << curEp;
+      continue;
+    }
 
-  gsmClient.println();
+    DLOGI("Opening TCP [%s] ep=%d port=%u...", net->name(), curEp, ep.port);
+    uint32_t t0 = micros();
+    bool connected = net->client().connect(ip.c_str(), ep.port);
+    MetricObserveUs(MH_HTTP_CONNECT, micros() - t0);
+    if (connected) {
+      DLOGI("TCP connected");
+      return 0;
+    }
 
-  // ===== BODY =====
-  gsmClient.write(blob, blobLen);
+    DLOGW("TCP connect FAILED");
+    EndpointsReport(curEp, false);
+    tried |= 1UL << curEp;
+  }
 
-  SerialMon.println("Request sent");
+  return -101;
+}
+
+// заголовок и тело одним write: каждый write у модема — отдельный AT+CIPSEND
+static bool httpSendRequest(const char* path, const uint8_t* blob, size_t blobLen,
+                            bool keepAlive) {
+  MetricScope m(MH_HTTP_SEND);
+  String hdr;
+  hdr.reserve(160);
+  hdr += "POST ";
+  hdr += path;
+  hdr += " HTTP/1.1\r\n";
+  hdr += "Host: " + EndpointsGet(curEp).host + "\r\n";
+  hdr += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+  hdr += "Content-Type: application/octet-stream\r\n";
+  hdr += "Content-Length: " + String((unsigned)blobLen) + "\r\n\r\n";
+
+  std::vector<uint8_t> req(hdr.length() + blobLen);
+  memcpy(req.data(), hdr.c_str(), hdr.length());
+  memcpy(req.data() + hdr.length(), blob, blobLen);
+
+  uint32_t sentMs = millis();
+  uint32_t t0 = micros();
+  if (net->client().write(req.data(), req.size()) != req.size()) return false;
+  uint32_t writeUs = micros() - t0;
+  MetricCount(MC_BYTES_UP, req.size());
+
+  if (sentCount < sizeof(sentAt) / sizeof(sentAt[0])) {
+    sentAt[(sentHead + sentCount) % (sizeof(sentAt) / sizeof(sentAt[0]))] = { sentMs, (uint32_t)req.size(), writeUs };
+    sentCount++;
+  }
+  return true;
+}
+
+// 0 — ответ разобран, иначе код ошибки (-3 таймаут, -4 битый ответ)
+static int httpReadResponse(HttpResp& resp, uint32_t timeoutMs) {
+  MetricScope m(MH_HTTP_RESPONSE);
+  HttpRespReset(resp);
 
-  // ===== READ RESPONSE =====
   unsigned long t0 = millis();
-  while (!gsmClient.available()) {
-    if (millis() - t0 > 15000) {
-      SerialMon.println("Response timeout");
-      gsmClient.stop();
-      outStatus = -3;
-      return false;
+  uint32_t rxT0 = 0;   // первый байт ответа: дальше — передача, до него — ожидание сервера
+  while (!HttpRespDone(resp) && !HttpRespFailed(resp)) {
+    if (rxPos < rxLen) {
+      if (!rxT0) rxT0 = micros() | 1;
+      rxPos += HttpRespFeed(resp, rxBuf + rxPos, rxLen - rxPos);
+      continue;
+    }
+
+    // читаем то, что уже пришло, и отдаём процессор другим задачам,
+    // ответ готов сразу по приходу объявленной длины тела
+    Client& cl = net->client();
+    int avail = cl.available();
+    if (avail > 0) {
+      int n = cl.read(rxBuf, min((size_t)avail, sizeof(rxBuf)));
+      rxPos = 0;
+      rxLen = n > 0 ? (size_t)n : 0;
+      continue;
+    }
+    if (!cl.connected()) {
+      HttpRespFinishOnClose(resp);
+      break;
     }
+    if (millis() - t0 > timeoutMs) {
+      DLOGW("Response timeout");
+      EndpointsReport(curEp, false);
+      return -3;
+    }
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+
+  if (!HttpRespDone(resp)) {
+    DLOGW("Bad HTTP response");
+    EndpointsReport(curEp, false);
+    return -4;
+  }
+
+  if (sentCount) {
+    const SentReq& rq = sentAt[sentHead];
+    EndpointsReport(curEp, resp.status < 500, millis() - rq.ms);
+    TransportReport(net, rq.bytes + resp.body.length(), rq.writeUs + (micros() - rxT0));
+    noteServerTime(rq.ms, resp);
+    sentHead = (sentHead + 1) % (sizeof(sentAt) / sizeof(sentAt[0]));
+    sentCount--;
   }
+  return 0;
+}
+
+// ===================== HTTP POST =====================
+static bool postBlob(const char* path,
+                     const uint8_t* blob,
+                     size_t blobLen,
+                     int& outStatus,
+                     String& outBody) {
 
-  String statusLine = gsmClient.readStringUntil('\n');
-  SerialMon.print("STATUS LINE: ");
-  SerialMon.println(statusLine);
+  DLOGI("POST %s", path);
 
-  int code = -1;
-  if (statusLine.startsWith("HTTP/1.1")) {
-    code = statusLine.substring(9, 12).toInt();
+  outStatus = httpOpen();
+  if (outStatus) {
+    MetricCount(MC_POST_FAIL);
+    return false;
   }
 
-  outStatus = code;
+  if (!httpSendRequest(path, blob, blobLen, false)) {
+    DLOGW("TCP write FAILED");
+    net->client().stop();
+    outStatus = -102;
+    MetricCount(MC_POST_FAIL);
+    return false;
+  }
 
-  outBody = "";
-  while (gsmClient.available()) {
-    outBody += gsmClient.readString();
+  HttpResp resp;
+  int err = httpReadResponse(resp, 15000);
+  net->client().stop();
+  if (err) {
+    outStatus = err;
+    MetricCount(MC_POST_FAIL);
+    return false;
   }
 
-  SerialMon.printf("HTTP STATUS: %d\n", outStatus);
-  SerialMon.println("---- HTTP POST END ----");
+  outStatus = resp.status;
+  outBody = resp.body;
 
-  gsmClient.stop();
+  DLOGI("POST %s -> %d", path, outStatus);
 
+  MetricCount(outStatus == 200 ? MC_POST_OK : MC_POST_FAIL);
   return (outStatus == 200);
 }
 
-static bool sendLatest(uint32_t& seq) {
-  SensorData s;
-
-  if (!SensorsGetLatest(s)) {
-    SerialMon.println("No latest data");
-    return false;
-  }
+static void appendRecordsJson(String& plain, const SampleRec* recs, size_t n);
 
+static String buildLatestJson(const SensorData& s, uint32_t seq) {
   uint32_t rnd = esp_random();
   String nonce = String(rnd, HEX);
 
@@ -189,29 +469,27 @@ static bool sendLatest(uint32_t& seq) {
   plain += "\"device_id\":\"" + deviceId + "\",";
   plain += "\"nonce\":\"" + nonce + "\",";
   plain += "\"seq\":" + String(seq) + ",";
-  plain += "\"records\":[{";
-uint32_t ts = 0;
-
-if (rtc.begin()) {
-  ts = rtc.now().unixtime();
-} else {
-  ts = millis() / 1000;
+  appendRecordsJson(plain, &s.rec, 1);
+  plain += "}";
+  return plain;
 }
 
-plain += "\"ts\":" + String(s.ts) + ",";
- 
-  plain += "\"current_mA\":" + String((int)(s.currentA * 1000)) + ",";
-  plain += "\"power_dW\":" + String((int)(s.powerW)) + ",";
-  plain += "\"temp_cC\":" + String((int)(s.tempC * 100));
+static bool sendLatest(uint32_t& seq) {
+  SensorData s;
 
-  plain += "}]}";
+  if (!SensorsGetLatest(s)) {
+    DLOGW("No latest data");
+    return false;
+  }
+
+  String plain = buildLatestJson(s, SeqTake(seq));
 
   std::vector<uint8_t> blob;
-  if (!aesEncryptBlob(cryptoPass,
+  if (!crypto.encrypt(
         (uint8_t*)plain.c_str(),
         plain.length(),
         blob)) {
-    SerialMon.println("Encrypt fail latest");
+    DLOGE("Encrypt fail latest");
     return false;
   }
 
@@ -219,11 +497,10 @@ plain += "\"ts\":" + String(s.ts) + ",";
   String body;
 
   bool ok = postBlob("/data", blob.data(), blob.size(), status, body);
+  noteBackfill(body);
 
   if (ok && body.indexOf("OK") >= 0) {
-    SerialMon.println("Latest sent OK");
-    seq++;
-    saveSeq(seq);
+    DLOGI("Latest sent OK");
     return true;
   }
 
@@ -235,7 +512,7 @@ plain += "\"ts\":" + String(s.ts) + ",";
 // ===================== REGISTER =====================
 static bool doRegister(uint32_t& seq) {
 
-  SerialMon.println("Registering device...");
+  DLOGI("Registering device...");
 
   // ---- nonce ----
   uint32_t rnd = esp_random();
@@ -245,59 +522,47 @@ static bool doRegister(uint32_t& seq) {
   String plain = "{";
   plain += "\"device_id\":\"" + deviceId + "\",";
   plain += "\"nonce\":\"" + nonce + "\",";
-  plain += "\"seq\":" + String(seq);
+  plain += "\"seq\":" + String(SeqTake(seq));
   plain += "}";
 
-  SerialMon.println("Register JSON:");
-  SerialMon.println(plain);
-
   // ---- encrypt ----
   std::vector<uint8_t> blob;
-  if (!aesEncryptBlob(
-        cryptoPass,
+  if (!crypto.encrypt(
         (uint8_t*)plain.c_str(),
         plain.length(),
         blob)) {
 
-    SerialMon.println("AES encrypt failed");
+    DLOGE("AES encrypt failed");
     return false;
   }
 
-  SerialMon.print("Encrypted size: ");
-  SerialMon.println(blob.size());
-
   int status;
   String body;
 
   bool ok = postBlob("/register", blob.data(), blob.size(), status, body);
 
-  SerialMon.print("Register status=");
-  SerialMon.println(status);
-
-  SerialMon.print("Register body=");
-  SerialMon.println(body);
+  DLOGI("Register status=%d", status);
 
   if (ok && body.indexOf("OK") >= 0) {
-    SerialMon.println("Register success");
-
-    seq++;
-    saveSeq(seq);
+    DLOGI("Register success");
     return true;
   }
 
-  SerialMon.println("Register failed");
+  DLOGW("Register failed");
   return false;
 }
 
 // ===================== SYNC TIME =====================
+// время обычно приходит в ответах на /data и /register (см. noteServerTime),
+// явный запрос — только если давно ничего не отправляли
 static void doSyncTime(uint32_t& seq) {
   String plain = "{";
   plain += "\"device_id\":\"" + deviceId + "\",";
-  plain += "\"seq\":" + String(seq);
+  plain += "\"seq\":" + String(SeqTake(seq));
   plain += "}";
 
   std::vector<uint8_t> blob;
-  if (!aesEncryptBlob(cryptoPass,
+  if (!crypto.encrypt(
         (uint8_t*)plain.c_str(),
         plain.length(),
         blob)) return;
@@ -305,187 +570,647 @@ static void doSyncTime(uint32_t& seq) {
   int status;
   String body;
   postBlob("/sync_time", blob.data(), blob.size(), status, body);
- SerialMon.println("Time response:");
-  SerialMon.println(body);
+}
 
-  // ---- парсим ts ----
-int start = body.indexOf("\"ts\":") + 5;
-int end = body.indexOf(",", start);
-if (end < 0) end = body.indexOf("}", start);
+// ===================== HEALTH =====================
+// Сводка metrics за интервал (счётчики и гистограммы обнуляются, когда сервер принял отчёт)
+static const uint32_t HEALTH_INTERVAL = 15UL * 60UL * 1000UL;
+static uint32_t lastHealthMs = 0;
+static bool healthSent = false;
 
-uint32_t ts = body.substring(start, end).toInt();
- 
- 
+static bool healthDue() {
+  return !healthSent || millis() - lastHealthMs >= HEALTH_INTERVAL;
+}
 
-    SerialMon.print("Setting RTC time: ");
-    SerialMon.println(ts);
+static void sendHealth(uint32_t& seq) {
+  lastHealthMs = millis();
+  healthSent = true;
 
-    rtc.adjust(DateTime(ts));
-  
+  String plain;
+  plain.reserve(768);
+  plain += "{\"device_id\":\"" + deviceId + "\",";
+  plain += "\"nonce\":\"" + String(esp_random(), HEX) + "\",";
+  plain += "\"seq\":" + String(SeqTake(seq)) + ",";
+  plain += "\"health\":" + MetricsHealthJson() + "}";
 
-  seq++;
-  saveSeq(seq);
+  std::vector<uint8_t> blob;
+  if (!encryptPayload(plain, blob)) return;
+
+  int status;
+  String body;
+  if (!postBlob("/health", blob.data(), blob.size(), status, body)) return;
+  noteBackfill(body);
+  // не дошло — те же счётчики уйдут в следующем отчёте вместе с новыми
+  if (body.indexOf("OK") >= 0) MetricsHealthAcked();
 }
 
 // ===================== SEND DATA =====================
-static void sendData(uint32_t& seq) {
-  SerialMon.print("Sending data, seq=");
-  SerialMon.println(seq);
+// окно, ack и снятие с кольца — uplink_window.cpp; здесь сборка пакета и HTTP под ним
+// поля v1 — всегда (старый сервер их и читает); каналы — массивами, если их больше одного
+static void appendRecordsJson(String& plain, const SampleRec* recs, size_t n) {
+  plain += "\"records\":[";
 
-  std::vector<SampleRec> batch;
-  size_t n = RingStoreReadBatch(batch, 1); // маленький пакет для SIM900
-  if (n == 0) {
-    SerialMon.println("No data in ring buffer");
-    return;
+  for (size_t i = 0; i < n; i++) {
+    const SampleRec& r = recs[i];
+    if (i) plain += ",";
+
+    plain += "{";
+    plain += "\"ts\":" + String(r.ts) + ",";
+    plain += "\"current_mA\":" + String(r.current_mA) + ",";
+    plain += "\"power_dW\":" + String(r.power_dW) + ",";
+    plain += "\"temp_cC\":" + String(r.temp_cC);
+    if (r.nCurrent > 1) {
+      plain += ",\"ch_cA\":[";
+      for (uint8_t k = 0; k < r.nCurrent; k++) {
+        if (k) plain += ",";
+        plain += String(r.ch_cA[k]);
+      }
+      plain += "]";
+    }
+    if (r.nTemp > 1) {
+      plain += ",\"t_cC\":[" + String(r.temp_cC);
+      for (uint8_t k = 1; k < r.nTemp; k++) plain += "," + String(r.tempX_cC[k - 1]);
+      plain += "]";
+    }
+    plain += "}";
   }
 
+  plain += "]";
+}
+
+static void appendRecordsJson(String& plain, const std::vector<SampleRec>& batch) {
+  appendRecordsJson(plain, batch.data(), batch.size());
+}
+
+static String buildDataJson(const std::vector<SampleRec>& batch, uint32_t seq, uint32_t prev) {
   // ---- nonce ----
   uint32_t rnd = esp_random();
   String nonce = String(rnd, HEX);
 
-  // ---- JSON ----
-  String plain = "{";
+  String plain;
+  plain.reserve(96 + batch.size() * 112);
+  plain += "{";
   plain += "\"device_id\":\"" + deviceId + "\",";
   plain += "\"nonce\":\"" + nonce + "\",";
   plain += "\"seq\":" + String(seq) + ",";
-  plain += "\"records\":[";
+  plain += "\"prev\":" + String(prev) + ",";
+  appendRecordsJson(plain, batch);
+  plain += "}";
+  return plain;
+}
 
-  for (size_t i = 0; i < batch.size(); i++) {
-    if (i) plain += ",";
+static bool buildDataBlob(const std::vector<SampleRec>& batch, uint32_t seq, uint32_t prev,
+                          std::vector<uint8_t>& blob) {
+  return encryptPayload(buildDataJson(batch, seq, prev), blob);
+}
 
-    plain += "{";
-    plain += "\"ts\":" + String(batch[i].ts) + ",";
-    plain += "\"current_mA\":" + String(batch[i].current_mA) + ",";
-    plain += "\"power_dW\":" + String(batch[i].power_dW) + ",";
-    plain += "\"temp_cC\":" + String(batch[i].temp_cC);
-    plain += "}";
-  }
+static bool winOpen() {
+  return httpOpen() == 0;
+}
 
-  plain += "]}";
+static bool winSend(const uint8_t* blob, size_t len) {
+  return httpSendRequest("/data", blob, len, true);
+}
 
-  SerialMon.println("JSON payload:");
-  SerialMon.println(plain);
+static bool winRecv(HttpResp& resp) {
+  return httpReadResponse(resp, 15000) == 0;
+}
 
-  // ---- encrypt ----
-  std::vector<uint8_t> blob;
-  if (!aesEncryptBlob(
-        cryptoPass,
-        (uint8_t*)plain.c_str(),
-        plain.length(),
-        blob)) {
-    SerialMon.println("AES encrypt failed");
-    return;
+static void winClose() {
+  net->client().stop();
+}
+
+static const WindowOps windowOps = {
+  buildDataBlob,
+  SeqTake,
+  winOpen,
+  winSend,
+  winRecv,
+  winClose,
+  noteBackfill,
+};
+
+static SendResult sendData(uint32_t& seq, uint32_t& lastAck) {
+  switch (UplinkWindowSend(seq, lastAck)) {
+    case WIN_OK:    return SEND_OK;
+    case WIN_EMPTY: return SEND_EMPTY;
+    case WIN_NOTREG:
+      DLOGW("Device not registered -> registering");
+      return doRegister(seq) ? SEND_OK : SEND_FAIL;
+    default:        return SEND_FAIL;
   }
+}
+
+// ===================== BACKFILL =====================
+// Сервер может попросить дослать архив за период — например, после потери своей БД
+// или если кольцо переполнилось, пока не было связи. Просьба приходит полями
+// bf_from/bf_to в ответах /data и /health; устройство шлёт записи архива за период
+// в POST /backfill кусками вне цепочки seq (сервер отсеивает дубли по ts), последний
+// кусок — с "done":true. Досылка идёт после бэклога кольца: свежие данные важнее.
+// Просьба живёт в RAM: после перезагрузки сервер повторит её в следующем ответе.
+static const size_t BACKFILL_BATCH = 32;
+
+struct Backfill {
+  bool     active;
+  uint32_t from, to;
+  uint32_t pos;       // позиция в архиве (см. HistoryRead)
+};
+static Backfill bf{};
+
+static void noteBackfill(const String& body) {
+  uint32_t from, to;
+  if (!JsonGetUInt(body, "bf_from", from) || !JsonGetUInt(body, "bf_to", to) || from > to) return;
+  if (bf.active && bf.from == from && bf.to == to) return;   // уже досылаем
+  bf = Backfill{ true, from, to, 0 };
+  DLOGI("Backfill requested: %u..%u", (unsigned)from, (unsigned)to);
+}
 
-  SerialMon.print("Encrypted size: ");
-  SerialMon.println(blob.size());
+// один кусок; SEND_EMPTY — просьбы нет или период дослан
+static SendResult sendBackfill() {
+  if (!bf.active) return SEND_EMPTY;
+
+  std::vector<SampleRec> batch;
+  uint32_t pos = bf.pos;
+  bool more = HistoryRead(pos, bf.from, bf.to, batch, BACKFILL_BATCH);
+  // архив растёт и во время досылки, но новое за период уже не попадёт
+  bool done = !more || batch.empty();
+
+  String plain;
+  plain.reserve(128 + batch.size() * 112);
+  plain += "{\"device_id\":\"" + deviceId + "\",";
+  plain += "\"nonce\":\"" + String(esp_random(), HEX) + "\",";
+  plain += "\"from\":" + String(bf.from) + ",";
+  plain += "\"to\":" + String(bf.to) + ",";
+  appendRecordsJson(plain, batch);
+  plain += ",\"done\":";
+  plain += done ? "true}" : "false}";
+
+  std::vector<uint8_t> blob;
+  if (!encryptPayload(plain, blob)) return SEND_FAIL;
 
   int status;
   String body;
+  if (!postBlob("/backfill", blob.data(), blob.size(), status, body)) return SEND_FAIL;
 
-  bool ok = postBlob("/data", blob.data(), blob.size(), status, body);
+  DLOGI("Backfill -> %u recs%s", (unsigned)batch.size(), done ? ", done" : "");
+  bf.pos = pos;
+  if (done) bf.active = false;
+  MetricCount(MC_BACKFILL_RECS, batch.size());
+  return done ? SEND_EMPTY : SEND_OK;
+}
 
-  SerialMon.print("Server status=");
-  SerialMon.println(status);
-  SerialMon.print("Server body=");
-  SerialMon.println(body);
 
-  // ---- success ----
-  if (ok && body.indexOf("OK") >= 0) {
-    SerialMon.println("Data accepted, dropping from ring");
-    RingStoreDrop(batch.size());
+// ===================== DATAGRAM =====================
+// Одна датаграмма на пакет вместо TCP-рукопожатия + HTTP + закрытия (кадры, повторы
+// и ожидание ack — datagram.cpp). Буфер повторов — само кольцо (запись удаляется
+// только после ack). При отказе UDP — обычный HTTP.
+static Transport* dgNet = nullptr;  // на чём открыт UDP-сокет
+static int dgEp = -1;
+static DgHoldoff dgHold{};
 
-    seq++;
-    saveSeq(seq);
-  }
-  // ---- not registered ----
-  else if (body.indexOf("notreg") >= 0) {
-    SerialMon.println("Device not registered -> registering");
+static bool dgSend(const uint8_t* data, size_t len) {
+  return dgNet->udpSend(data, len);
+}
 
-    if (doRegister(seq)) {
-      SerialMon.println("Register OK, retry send");
-      sendData(seq);
-    }
-  }
+static int dgRecv(uint8_t* buf, size_t maxLen) {
+  return dgNet->udpRecv(buf, maxLen);
 }
 
+static bool dgDecrypt(const uint8_t* blob, size_t len, std::vector<uint8_t>& plain) {
+  return crypto.decrypt(blob, len, plain);
+}
 
-// ===================== TASK =====================
-static void gsmTask(void* pv) {
-  (void)pv;
-uint32_t lastTimeSync = 0;
-const uint32_t TIME_SYNC_INTERVAL = 50000;//1000*60*15; // 1 час
-  const uint32_t SEND_INTERVAL = 30000;
-  uint32_t lastSend = 0;
+static void dgPause() {
+  vTaskDelay(pdMS_TO_TICKS(20));
+}
 
-  uint32_t seq = loadSeq();
+static const DgOps dgOps = { dgSend, dgRecv, dgDecrypt, dgPause };
 
-  while (true) {
-    if (!modem.isGprsConnected()) {
-      SerialMon.println("GPRS disconnected, reconnect...");
-      modem.gprsConnect(apn, guser, gpass);
-      vTaskDelay(pdMS_TO_TICKS(5000));
-      continue;
-    }
+static bool datagramEnabled() {
+  return cfgUdpPort && DatagramAllowed(dgHold, millis());
+}
 
-    if (millis() - lastSend >= SEND_INTERVAL) {
-      lastSend = millis();
+static void datagramClose() {
+  if (dgNet) dgNet->udpClose();
+  dgNet = nullptr;
+}
 
-      loadUplinkCfg();
+static bool datagramOpen() {
+  Transport* t = TransportSelect();
+  int ep = EndpointsPick();
+  if (!t || ep < 0) return false;
+  if (t == dgNet && ep == dgEp) return true;
+
+  datagramClose();
+  net = t;
+  String ip;
+  if (!EndpointsResolve(ep, netResolve, ip)) return false;
+  if (!t->udpOpen(ip, cfgUdpPort)) return false;
+
+  dgNet = t;
+  dgEp = ep;
+  DLOGI("UDP [%s] ep=%d port=%u", t->name(), ep, cfgUdpPort);
+  return true;
+}
 
-      // 1) синк времени (редко, но пусть тут)
-     if (millis() - lastTimeSync > TIME_SYNC_INTERVAL) {
-        doSyncTime(seq);
-        lastTimeSync = millis();
-    }
-size_t backlog = RingStoreCountApprox();
+static void datagramFailed() {
+  datagramClose();
+  EndpointsReport(dgEp, false);
+  if (DatagramFailed(dgHold, millis())) DLOGW("UDP uplink unreachable, HTTP only for now");
+}
 
-// 1. если есть свежие данные → отправляем их
-bool sentLatest = sendLatest(seq);
+static bool datagramExchange(uint32_t seq, const String& plain) {
+  if (!datagramOpen()) {
+    datagramFailed();
+    return false;
+  }
 
-// 2. если backlog большой → НЕ лезем сразу в старые
-if (backlog > 10) {
-  SerialMon.println("Backlog large → skip old for now");
-  return;
+  std::vector<uint8_t> blob;
+  if (!encryptPayload(plain, blob)) return false;
+
+  std::vector<uint8_t> frame;
+  if (!DatagramFrame(frame, deviceId, seq, blob)) return false;
+
+  DgResult r;
+  int v = DatagramExchange(dgOps, frame, seq, r);
+  if (v < 0) {
+    DLOGW("UDP seq=%u rejected", (unsigned)seq);
+    DatagramReached(dgHold);
+    return false;
+  }
+  if (v == 0) {
+    MetricCount(MC_UDP_FAIL);
+    datagramFailed();
+    return false;
+  }
+
+  uint32_t ts = 0;
+  JsonGetUInt(r.body, "ts", ts);
+  TimeSyncSample(r.sentMs, r.sentMs + r.rttMs, ts);
+  EndpointsReport(dgEp, true, r.rttMs);
+  TransportReport(dgNet, frame.size(), r.sendUs);
+  DatagramReached(dgHold);
+  MetricCount(MC_UDP_OK);
+  MetricCount(MC_BYTES_UP, frame.size());
+  DLOGI("UDP seq=%u acked in %u ms", (unsigned)seq, (unsigned)r.rttMs);
+  return true;
 }
 
-// 3. если backlog маленький → отправляем старые
-sendData(seq);
-    }
+static bool sendLatestDatagram(uint32_t& seq) {
+  SensorData s;
+  if (!SensorsGetLatest(s)) return false;
+
+  uint32_t my = SeqTake(seq);
+  return datagramExchange(my, buildLatestJson(s, my));
+}
 
-    vTaskDelay(pdMS_TO_TICKS(500));
+static SendResult sendDataDatagram(uint32_t& seq, uint32_t& lastAck) {
+  std::vector<SampleRec> batch;
+  RingStoreLock();
+  uint32_t pos = RingStoreTail();
+  size_t slots = RingStorePeek(0, batch, DATA_BATCH_MAX);
+  RingStoreUnlock();
+  if (slots == 0) return SEND_EMPTY;
+  if (batch.empty()) {
+    UplinkWindowDrop(pos, slots);  // только битые записи
+    return SEND_OK;
   }
+
+  uint32_t my = SeqTake(seq);
+  if (!datagramExchange(my, buildDataJson(batch, my, lastAck))) return SEND_FAIL;
+  UplinkWindowDrop(pos, slots);
+  lastAck = my;
+  return SEND_OK;
 }
 
-// ===================== API =====================
-void GsmInit() {
-  loadUplinkCfg();
-  deviceId = makeDeviceId();
+// ===================== BAUD =====================
+// Поиск и смена скорости — modem_baud.cpp, здесь только UART и AT через TinyGSM
+#ifndef TINY_GSM_BAUD
+#define TINY_GSM_BAUD 115200
+#endif
+#ifndef TINY_GSM_RX_PIN
+#define TINY_GSM_RX_PIN 16
+#endif
+#ifndef TINY_GSM_TX_PIN
+#define TINY_GSM_TX_PIN 17
+#endif
+// аппаратный RTS/CTS (нужны провода к модему): -D GSM_HW_FLOW=1
+#ifndef GSM_HW_FLOW
+#define GSM_HW_FLOW 0
+#endif
+#ifndef GSM_CTS_PIN
+#define GSM_CTS_PIN 18
+#endif
+#ifndef GSM_RTS_PIN
+#define GSM_RTS_PIN 19
+#endif
+#ifndef GSM_DTR_PIN
+#define GSM_DTR_PIN -1    // не выведен: сон модема AT+CSCLK=2
+#endif
+
+static const size_t AT_RX_BUFFER = 2048;  // пакет бэклога целиком, без переполнений на 115200
+static const size_t AT_TX_BUFFER = 1024;
+
+static uint32_t modemBaud = 0;
+
+static void uartBegin(uint32_t baud) {
+  SerialAT.end();
+  SerialAT.setRxBufferSize(AT_RX_BUFFER);  // только до begin()
+  SerialAT.setTxBufferSize(AT_TX_BUFFER);
+  SerialAT.begin(baud, SERIAL_8N1, TINY_GSM_RX_PIN, TINY_GSM_TX_PIN);
+#if GSM_HW_FLOW
+  SerialAT.setPins(-1, -1, GSM_CTS_PIN, GSM_RTS_PIN);
+  SerialAT.setHwFlowCtrlMode(UART_HW_FLOWCTRL_CTS_RTS, 64);
+#endif
+  delay(50);
+}
+
+static bool atTest(uint32_t timeoutMs) {
+  return modem.testAT(timeoutMs);
+}
 
-  SerialAT.begin(9600, SERIAL_8N1, 16, 17);
-  delay(300);
+static bool atCommand(const char* cmd, uint32_t timeoutMs) {
+  modem.sendAT(cmd);
+  return modem.waitResponse(timeoutMs) == 1;
+}
+
+static const BaudOps baudOps = { uartBegin, atTest, atCommand };
+
+static void setupFlowControl() {
+#if GSM_HW_FLOW
+  modem.sendAT(GF("+IFC=2,2"));
+  if (modem.waitResponse(1000) != 1) DLOGW("AT+IFC failed");
+#endif
+}
 
-  SerialMon.println("Restart modem");
+// поднять модем: скорость AT, рестарт, инфо. Сеть и GPRS — в состоянии CONNECT
+static bool modemBringUp() {
+#if GSM_DTR_PIN >= 0
+  pinMode(GSM_DTR_PIN, OUTPUT);
+  digitalWrite(GSM_DTR_PIN, LOW);  // низкий DTR — модем не спит
+#endif
+  modemBaud = ModemBaudNegotiate(baudOps, TINY_GSM_BAUD);
+  if (!modemBaud) return false;
+
+  DLOGI("Restart modem");
   modem.restart();
+  if (!ModemLinkVerify(baudOps, 2)) {
+    // после рестарта модем мог вернуться в автобод
+    modemBaud = ModemBaudNegotiate(baudOps, TINY_GSM_BAUD);
+    if (!modemBaud) return false;
+  }
+  setupFlowControl();
+  DLOGI("AT link: %u baud%s", (unsigned)modemBaud, GSM_HW_FLOW ? " RTS/CTS" : "");
 
   SerialMon.print("Modem: ");
   SerialMon.println(modem.getModemInfo());
+  return true;
+}
 
-  SerialMon.print("Waiting for network...");
-  modem.waitForNetwork(60000);
+// ===================== MODEM SLEEP =====================
+// Между пакетами GPRS отключён (нет тарифицируемой сессии, радио в простое), модем
+// в спящем режиме SIM900: регистрация в сети сохраняется, входящие URC будят сами.
+// Без DTR — AT+CSCLK=2: засыпает после ~5 с тишины на UART, будится любым символом
+// (первые теряются). С выведенным DTR (-D GSM_DTR_PIN=n) — AT+CSCLK=1, сон по уровню DTR.
+static bool modemResting = false;
+static uint32_t gprsUpMs = 0;      // начало сессии GPRS, 0 — не поднят
+
+// прошедшие секунды сессии — в счётчик; сессия идёт дальше, остаток не теряется.
+// При постоянном GPRS (не пакетный режим) вызывается перед каждым отчётом о здоровье
+static void countGprsTime() {
+  if (!gprsUpMs) return;
+  uint32_t s = (millis() - gprsUpMs) / 1000;
+  MetricCount(MC_GPRS_S, s);
+  gprsUpMs += s * 1000;
+}
 
-  SerialMon.print("Connecting GPRS...");
-  modem.gprsConnect(apn, guser, gpass);
+static void modemRest() {
+  if (!modemReady() || modemResting) return;
+
+  countGprsTime();
+  gprsUpMs = 0;
+  modem.gprsDisconnect();
+  xEventGroupClearBits(gsmEvents, GSM_EV_GPRS_UP);
+
+#if GSM_DTR_PIN >= 0
+  modem.sendAT(GF("+CSCLK=1"));
+#else
+  modem.sendAT(GF("+CSCLK=2"));
+#endif
+  if (modem.waitResponse(1000) != 1) {
+    DLOGW("AT+CSCLK failed, modem stays awake");
+    return;
+  }
+#if GSM_DTR_PIN >= 0
+  digitalWrite(GSM_DTR_PIN, HIGH);
+#endif
+  modemResting = true;
+  DLOGI("Modem sleeping, GPRS detached");
+}
+
+// false — модем не ответил: поднимать заново
+static bool modemWake() {
+  if (!modemResting) return true;
+  modemResting = false;
+
+#if GSM_DTR_PIN >= 0
+  digitalWrite(GSM_DTR_PIN, LOW);
+  delay(60);
+#endif
+  // testAT повторяет AT до ответа — первые символы уходят на пробуждение
+  bool ok = modem.testAT(2000);
+  if (ok) {
+    modem.sendAT(GF("+CSCLK=0"));
+    ok = modem.waitResponse(1000) == 1;
+  }
+  if (!ok) {
+    DLOGW("Modem did not wake");
+    xEventGroupClearBits(gsmEvents, GSM_EV_MODEM_READY);
+  }
+  return ok;
+}
+
+// ===================== TASK =====================
+// Автомат (состояния, сроки, backoff, расписание сеансов) — в uplink_fsm.cpp,
+// здесь — его действия на модеме, транспортах и сервере
+static QueueHandle_t cmdQueue = nullptr;
+
+static void wakeUplink() {
+  if (!cmdQueue) return;
+  uint8_t cmd = UL_CMD_WAKE;
+  xQueueSend(cmdQueue, &cmd, 0);
+}
+
+// ждём команду не дольше waitMs (по millis, сон планировщика этот срок соблюдает);
+// UL_CMD_NONE — срок вышел
+static UplinkCmd waitCommand(uint32_t waitMs) {
+  PowerIdleUntil(PWR_UPLINK, millis() + waitMs);
+  uint8_t cmd = UL_CMD_NONE;
+  bool got = xQueueReceive(cmdQueue, &cmd, pdMS_TO_TICKS(waitMs)) == pdTRUE;
+  PowerBusy(PWR_UPLINK);
+  if (!got || cmd == UL_CMD_WAKE) return UL_CMD_NONE;
+  return (UplinkCmd)cmd;
+}
+
+// первая успешная выгрузка после загрузки — для замера фаз
+static void markUploaded() {
+  if (xEventGroupGetBits(gsmEvents) & GSM_EV_FIRST_UPLOAD) return;
+  xEventGroupSetBits(gsmEvents, GSM_EV_FIRST_UPLOAD);
+  BootMark("first upload");
+}
+
+static bool opModemInit() {
+  transportsBegin();
+  if (!modemBringUp()) return false;
+  xEventGroupSetBits(gsmEvents, GSM_EV_MODEM_READY);
+  BootMark("modem");
+  return true;
+}
+
+static bool opLinkUp() {
+  applyUplinkCfg();   // без канала сессии нет, а новый ssid может его и дать
+  return TransportSelect() != nullptr;
+}
+
+static bool opSessionBegin() {
+  ethTryBegin();
+  Transport* t = TransportSelect();
+  if (!t) return false;
+
+  if (t == &gsmTransport && !(xEventGroupGetBits(gsmEvents) & GSM_EV_GPRS_UP)) {
+    xEventGroupSetBits(gsmEvents, GSM_EV_GPRS_UP);
+    BootMark("gprs");
+  }
+  if (t == &gsmTransport && !gprsUpMs) gprsUpMs = millis();
+  // всё, что лежит в RTC-буфере хранения, — в кольцо до чтения бэклога
+  if (!PipelineFlush(2000)) DLOGW("pipeline flush timeout");
+  applyUplinkCfg();
+  return true;
+}
+
+static void opReconnect() {
+  xEventGroupClearBits(gsmEvents, GSM_EV_GPRS_UP);
+  countGprsTime();   // сессия оборвалась сама
+  gprsUpMs = 0;
+  DLOGW("GPRS disconnected, reconnect...");
+  if (!modem.isNetworkConnected()) {
+    modem.waitForNetwork(15000);
+    return;
+  }
+  if (!modem.gprsConnect(apn, guser, gpass)) {
+    vTaskDelay(pdMS_TO_TICKS(2000));
+  }
+}
+
+static void opSync(Uplink& u) {
+  if (TimeSyncDue()) {
+    doSyncTime(u.seq);
+  }
+  if (healthDue() && !UplinkStateExpired(u)) {
+    countGprsTime();
+    sendHealth(u.seq);
+  }
+}
+
+static bool opSendLatest(Uplink& u) {
+  bool ok = datagramEnabled() && sendLatestDatagram(u.seq);
+  if (!ok && !UplinkStateExpired(u)) ok = sendLatest(u.seq);
+  return ok;
+}
+
+static SendResult opSendData(Uplink& u) {
+  SendResult r = datagramEnabled() ? sendDataDatagram(u.seq, u.lastAck) : SEND_FAIL;
+  if (r == SEND_FAIL) r = sendData(u.seq, u.lastAck);
+  return r;
+}
+
+static void opModemWake() {
+  modemWake();
+}
+
+static uint32_t opRandom() {
+  return esp_random();
+}
+
+static const UplinkOps uplinkOps = {
+  opModemInit,
+  opLinkUp,
+  opSessionBegin,
+  modemReady,
+  opReconnect,
+  opSync,
+  opSendLatest,
+  opSendData,
+  sendBackfill,
+  modemRest,
+  opModemWake,
+  waitCommand,
+  markUploaded,
+  opRandom,
+};
+
+static void gsmTask(void* pv) {
+  (void)pv;
+
+  MetricsTrackTask(xTaskGetCurrentTaskHandle(), "uplink");
+  PowerRegister(PWR_UPLINK, wakeUplink);
+
+  Uplink u;
+  UplinkFsmInit(u, uplinkOps, SeqLeaseBegin());
+
+  while (true) {
+    UplinkFsmStep(u);
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
+
+// ===================== API =====================
+void GsmInit() {
+  applyUplinkCfg();
+  ConfigSubscribe(onConfigChanged, CFG_CH_SERVER | CFG_CH_CRYPTO | CFG_CH_WIFI);
+  deviceId = makeDeviceId();
+  gsmEvents = xEventGroupCreate();
+  UplinkWindowInit(windowOps);
 }
 
 void GsmStartTask() {
+  cmdQueue = xQueueCreate(4, sizeof(uint8_t));
+
   xTaskCreatePinnedToCore(
     gsmTask,
     "gsmTask",
     8192,
     nullptr,
-    2,
+    PRIO_UPLINK,
     nullptr,
-    1
+    CORE_IO
   );
 }
+
+void GsmRequestSend() {
+  if (!cmdQueue) return;
+  uint8_t cmd = UL_CMD_SEND_NOW;
+  xQueueSend(cmdQueue, &cmd, 0);
+}
+
+void GsmNotifyStored(size_t n, bool urgent) {
+  bool full = UplinkFsmNoteStored(n);
+  if (!cmdQueue) return;
+  // тревога — сразу, иначе только на пороге пакета
+  if (urgent || full) {
+    uint8_t cmd = urgent ? UL_CMD_SEND_NOW : UL_CMD_DATA;
+    xQueueSend(cmdQueue, &cmd, 0);
+  }
+}
+
+EventGroupHandle_t GsmEvents() {
+  return gsmEvents;
+}
+
+#if PERF_BENCH
+// после GsmInit(): ключи и deviceId уже есть, модем не нужен
+size_t GsmBenchPayload(const std::vector<SampleRec>& batch, std::vector<uint8_t>& blob) {
+  String plain = buildDataJson(batch, 1, 0);
+  return encryptPayload(plain, blob) ? plain.length() : 0;
+}
+#endif
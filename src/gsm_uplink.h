@@ -1,8 +1,29 @@
 #pragma once
 #include <Arduino.h>
+#include <freertos/event_groups.h>
 
-// инициализация модема + gprs
+// биты готовности аплинка (GsmEvents())
+static const EventBits_t GSM_EV_MODEM_READY  = (1 << 0); // AT-связь поднята, модем перезапущен
+static const EventBits_t GSM_EV_GPRS_UP      = (1 << 1); // GPRS подключён
+static const EventBits_t GSM_EV_FIRST_UPLOAD = (1 << 2); // первая успешная отправка после загрузки
+
+// конфиг + device id, без обращения к модему (не блокирует)
 void GsmInit();
 
-// запуск FreeRTOS-задачи отправки
+// запуск FreeRTOS-задачи отправки; модем поднимается асинхронно внутри неё
 void GsmStartTask();
+
+// попросить задачу отправить данные немедленно (из любой задачи)
+void GsmRequestSend();
+
+// из стадии хранения: n записей легли в кольцо (полный пакет или тревога будят задачу раньше интервала)
+void GsmNotifyStored(size_t n, bool urgent);
+
+EventGroupHandle_t GsmEvents();
+
+#if PERF_BENCH
+#include <vector>
+struct SampleRec;
+// путь пакета бэклога без сети: JSON (buildDataJson) -> LZ -> AES
+size_t GsmBenchPayload(const std::vector<SampleRec>& batch, std::vector<uint8_t>& blob);
+#endif
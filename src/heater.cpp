@@ -0,0 +1,128 @@
+#include "heater.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "pipeline.h"
+#include "power.h"
+#include "config_store.h"
+#include "metrics.h"
+#include "dlog.h"
+
+static const int HEATER_PIN = 25;
+
+// последняя температура от sensorsTask; fresh — ещё не разобрана
+struct TempSlot {
+  float    tempC;
+  uint32_t t0Us;
+  uint32_t ms;
+  bool     fresh;
+};
+static portMUX_TYPE slotMux = portMUX_INITIALIZER_UNLOCKED;
+static TempSlot slot{};
+
+static TaskHandle_t heaterTaskHandle = nullptr;
+static volatile bool heaterOn = false;
+static uint32_t switchedMs = 0;
+static volatile uint32_t minOnMs = 0;
+static volatile uint32_t minOffMs = 0;
+
+static void wakeHeater() {
+  if (heaterTaskHandle) xTaskNotifyGive(heaterTaskHandle);
+}
+
+static void onHeaterCfg(const Config& c, uint32_t, void*) {
+  minOnMs = c.heatMinOnS * 1000UL;
+  minOffMs = c.heatMinOffS * 1000UL;
+  wakeHeater();   // отложенное переключение могло стать разрешённым
+}
+
+static void setOutput(bool on) {
+  digitalWrite(HEATER_PIN, on ? HIGH : LOW);
+  heaterOn = on;
+  switchedMs = millis();
+}
+
+// ===================== CONTROL =====================
+static void heaterTask(void* pv) {
+  (void)pv;
+  MetricsTrackTask(xTaskGetCurrentTaskHandle(), "heater");
+  PowerRegister(PWR_HEATER, wakeHeater);
+
+  float tempC = -127.0;       // до первого замера — как отказ датчика
+  uint32_t tempMs = millis();
+
+  while (true) {
+    portENTER_CRITICAL(&slotMux);
+    TempSlot s = slot;
+    slot.fresh = false;
+    portEXIT_CRITICAL(&slotMux);
+
+    uint32_t now = millis();
+    if (s.fresh) {
+      tempC = s.tempC;
+      tempMs = s.ms;
+    }
+
+    bool stale = now - tempMs >= HEATER_STALE_MS;
+    bool fault = stale || tempC == -127.0;
+    bool want = !fault && (heaterOn ? tempC < HEATER_T_OFF : tempC <= HEATER_T_ON);
+
+    // следующий срок: молчание датчика или отложенное переключение
+    bool timed = !stale;
+    uint32_t due = tempMs + HEATER_STALE_MS;
+
+    if (want != heaterOn) {
+      uint32_t hold = heaterOn ? minOnMs : minOffMs;
+      if (fault) {
+        setOutput(false);
+        MetricCount(MC_HEATER_FAILSAFE);
+        DLOGW("heater: fail-safe OFF (%s)", stale ? "no data" : "sensor lost");
+      } else if (now - switchedMs >= hold) {
+        setOutput(want);
+        DLOGI("heater %s at T=%.2f", want ? "ON" : "OFF", tempC);
+      } else {
+        uint32_t at = switchedMs + hold;
+        if ((int32_t)(at - due) < 0) due = at;
+      }
+    }
+    // от готовности температуры до решения (и выхода реле, если переключали)
+    if (s.fresh) MetricObserveUs(MH_HEATER_REACT, micros() - s.t0Us);
+
+    int32_t left = (int32_t)(due - millis());
+    if (timed && left <= 0) continue;
+    if (timed) {
+      PowerIdleUntil(PWR_HEATER, due);
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(left));
+    } else {
+      PowerIdle(PWR_HEATER);
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    PowerBusy(PWR_HEATER);
+  }
+}
+
+// ===================== API =====================
+void HeaterBegin() {
+  pinMode(HEATER_PIN, OUTPUT);
+  setOutput(false);
+
+  ConfigSnapshot c = ConfigGet();
+  onHeaterCfg(*c, CFG_CH_HEATER, nullptr);
+  ConfigSubscribe(onHeaterCfg, CFG_CH_HEATER);
+}
+
+bool HeaterStartTask() {
+  if (heaterTaskHandle) return true;
+  return xTaskCreatePinnedToCore(heaterTask, "heaterTask", 3072, nullptr, PRIO_HEATER, &heaterTaskHandle, CORE_ACQ) == pdPASS;
+}
+
+void HeaterUpdate(float tempC, uint32_t t0Us) {
+  uint32_t now = millis();
+  portENTER_CRITICAL(&slotMux);
+  slot = TempSlot{ tempC, t0Us, now, true };
+  portEXIT_CRITICAL(&slotMux);
+  wakeHeater();
+}
+
+bool HeaterOn() {
+  return heaterOn;
+}
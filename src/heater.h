@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+
+// Термостат нагревателя — отдельная короткая задача с высшим приоритетом на ядре
+// сбора. Решение принимается сразу по приходу температуры (HeaterUpdate из
+// sensorsTask), а не в общем цикле замера, и не ждёт ни тока, ни записи, ни аплинка.
+//
+// Гистерезис: включить при t <= HEATER_T_ON, выключить при t >= HEATER_T_OFF.
+// Минимальные времена вкл/выкл (config) берегут реле; отложенное ими переключение
+// выполняется в срок, без ожидания следующего замера.
+// Отказ датчика (-127) или молчание дольше HEATER_STALE_MS — выключить сразу,
+// минимальное время включения здесь не действует.
+
+static const float    HEATER_T_ON     = -5.0;
+static const float    HEATER_T_OFF    = 0.0;
+static const uint32_t HEATER_STALE_MS = 30000;   // 3 окна сбора без температуры
+
+void HeaterBegin();       // выход в безопасное состояние (выкл) — как можно раньше
+bool HeaterStartTask();
+
+// свежая температура датчика 0; t0Us — micros() готовности замера (для задержки реакции)
+void HeaterUpdate(float tempC, uint32_t t0Us);
+bool HeaterOn();
@@ -0,0 +1,357 @@
+#include "history.h"
+#include <FS.h>
+#include <LittleFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "dlog.h"
+
+using namespace fs;
+
+static const uint32_t IDX_MAGIC   = 0x48495354; // 'HIST'
+static const uint16_t IDX_VERSION = 2;   // 2 — многоканальные SampleRec
+
+#pragma pack(push, 1)
+// запись архива: замер + Δt от предыдущего (для энергии/часов без соседей) + метка блока
+struct HistRec {
+  SampleRec r;
+  uint16_t  dtS;
+  uint16_t  tag;   // (номер блока + 1) & 0xFFFF: отличает записи текущего круга от старых
+};
+
+struct IdxHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t blocks;
+  uint32_t openBlk;  // абсолютный номер открытого блока
+};
+
+struct BlockSum {
+  uint32_t blk;      // абсолютный номер блока + 1, 0 — пусто
+  uint32_t tsFirst;
+  uint32_t tsLast;
+  uint16_t count;
+  int16_t  tempMin_cC;
+  int16_t  tempMax_cC;
+  uint16_t pad;
+  int32_t  currentMin_mA;
+  int32_t  currentMax_mA;
+  int32_t  powerMin_dW;
+  int32_t  powerMax_dW;
+  uint32_t heaterS;
+  uint64_t energy_dWs;
+};
+#pragma pack(pop)
+
+static String dataPath;
+static String idxPath;
+static uint16_t nBlocks = 0;
+static BlockSum* sums = nullptr;     // по слоту блока (abs % nBlocks)
+static uint32_t openBlk = 0;
+static uint32_t prevTs = 0;          // ts последней записи архива (для Δt)
+static SemaphoreHandle_t mtx = nullptr;
+static HistRec blockBuf[HIST_BLOCK_RECS];
+
+static uint16_t tagOf(uint32_t blk) { return (uint16_t)(blk + 1); }
+static uint32_t slotOf(uint32_t blk) { return blk % nBlocks; }
+static uint32_t dataOffset(uint32_t blk, uint32_t i) {
+  return (slotOf(blk) * HIST_BLOCK_RECS + i) * sizeof(HistRec);
+}
+static uint32_t oldestBlk() { return openBlk >= nBlocks ? openBlk - nBlocks + 1 : 0; }
+
+static bool blockValid(uint32_t blk) {
+  const BlockSum& s = sums[slotOf(blk)];
+  return s.blk == blk + 1 && s.count > 0;
+}
+
+// ===================== SUMMARY =====================
+static void sumReset(BlockSum& s, uint32_t blk) {
+  s = BlockSum{};
+  s.blk = blk + 1;
+}
+
+static void sumAdd(BlockSum& s, const HistRec& h) {
+  const SampleRec& r = h.r;
+  if (!s.count) {
+    s.tsFirst = r.ts;
+    s.currentMin_mA = s.currentMax_mA = r.current_mA;
+    s.powerMin_dW = s.powerMax_dW = r.power_dW;
+    s.tempMin_cC = s.tempMax_cC = r.temp_cC;
+  }
+  s.tsLast = r.ts;
+  s.count++;
+  s.currentMin_mA = min(s.currentMin_mA, r.current_mA);
+  s.currentMax_mA = max(s.currentMax_mA, r.current_mA);
+  s.powerMin_dW = min(s.powerMin_dW, r.power_dW);
+  s.powerMax_dW = max(s.powerMax_dW, r.power_dW);
+  s.tempMin_cC = min(s.tempMin_cC, r.temp_cC);
+  s.tempMax_cC = max(s.tempMax_cC, r.temp_cC);
+  s.energy_dWs += (uint64_t)max(r.power_dW, (int32_t)0) * h.dtS;
+  if (r.flags & 1) s.heaterS += h.dtS;
+}
+
+static void aggMerge(HistAgg& a, const BlockSum& s) {
+  if (!s.count) return;
+  if (!a.count) {
+    a.tsFirst = s.tsFirst;
+    a.currentMin_mA = s.currentMin_mA; a.currentMax_mA = s.currentMax_mA;
+    a.powerMin_dW = s.powerMin_dW;     a.powerMax_dW = s.powerMax_dW;
+    a.tempMin_cC = s.tempMin_cC;       a.tempMax_cC = s.tempMax_cC;
+  }
+  a.tsFirst = min(a.tsFirst, s.tsFirst);
+  a.tsLast = max(a.tsLast, s.tsLast);
+  a.count += s.count;
+  a.currentMin_mA = min(a.currentMin_mA, s.currentMin_mA);
+  a.currentMax_mA = max(a.currentMax_mA, s.currentMax_mA);
+  a.powerMin_dW = min(a.powerMin_dW, s.powerMin_dW);
+  a.powerMax_dW = max(a.powerMax_dW, s.powerMax_dW);
+  a.tempMin_cC = min(a.tempMin_cC, s.tempMin_cC);
+  a.tempMax_cC = max(a.tempMax_cC, s.tempMax_cC);
+  a.energy_dWs += s.energy_dWs;
+  a.heaterS += s.heaterS;
+}
+
+// ===================== FILES =====================
+static bool ensureSized(const String& path, size_t size) {
+  if (LittleFS.exists(path)) {
+    File f = LittleFS.open(path, "r");
+    size_t have = f ? f.size() : 0;
+    f.close();
+    if (have == size) return true;
+  }
+  File f = LittleFS.open(path, "w");
+  if (!f) return false;
+  static const uint8_t zero[256] = {0};
+  for (size_t done = 0; done < size; done += sizeof(zero)) {
+    size_t k = min(sizeof(zero), size - done);
+    if (f.write(zero, k) != k) { f.close(); return false; }
+  }
+  f.close();
+  return true;
+}
+
+static bool writeIdxHeader(File& f) {
+  IdxHeader h{ IDX_MAGIC, IDX_VERSION, nBlocks, openBlk };
+  f.seek(0);
+  return f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+}
+
+// сводка закрытого блока — в idx, открытым становится следующий
+static void closeBlock() {
+  File f = LittleFS.open(idxPath, "r+");
+  if (f) {
+    f.seek(sizeof(IdxHeader) + slotOf(openBlk) * sizeof(BlockSum));
+    f.write((const uint8_t*)&sums[slotOf(openBlk)], sizeof(BlockSum));
+    openBlk++;
+    writeIdxHeader(f);
+    f.close();
+  } else {
+    openBlk++;
+    DLOGE("history: idx write failed");
+  }
+  sumReset(sums[slotOf(openBlk)], openBlk);
+}
+
+// открытый блок после перезагрузки: его сводки в idx нет — собираем по записям
+static void recoverOpenBlock() {
+  BlockSum& s = sums[slotOf(openBlk)];
+  sumReset(s, openBlk);
+
+  File f = LittleFS.open(dataPath, "r");
+  if (!f) return;
+  f.seek(dataOffset(openBlk, 0));
+  size_t got = f.read((uint8_t*)blockBuf, sizeof(blockBuf)) / sizeof(HistRec);
+  f.close();
+
+  for (size_t i = 0; i < got; i++) {
+    const HistRec& h = blockBuf[i];
+    if (h.tag != tagOf(openBlk) || (s.count && h.r.ts < s.tsLast)) break;
+    sumAdd(s, h);
+  }
+}
+
+bool HistoryBegin(const char* data, const char* idx, uint16_t blocks) {
+  if (sums) return true;
+  if (!LittleFS.begin(true)) return false;
+
+  dataPath = data;
+  idxPath = idx;
+  nBlocks = blocks;
+  mtx = xSemaphoreCreateMutex();
+  sums = (BlockSum*)calloc(nBlocks, sizeof(BlockSum));
+  if (!mtx || !sums) return false;
+
+  size_t idxSize = sizeof(IdxHeader) + nBlocks * sizeof(BlockSum);
+  if (!ensureSized(dataPath, (size_t)nBlocks * HIST_BLOCK_RECS * sizeof(HistRec)) ||
+      !ensureSized(idxPath, idxSize)) {
+    DLOGE("history: files not created");
+    return false;
+  }
+
+  File f = LittleFS.open(idxPath, "r+");
+  if (!f) return false;
+  IdxHeader h{};
+  bool ok = f.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+            h.magic == IDX_MAGIC && h.version == IDX_VERSION && h.blocks == nBlocks;
+  if (ok) {
+    openBlk = h.openBlk;
+    ok = f.read((uint8_t*)sums, nBlocks * sizeof(BlockSum)) == nBlocks * sizeof(BlockSum);
+  }
+  if (!ok) {
+    // новый архив (или сменилась геометрия): сводки пустые, данные считаются пустыми
+    openBlk = 0;
+    memset(sums, 0, nBlocks * sizeof(BlockSum));
+    f.seek(sizeof(IdxHeader));
+    f.write((const uint8_t*)sums, nBlocks * sizeof(BlockSum));
+    writeIdxHeader(f);
+  }
+  f.close();
+
+  if (!ok) {
+    // записи прошлого архива в блоке 0 несут ту же метку — затереть, чтобы не подхватить
+    File d = LittleFS.open(dataPath, "r+");
+    if (d) {
+      memset(blockBuf, 0, sizeof(blockBuf));
+      d.seek(dataOffset(0, 0));
+      d.write((const uint8_t*)blockBuf, sizeof(blockBuf));
+      d.close();
+    }
+  }
+
+  recoverOpenBlock();
+  if (sums[slotOf(openBlk)].count == HIST_BLOCK_RECS) closeBlock();
+
+  const BlockSum& o = sums[slotOf(openBlk)];
+  if (o.count) prevTs = o.tsLast;
+  else if (openBlk && blockValid(openBlk - 1)) prevTs = sums[slotOf(openBlk - 1)].tsLast;
+
+  DLOGI("history: %u blocks, open=%u (%u recs)", (unsigned)nBlocks, (unsigned)openBlk, (unsigned)o.count);
+  return true;
+}
+
+// ===================== APPEND =====================
+bool HistoryAppend(const SampleRec* recs, size_t n) {
+  if (!sums || !n) return sums != nullptr;
+  xSemaphoreTake(mtx, portMAX_DELAY);
+
+  File f = LittleFS.open(dataPath, "r+");
+  bool ok = (bool)f;
+  for (size_t i = 0; i < n && ok; i++) {
+    const SampleRec& r = recs[i];
+    BlockSum& s = sums[slotOf(openBlk)];
+    // полный блок или откат часов: внутри блока ts не убывают
+    if (s.count == HIST_BLOCK_RECS || (s.count && r.ts < s.tsLast)) closeBlock();
+
+    uint32_t dt = r.ts > prevTs ? r.ts - prevTs : 0;
+    HistRec h{ r, (uint16_t)(prevTs && dt <= HIST_MAX_GAP_S ? dt : 0), tagOf(openBlk) };
+
+    BlockSum& cur = sums[slotOf(openBlk)];
+    f.seek(dataOffset(openBlk, cur.count));
+    ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+    if (ok) {
+      sumAdd(cur, h);
+      prevTs = r.ts;
+    }
+  }
+  if (f) {
+    f.flush();
+    f.close();
+  }
+
+  xSemaphoreGive(mtx);
+  if (!ok) DLOGE("history: append failed");
+  return ok;
+}
+
+// ===================== QUERY =====================
+// записи блока [from, count) — в blockBuf; под mtx
+static size_t readBlock(File& f, uint32_t blk, uint32_t from, uint32_t count) {
+  if (from >= count) return 0;
+  f.seek(dataOffset(blk, from));
+  size_t got = f.read((uint8_t*)blockBuf, (count - from) * sizeof(HistRec)) / sizeof(HistRec);
+  // данные и idx могли разойтись при пропадании питания — чужой круг не отдаём
+  for (size_t i = 0; i < got; i++) {
+    if (blockBuf[i].tag != tagOf(blk)) return i;
+  }
+  return got;
+}
+
+bool HistoryRead(uint32_t& pos, uint32_t from, uint32_t to, std::vector<SampleRec>& out, size_t maxRecs) {
+  out.clear();
+  if (!sums) return false;
+  xSemaphoreTake(mtx, portMAX_DELAY);
+
+  uint32_t first = oldestBlk() * HIST_BLOCK_RECS;
+  if (pos < first) pos = first;
+
+  File f = LittleFS.open(dataPath, "r");
+  while (f && out.size() < maxRecs) {
+    uint32_t blk = pos / HIST_BLOCK_RECS;
+    uint32_t i = pos % HIST_BLOCK_RECS;
+    if (blk > openBlk) break;
+
+    const BlockSum& s = sums[slotOf(blk)];
+    bool open = blk == openBlk;
+    uint32_t count = blockValid(blk) ? s.count : 0;
+    // открытый блок ещё растёт: за его последнюю запись не прыгаем
+    uint32_t end = blk * HIST_BLOCK_RECS + (open ? count : HIST_BLOCK_RECS);
+
+    if (i >= count || s.tsLast < from || s.tsFirst > to) {
+      pos = end;   // блок целиком мимо — его записи не читаем
+      if (open) break;
+      continue;
+    }
+
+    size_t got = readBlock(f, blk, i, count);
+    size_t k = 0;
+    for (; k < got && out.size() < maxRecs; k++) {
+      const SampleRec& r = blockBuf[k].r;
+      if (r.ts >= from && r.ts <= to) out.push_back(r);
+    }
+    pos += k;
+    if (k < got) break;          // out заполнен
+    pos = end;
+    if (open) break;
+  }
+  if (f) f.close();
+
+  // осталось ли что смотреть
+  const BlockSum& o = sums[slotOf(openBlk)];
+  bool more = pos < openBlk * HIST_BLOCK_RECS + o.count;
+
+  xSemaphoreGive(mtx);
+  return more;
+}
+
+bool HistoryAggregate(uint32_t from, uint32_t to, HistAgg& out) {
+  out = HistAgg{};
+  if (!sums) return false;
+  xSemaphoreTake(mtx, portMAX_DELAY);
+
+  File f;
+  for (uint32_t blk = oldestBlk(); blk <= openBlk; blk++) {
+    if (!blockValid(blk)) continue;
+    const BlockSum& s = sums[slotOf(blk)];
+    if (s.tsLast < from || s.tsFirst > to) continue;
+
+    if (from <= s.tsFirst && s.tsLast <= to) {
+      aggMerge(out, s);
+      out.blocksSummary++;
+      continue;
+    }
+
+    // край диапазона: по записям
+    if (!f) f = LittleFS.open(dataPath, "r");
+    if (!f) break;
+    BlockSum part{};
+    size_t got = readBlock(f, blk, 0, s.count);
+    for (size_t i = 0; i < got; i++) {
+      if (blockBuf[i].r.ts >= from && blockBuf[i].r.ts <= to) sumAdd(part, blockBuf[i]);
+    }
+    aggMerge(out, part);
+    out.blocksScanned++;
+  }
+  if (f) f.close();
+
+  xSemaphoreGive(mtx);
+  return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include "ring_store.h"
+
+// Архив замеров. В отличие от кольца отправки, подтверждённое сервером здесь не
+// удаляется — хранится, пока не затрут новые (блоки по кругу).
+// Файл поделён на блоки по HIST_BLOCK_RECS записей; на каждый блок — сводка
+// (первый/последний ts, min/max полей, энергия, время нагревателя) в RAM и в idx-файле.
+// Внутри блока ts не убывают (откат часов закрывает блок), поэтому поиск по времени
+// читает только блоки, чей [первый, последний] ts пересекается с запросом, а агрегаты
+// по целиком покрытым блокам берутся из сводок — записи читаются лишь на краях.
+
+static const uint16_t HIST_BLOCK_RECS = 128;
+static const uint32_t HIST_MAX_GAP_S  = 300;   // разрыв длиннее — устройство молчало, не интегрируем
+
+struct HistAgg {
+  uint32_t count;
+  uint32_t tsFirst, tsLast;
+  int32_t  currentMin_mA, currentMax_mA;
+  int32_t  powerMin_dW, powerMax_dW;
+  int16_t  tempMin_cC, tempMax_cC;
+  uint64_t energy_dWs;    // Σ power_dW · Δt, Δt — от предыдущей записи
+  uint32_t heaterS;       // секунд с включённым нагревателем
+  uint32_t blocksSummary; // блоков, взятых из сводок
+  uint32_t blocksScanned; // блоков, прочитанных по записям
+};
+
+// blocks — сколько блоков в файле (на блок HIST_BLOCK_RECS * 36 байт)
+bool HistoryBegin(const char* dataPath, const char* idxPath, uint16_t blocks);
+bool HistoryAppend(const SampleRec* recs, size_t n);
+
+// записи с ts в [from, to] от позиции pos (абсолютный номер записи; 0 — с самой старой).
+// pos сдвигается за последнюю просмотренную; false — архив пройден до конца
+bool HistoryRead(uint32_t& pos, uint32_t from, uint32_t to, std::vector<SampleRec>& out, size_t maxRecs);
+
+// сводка по [from, to]; false — архив не готов
+bool HistoryAggregate(uint32_t from, uint32_t to, HistAgg& out);
@@ -0,0 +1,175 @@
+#include "http_resp.h"
+#include <strings.h>
+
+void HttpRespReset(HttpResp& r) {
+  r.state = HttpResp::ST_STATUS;
+  r.status = -1;
+  r.contentLength = -1;
+  r.chunked = false;
+  r.keepAlive = true;
+  r.remaining = 0;
+  r.date = 0;
+  r.line = "";
+  r.body = "";
+}
+
+// "HTTP/1.1 200 OK"
+static bool parseStatusLine(HttpResp& r) {
+  const char* s = r.line.c_str();
+  if (strncmp(s, "HTTP/1.", 7) != 0 || r.line.length() < 12) return false;
+  if (s[7] == '0') r.keepAlive = false;   // HTTP/1.0 по умолчанию закрывает
+  r.status = atoi(s + 9);
+  return r.status >= 100 && r.status <= 599;
+}
+
+static bool headerIs(const String& line, const char* name, const char*& value) {
+  size_t n = strlen(name);
+  if (line.length() <= n || strncasecmp(line.c_str(), name, n) != 0 || line[n] != ':') return false;
+  value = line.c_str() + n + 1;
+  while (*value == ' ' || *value == '\t') value++;
+  return true;
+}
+
+// дни от 1970-01-01 по григорианской дате (Howard Hinnant, days_from_civil)
+static int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+  y -= m <= 2;
+  int32_t era = (y >= 0 ? y : y - 399) / 400;
+  uint32_t yoe = (uint32_t)(y - era * 400);
+  uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+// RFC 1123: "Sun, 06 Nov 1994 08:49:37 GMT"
+static uint32_t parseHttpDate(const char* v) {
+  static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  char mon[4] = {0};
+  int d, y, hh, mm, ss;
+  const char* p = strchr(v, ',');
+  if (!p) return 0;
+  if (sscanf(p + 1, " %d %3s %d %d:%d:%d", &d, mon, &y, &hh, &mm, &ss) != 6) return 0;
+  const char* m = strstr(months, mon);
+  if (!m || strlen(mon) != 3) return 0;
+  int32_t days = daysFromCivil(y, (uint32_t)((m - months) / 3 + 1), (uint32_t)d);
+  if (days < 0) return 0;
+  return (uint32_t)days * 86400u + (uint32_t)(hh * 3600 + mm * 60 + ss);
+}
+
+static void parseHeader(HttpResp& r) {
+  const char* v;
+  if (headerIs(r.line, "Content-Length", v)) {
+    r.contentLength = atol(v);
+  } else if (headerIs(r.line, "Transfer-Encoding", v)) {
+    if (strcasestr(v, "chunked")) r.chunked = true;
+  } else if (headerIs(r.line, "Date", v)) {
+    r.date = parseHttpDate(v);
+  } else if (headerIs(r.line, "Connection", v)) {
+    if (strncasecmp(v, "close", 5) == 0) r.keepAlive = false;
+    else if (strncasecmp(v, "keep-alive", 10) == 0) r.keepAlive = true;
+  }
+}
+
+// конец заголовков: решаем, как читать тело
+static void headersDone(HttpResp& r) {
+  // промежуточный ответ (100 Continue, 102, 103): за ним идёт настоящий —
+  // заново со status line. 101 — смена протокола, дальше не HTTP
+  if (r.status / 100 == 1 && r.status != 101) {
+    HttpRespReset(r);
+    return;
+  }
+  bool noBody = r.status == 101 || r.status == 204 || r.status == 304;
+  if (noBody) {
+    r.state = HttpResp::ST_DONE;
+  } else if (r.chunked) {
+    r.state = HttpResp::ST_CHUNK_SIZE;
+  } else if (r.contentLength >= 0) {
+    r.remaining = (uint32_t)r.contentLength;
+    r.state = r.remaining ? HttpResp::ST_BODY : HttpResp::ST_DONE;
+  } else {
+    r.keepAlive = false;  // длина неизвестна — тело до закрытия
+    r.state = HttpResp::ST_BODY_TO_CLOSE;
+  }
+}
+
+// строка завершена (CRLF или LF) — обработать в текущем состоянии
+static void lineDone(HttpResp& r) {
+  if (r.line.length() && r.line[r.line.length() - 1] == '\r') {
+    r.line.remove(r.line.length() - 1);
+  }
+
+  switch (r.state) {
+    case HttpResp::ST_STATUS:
+      r.state = parseStatusLine(r) ? HttpResp::ST_HEADERS : HttpResp::ST_ERROR;
+      break;
+    case HttpResp::ST_HEADERS:
+      if (r.line.length() == 0) headersDone(r);
+      else parseHeader(r);
+      break;
+    case HttpResp::ST_CHUNK_SIZE: {
+      char* end = nullptr;
+      unsigned long sz = strtoul(r.line.c_str(), &end, 16);
+      if (end == r.line.c_str()) { r.state = HttpResp::ST_ERROR; break; }
+      r.remaining = sz;
+      r.state = sz ? HttpResp::ST_CHUNK_DATA : HttpResp::ST_TRAILER;
+      break;
+    }
+    case HttpResp::ST_CHUNK_CRLF:
+      r.state = r.line.length() ? HttpResp::ST_ERROR : HttpResp::ST_CHUNK_SIZE;
+      break;
+    case HttpResp::ST_TRAILER:
+      if (r.line.length() == 0) r.state = HttpResp::ST_DONE;
+      break;
+    default:
+      break;
+  }
+  r.line = "";
+}
+
+static bool appendBody(HttpResp& r, const uint8_t* p, size_t n) {
+  if (r.body.length() + n > HTTP_RESP_MAX_BODY) {
+    r.state = HttpResp::ST_ERROR;
+    return false;
+  }
+  r.body.concat((const char*)p, n);
+  return true;
+}
+
+size_t HttpRespFeed(HttpResp& r, const uint8_t* data, size_t len) {
+  size_t i = 0;
+  while (i < len && r.state != HttpResp::ST_DONE && r.state != HttpResp::ST_ERROR) {
+    switch (r.state) {
+      case HttpResp::ST_BODY:
+      case HttpResp::ST_CHUNK_DATA: {
+        size_t n = min((size_t)r.remaining, len - i);
+        if (!appendBody(r, data + i, n)) break;
+        i += n;
+        r.remaining -= n;
+        if (r.remaining == 0) {
+          r.state = (r.state == HttpResp::ST_BODY) ? HttpResp::ST_DONE : HttpResp::ST_CHUNK_CRLF;
+        }
+        break;
+      }
+      case HttpResp::ST_BODY_TO_CLOSE:
+        if (!appendBody(r, data + i, len - i)) break;
+        i = len;
+        break;
+      default: {
+        char c = (char)data[i++];
+        if (c == '\n') {
+          lineDone(r);
+        } else if (r.line.length() >= HTTP_RESP_MAX_LINE) {
+          r.state = HttpResp::ST_ERROR;
+        } else {
+          r.line += c;
+        }
+        break;
+      }
+    }
+  }
+  return i;
+}
+
+void HttpRespFinishOnClose(HttpResp& r) {
+  if (r.state == HttpResp::ST_BODY_TO_CLOSE) r.state = HttpResp::ST_DONE;
+  else if (r.state != HttpResp::ST_DONE) r.state = HttpResp::ST_ERROR;
+}
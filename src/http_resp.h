@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+
+// Инкрементальный разбор ответа HTTP/1.1: кормим теми байтами, что есть.
+// Поддерживает status line, заголовки, Content-Length и chunked;
+// промежуточные ответы 1xx пропускаются.
+// Разбор останавливается ровно на конце ответа (остаток не потребляется).
+struct HttpResp {
+  enum State : uint8_t {
+    ST_STATUS, ST_HEADERS, ST_BODY, ST_BODY_TO_CLOSE,
+    ST_CHUNK_SIZE, ST_CHUNK_DATA, ST_CHUNK_CRLF, ST_TRAILER,
+    ST_DONE, ST_ERROR
+  };
+
+  State    state;
+  int      status;        // код ответа, -1 пока не разобран
+  int32_t  contentLength; // -1 если не указан
+  bool     chunked;
+  bool     keepAlive;     // HTTP/1.1 без "Connection: close"
+  uint32_t remaining;     // осталось байт тела / текущего чанка
+  uint32_t date;          // заголовок Date в unix-секундах, 0 если нет
+  String   line;          // текущая строка status/заголовка/размера чанка
+  String   body;
+};
+
+static const size_t HTTP_RESP_MAX_LINE = 256;
+static const size_t HTTP_RESP_MAX_BODY = 2048;
+
+void   HttpRespReset(HttpResp& r);
+size_t HttpRespFeed(HttpResp& r, const uint8_t* data, size_t len); // сколько байт потреблено
+void   HttpRespFinishOnClose(HttpResp& r); // соединение закрыто сервером
+inline bool HttpRespDone(const HttpResp& r)   { return r.state == HttpResp::ST_DONE; }
+inline bool HttpRespFailed(const HttpResp& r) { return r.state == HttpResp::ST_ERROR; }
@@ -0,0 +1,76 @@
+#include "lz_pack.h"
+
+static const size_t WINDOW    = 4096;          // 12 бит дистанции
+static const size_t MIN_MATCH = 3;
+static const size_t MAX_MATCH = MIN_MATCH + 15; // 4 бита длины
+static const size_t HASH_BITS = 10;            // 1024 * 2 байта = 2 КБ RAM
+
+static inline uint32_t hash3(const uint8_t* p) {
+  uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+bool lzPack(const uint8_t* in, size_t inLen, std::vector<uint8_t>& out) {
+  out.clear();
+  // позиции хранятся в uint16_t, поэтому входы > 64 КБ не сжимаем
+  if (!in || inLen < MIN_MATCH || inLen > 0xFFFF) return false;
+
+  // худший случай: все литералы + управляющий байт на каждые 8
+  out.reserve(LZ_HDR_SIZE + inLen + inLen / 8 + 1);
+  out.push_back(LZ_MAGIC);
+  out.push_back(LZ_VERSION);
+  for (int i = 0; i < 4; i++) out.push_back((uint8_t)(inLen >> (8 * i)));
+
+  // таблица последних позиций (позиция + 1, 0 = пусто)
+  std::vector<uint16_t> head(1u << HASH_BITS, 0);
+
+  size_t ctrlPos = 0;
+  uint8_t ctrlBit = 8;
+  size_t i = 0;
+
+  while (i < inLen) {
+    if (ctrlBit == 8) {
+      ctrlPos = out.size();
+      out.push_back(0);
+      ctrlBit = 0;
+    }
+
+    size_t bestLen = 0, bestDist = 0;
+    if (i + MIN_MATCH <= inLen) {
+      uint32_t h = hash3(in + i);
+      size_t cand = head[h];
+      head[h] = (uint16_t)(i + 1);
+      if (cand) {
+        cand--;
+        size_t dist = i - cand;
+        if (dist > 0 && dist <= WINDOW) {
+          size_t maxLen = min(MAX_MATCH, inLen - i);
+          size_t l = 0;
+          while (l < maxLen && in[cand + l] == in[i + l]) l++;
+          if (l >= MIN_MATCH) { bestLen = l; bestDist = dist; }
+        }
+      }
+    }
+
+    if (bestLen) {
+      uint16_t code = (uint16_t)(((bestDist - 1) << 4) | (bestLen - MIN_MATCH));
+      out[ctrlPos] |= (uint8_t)(1u << ctrlBit);
+      out.push_back((uint8_t)(code >> 8));
+      out.push_back((uint8_t)code);
+      // дозаполним хеш для пропущенных позиций, чтобы не терять совпадения
+      for (size_t k = 1; k < bestLen && i + k + MIN_MATCH <= inLen; k++) {
+        head[hash3(in + i + k)] = (uint16_t)(i + k + 1);
+      }
+      i += bestLen;
+    } else {
+      out.push_back(in[i]);
+      i++;
+    }
+    ctrlBit++;
+
+    // дальше выигрыша уже не будет
+    if (out.size() >= LZ_HDR_SIZE + inLen) return false;
+  }
+
+  return out.size() < inLen;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+
+// Сжатие полезной нагрузки перед шифрованием (LZSS, окно 4 КБ).
+// Формат: [ 'Z' ][ ver=1 ][ u32 LE исходная длина ][ поток LZSS ]
+// Поток: управляющий байт на 8 элементов (бит=1 -> ссылка, LSB первым),
+// литерал = 1 байт, ссылка = 2 байта: (dist-1) 12 бит | (len-3) 4 бита.
+static const uint8_t LZ_MAGIC   = 'Z';
+static const uint8_t LZ_VERSION = 1;
+static const size_t  LZ_HDR_SIZE = 6;
+
+// true, если сжатый вариант получился (out = заголовок + поток)
+bool lzPack(const uint8_t* in, size_t inLen, std::vector<uint8_t>& out);
@@ -1,8 +1,16 @@
 #include <Arduino.h>
 #include "wifi_config.h"
+#include "config_store.h"
 #include "sensors.h"
 #include "gsm_uplink.h"
 #include "ring_store.h"
+#include "history.h"
+#include "boot_timing.h"
+#include "perf_bench.h"
+#include "metrics.h"
+#include "dlog.h"
+#include "pipeline.h"
+#include "power.h"
 #include "esp_sleep.h"
 #include "esp_system.h"
 #define STATUS_LED_PIN 2   
@@ -17,6 +25,13 @@ static Config defaultCfg() {
   c.adminLogin = "admin";
   c.adminPass  = "admin";
   c.voltage = 220.0;
+  c.udpPort = 0;
+  c.uplinkMaxS = 0;     // пакетный режим — только явно из /save
+  c.ctChannels = 1;
+  c.ctNeutral = false;
+  for (CtCal& k : c.ct) k = CtCal{ 50.0, 1.0 };
+  c.heatMinOnS = 60;
+  c.heatMinOffS = 60;
   return c;
 }
 bool isWifiConfigModeNow() {
@@ -36,6 +51,7 @@ void coldResetESP() {
 }
 void systemTask(void* pv) {
   (void)pv;
+  MetricsTrackTask(xTaskGetCurrentTaskHandle(), "system");
 
   bool lastWifiMode = isWifiConfigModeNow();
  uint8_t changeCount = 0;
@@ -72,6 +88,14 @@ coldResetESP();
 void setup() {
   Serial.begin(115200);
   delay(300);
+  DlogStart();
+#if PERF_BENCH
+  // прошивка замеров: только бенчмарки, обычный режим не запускается
+  ConfigStoreBegin(defaultCfg());
+  GsmInit();
+  PerfBenchRun();
+  while (true) vTaskDelay(portMAX_DELAY);
+#endif
   pinMode(WIFI_CFG_PIN, INPUT_PULLUP);
   // === определяем режим СРАЗУ ===
   bool bootWifiMode = isWifiConfigModeNow();
@@ -86,15 +110,31 @@ Serial.printf("GPIO4 at boot = %d\n", digitalRead(WIFI_CFG_PIN));
     "systemTask",
     2048,
     nullptr,
-    3,
+    PRIO_SYSTEM,
     nullptr,
-    1
+    CORE_IO     // core 1 целиком под сбор, см. pipeline.h
   );
 
+  // конфиг читается из NVS один раз; дальше все модули берут снимки из RAM
+  ConfigStoreBegin(defaultCfg());
+
+  // кольцо нужно и в режиме конфига — выгрузка через /export
+  if (!RingStoreBegin("/queue.bin", 256 * 1024)) {
+    Serial.println("❌ RingStore init failed");
+  }
+  // архив: 128 блоков по 128 записей (~5.7 суток при записи раз в 30 с), 576 КБ
+  if (!HistoryBegin("/history.bin", "/history.idx", 128)) {
+    Serial.println("❌ History init failed");
+  }
+
   // === Режим WiFi-конфига по GPIO4 ===
   if (bootWifiMode) {
     Serial.println("🟢 WIFI CONFIG MODE (GPIO4=GND)");
-    WifiConfigStart(defaultCfg());
+    // датчики работают и при наладке — показания идут на страницу через /events
+    SensorsInit();
+    PipelineBegin(nullptr);
+    SensorsStartTasks();
+    WifiConfigStart();
 
     while (true) {
       vTaskDelay(pdMS_TO_TICKS(1000));
@@ -102,15 +142,20 @@ Serial.printf("GPIO4 at boot = %d\n", digitalRead(WIFI_CFG_PIN));
   }
 
   Serial.println("⚪ NORMAL MODE (WiFi disabled)");
-if (!RingStoreBegin("/queue.bin", 256 * 1024)) {
-  Serial.println("❌ RingStore init failed");
-}
+  BootMark("ring store");
+
   // === обычный режим ===
+  // light sleep между окнами сбора и отправки; в режиме конфига не спим
+  PowerBegin();
   SensorsInit();
+  PipelineBegin(GsmNotifyStored);
   SensorsStartTasks();
+  BootMark("sensors");
 
+  // модем (restart, сеть, GPRS) поднимается внутри gsmTask и setup() не держит
   GsmInit();
   GsmStartTask();
+  BootMark("setup done");
 }
 
 
@@ -0,0 +1,177 @@
+#include "metrics.h"
+#include <atomic>
+#include "dlog.h"
+
+struct Hist {
+  std::atomic<uint32_t> buckets[METRIC_BUCKETS];
+  std::atomic<uint32_t> count;
+  std::atomic<uint64_t> sumUs;   // сумма в мкс: округлять по замеру нельзя — короткие уходят в 0
+  std::atomic<uint32_t> maxUs;
+};
+
+static std::atomic<uint32_t> counters[MC_COUNTERS];
+static Hist hists[MH_HISTS];
+static std::atomic<uint32_t> gaugeCur[MG_GAUGES];
+static std::atomic<uint32_t> gaugeMax[MG_GAUGES];
+
+// место берётся fetch_add, task пишется последним: пустой слот ещё заполняется
+struct TrackedTask { std::atomic<TaskHandle_t> task; const char* name; };
+static const uint32_t MAX_TASKS = 8;
+static TrackedTask tasks[MAX_TASKS];
+static std::atomic<uint32_t> tasksCount{0};   // занятых мест, может перевалить за MAX_TASKS
+
+static const char* const COUNTER_NAMES[MC_COUNTERS] = {
+  "ring_fail", "post_ok", "post_fail", "udp_ok", "udp_fail", "bytes_up", "sensor_cycles", "acq_drop",
+  "bursts", "gprs_s", "prep_reuse", "backfill", "heat_failsafe"
+};
+static const char* const HIST_NAMES[MH_HISTS] = {
+  "ring_append", "ring_peek", "crypto", "http_connect", "http_send", "http_resp", "sensor_read",
+  "stage_store", "stage_uplink", "batch_prep", "heater_react"
+};
+static const char* const GAUGE_NAMES[MG_GAUGES] = {
+  "acq_queue", "store_backlog", "awake_s_h"
+};
+
+static uint8_t bucketOf(uint32_t us) {
+  if (us < 16) return 0;
+  uint8_t b = (31 - __builtin_clz(us)) - 3;
+  return b < METRIC_BUCKETS ? b : METRIC_BUCKETS - 1;
+}
+
+// верхняя граница корзины, мкс
+static uint32_t bucketTopUs(uint8_t b) {
+  return 1u << (b + 4);
+}
+
+void MetricCount(MetricCounter c, uint32_t n) {
+  counters[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+void MetricObserveUs(MetricHist h, uint32_t us) {
+  Hist& x = hists[h];
+  x.buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+  x.count.fetch_add(1, std::memory_order_relaxed);
+  x.sumUs.fetch_add(us, std::memory_order_relaxed);
+
+  uint32_t prev = x.maxUs.load(std::memory_order_relaxed);
+  while (us > prev && !x.maxUs.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+}
+
+void MetricGaugeSet(MetricGauge g, uint32_t v) {
+  gaugeCur[g].store(v, std::memory_order_relaxed);
+  uint32_t prev = gaugeMax[g].load(std::memory_order_relaxed);
+  while (v > prev && !gaugeMax[g].compare_exchange_weak(prev, v, std::memory_order_relaxed)) {}
+}
+
+void MetricsTrackTask(TaskHandle_t task, const char* name) {
+  if (!task) return;
+  uint32_t i = tasksCount.fetch_add(1);
+  if (i >= MAX_TASKS) return;
+  tasks[i].name = name;
+  tasks[i].task.store(task, std::memory_order_release);
+}
+
+// квантиль по корзинам (оценка сверху)
+static uint32_t quantileUs(const uint32_t* b, uint32_t count, uint32_t permille) {
+  uint32_t need = (uint64_t)count * permille / 1000;
+  uint32_t acc = 0;
+  for (uint8_t i = 0; i < METRIC_BUCKETS; i++) {
+    acc += b[i];
+    if (acc > need) return bucketTopUs(i);
+  }
+  return bucketTopUs(METRIC_BUCKETS - 1);
+}
+
+// что ушло в последний отчёт: после подтверждения сервером вычитается из живых значений,
+// так что замеры, пришедшие между сборкой и ответом, попадут в следующий отчёт
+struct Reported {
+  bool     valid;
+  uint32_t counters[MC_COUNTERS];
+  uint32_t buckets[MH_HISTS][METRIC_BUCKETS];
+  uint32_t count[MH_HISTS];
+  uint64_t sumUs[MH_HISTS];
+};
+static Reported reported;
+
+String MetricsHealthJson() {
+  String j;
+  j.reserve(640);
+
+  j += "{\"up\":" + String((unsigned long)(millis() / 1000));
+  j += ",\"heap\":" + String((unsigned)ESP.getFreeHeap());
+  j += ",\"heap_min\":" + String((unsigned)ESP.getMinFreeHeap());
+  j += ",\"log_drop\":" + String((unsigned long)DlogDropped());
+
+  // свободный стек задач, байт (минимум за всё время; в ESP-IDF high-water уже в байтах)
+  j += ",\"stack\":{";
+  uint32_t nt = min(tasksCount.load(), MAX_TASKS);
+  bool firstTask = true;
+  for (uint32_t i = 0; i < nt; i++) {
+    TaskHandle_t t = tasks[i].task.load(std::memory_order_acquire);
+    if (!t) continue;
+    if (!firstTask) j += ",";
+    firstTask = false;
+    j += "\"" + String(tasks[i].name) + "\":";
+    j += String((unsigned)uxTaskGetStackHighWaterMark(t));
+  }
+  j += "}";
+
+  j += ",\"c\":{";
+  for (uint8_t i = 0; i < MC_COUNTERS; i++) {
+    uint32_t v = counters[i].load();
+    reported.counters[i] = v;
+    if (i) j += ",";
+    j += "\"" + String(COUNTER_NAMES[i]) + "\":" + String((unsigned long)v);
+  }
+  j += "}";
+
+  // уровни: [сейчас, максимум за интервал]
+  j += ",\"g\":{";
+  for (uint8_t i = 0; i < MG_GAUGES; i++) {
+    uint32_t cur = gaugeCur[i].load();
+    uint32_t mx = gaugeMax[i].load();
+    if (i) j += ",";
+    j += "\"" + String(GAUGE_NAMES[i]) + "\":[" + String((unsigned long)cur) + "," + String((unsigned long)mx) + "]";
+  }
+  j += "}";
+
+  // гистограмма: [count, avg_ms, p50_us, p95_us, max_us]
+  j += ",\"h\":{";
+  bool first = true;
+  for (uint8_t i = 0; i < MH_HISTS; i++) {
+    Hist& x = hists[i];
+    uint32_t b[METRIC_BUCKETS];
+    for (uint8_t k = 0; k < METRIC_BUCKETS; k++) b[k] = reported.buckets[i][k] = x.buckets[k].load();
+    uint32_t count = reported.count[i] = x.count.load();
+    uint64_t sumUs = reported.sumUs[i] = x.sumUs.load();
+    uint32_t maxUs = x.maxUs.load();
+    if (!count) continue;
+
+    if (!first) j += ",";
+    first = false;
+    char row[96];
+    snprintf(row, sizeof(row), "\"%s\":[%lu,%lu,%lu,%lu,%lu]", HIST_NAMES[i],
+             (unsigned long)count, (unsigned long)((sumUs / count + 500) / 1000),
+             (unsigned long)quantileUs(b, count, 500), (unsigned long)quantileUs(b, count, 950),
+             (unsigned long)maxUs);
+    j += row;
+  }
+  j += "}}";
+  reported.valid = true;
+  return j;
+}
+
+void MetricsHealthAcked() {
+  if (!reported.valid) return;
+  reported.valid = false;
+
+  for (uint8_t i = 0; i < MC_COUNTERS; i++) counters[i].fetch_sub(reported.counters[i]);
+  for (uint8_t i = 0; i < MG_GAUGES; i++) gaugeMax[i].store(gaugeCur[i].load());
+  for (uint8_t i = 0; i < MH_HISTS; i++) {
+    Hist& x = hists[i];
+    for (uint8_t k = 0; k < METRIC_BUCKETS; k++) x.buckets[k].fetch_sub(reported.buckets[i][k]);
+    x.count.fetch_sub(reported.count[i]);
+    x.sumUs.fetch_sub(reported.sumUs[i]);
+    x.maxUs.store(0);
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Счётчики и гистограммы задержек, обновляются без блокировок из любой задачи.
+// Набор метрик фиксирован (enum) — ни памяти, ни поиска по имени в горячем пути.
+
+enum MetricCounter : uint8_t {
+  MC_RING_APPEND_FAIL,
+  MC_POST_OK,
+  MC_POST_FAIL,
+  MC_UDP_OK,
+  MC_UDP_FAIL,
+  MC_BYTES_UP,        // отправлено в аплинк (запросы целиком)
+  MC_SENSOR_CYCLES,
+  MC_ACQ_DROP,        // замер не влез в буфер сбор -> хранение
+  MC_BURSTS,          // циклов отправки (в пакетном режиме — сеансов связи)
+  MC_GPRS_S,          // секунд с поднятым GPRS
+  MC_PREP_REUSED,     // пакетов бэклога, повторённых из готового блоба
+  MC_BACKFILL_RECS,   // записей архива, досланных по просьбе сервера
+  MC_HEATER_FAILSAFE, // нагреватель выключен по отказу/молчанию датчика
+  MC_COUNTERS
+};
+
+enum MetricHist : uint8_t {
+  MH_RING_APPEND,
+  MH_RING_PEEK,
+  MH_CRYPTO,          // CryptoSession encrypt/decrypt
+  MH_HTTP_CONNECT,    // postBlob: TCP connect
+  MH_HTTP_SEND,       // postBlob: запись запроса
+  MH_HTTP_RESPONSE,   // postBlob: ожидание и разбор ответа
+  MH_SENSOR_READ,     // цикл замера (Irms + DS18B20)
+  MH_STAGE_STORE,     // конвейер: публикация замера -> запись в кольцо
+  MH_STAGE_UPLINK,    // конвейер: запись в кольцо -> начало цикла отправки
+  MH_BATCH_PREP,      // пакет бэклога: чтение кольца + JSON + LZ + AES
+  MH_HEATER_REACT,    // термостат: температура готова -> решение/реле (max — худший случай)
+  MH_HISTS
+};
+
+// уровни (глубина очередей, время без сна): текущее значение и максимум за интервал отчёта
+enum MetricGauge : uint8_t {
+  MG_ACQ_QUEUE,       // сообщений в буфере сбор -> хранение
+  MG_STORE_BACKLOG,   // записей в кольце, ждущих аплинка
+  MG_AWAKE_S,         // секунд без сна за последний полный час
+  MG_GAUGES
+};
+
+// корзины log2(мкс): 0 — <16 мкс, k — [2^(k+3), 2^(k+4)), последняя — всё выше ~8 с
+static const uint8_t METRIC_BUCKETS = 20;
+
+void MetricCount(MetricCounter c, uint32_t n = 1);
+void MetricObserveUs(MetricHist h, uint32_t us);
+void MetricGaugeSet(MetricGauge g, uint32_t v);
+void MetricsTrackTask(TaskHandle_t task, const char* name);  // для high-water стека
+
+// замер области видимости: { MetricScope m(MH_CRYPTO); ... }
+class MetricScope {
+public:
+  explicit MetricScope(MetricHist h) : hist(h), t0(micros()) {}
+  ~MetricScope() { MetricObserveUs(hist, micros() - t0); }
+private:
+  MetricHist hist;
+  uint32_t t0;
+};
+
+// компактный JSON-объект для отчёта о здоровье (накопленное с последнего подтверждённого)
+String MetricsHealthJson();
+// сервер принял последний отчёт: его счётчики и гистограммы вычитаются, максимумы сбрасываются
+void MetricsHealthAcked();
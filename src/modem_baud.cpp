@@ -0,0 +1,63 @@
+#include "modem_baud.h"
+#include "dlog.h"
+
+static const uint32_t PROBE_BAUDS[] = { 115200, 57600, 38400, 19200, 9600 };
+
+bool ModemLinkVerify(const BaudOps& ops, uint8_t tries) {
+  for (uint8_t i = 0; i < tries; i++) {
+    if (!ops.testAT(500)) return false;
+  }
+  return true;
+}
+
+static bool setIpr(const BaudOps& ops, uint32_t baud) {
+  char cmd[16];
+  snprintf(cmd, sizeof(cmd), "+IPR=%u", (unsigned)baud);
+  return ops.command(cmd, 1000);
+}
+
+// сначала целевая (автобод подхватит её сразу), затем остальные по убыванию
+static uint32_t probe(const BaudOps& ops, uint32_t target) {
+  ops.uartBegin(target);
+  if (ops.testAT(800)) return target;
+  for (uint32_t b : PROBE_BAUDS) {
+    if (b == target) continue;
+    ops.uartBegin(b);
+    if (ops.testAT(800)) return b;
+  }
+  return 0;
+}
+
+uint32_t ModemBaudNegotiate(const BaudOps& ops, uint32_t target) {
+  uint32_t found = probe(ops, target);
+
+  if (!found) {
+    DLOGE("Modem not answering on any baud");
+    ops.uartBegin(target);
+    return 0;
+  }
+  DLOGI("Modem answers at %u baud", (unsigned)found);
+  if (found == target && ModemLinkVerify(ops, 3)) return found;
+
+  // ответ на IPR приходит ещё на старой скорости
+  setIpr(ops, target);
+  ops.uartBegin(target);
+
+  if (ModemLinkVerify(ops, 3)) {
+    ops.command("&W", 2000);
+    DLOGI("Modem switched to %u baud", (unsigned)target);
+    return target;
+  }
+
+  // откат на найденную скорость (модем мог не принять IPR)
+  DLOGW("Baud switch failed, falling back");
+  ops.uartBegin(found);
+  if (ModemLinkVerify(ops, 2)) return found;
+
+  // модем всё же ушёл на новую скорость — вернуть его на найденную:
+  // команда и ответ на ней — на новой скорости, проверка — уже на старой
+  ops.uartBegin(target);
+  setIpr(ops, found);
+  ops.uartBegin(found);
+  return ModemLinkVerify(ops, 2) ? found : 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <Arduino.h>
+
+// Согласование скорости AT-канала. SIM900 стартует в автободе (IPR=0) или на
+// сохранённой скорости. Ищем, на какой скорости он отвечает, переводим AT+IPR
+// на целевую, проверяем несколькими AT и только тогда сохраняем (&W); иначе откат.
+// UART и модем — через BaudOps: в прошивке SerialAT + TinyGSM, в тестах — псевдотерминал.
+struct BaudOps {
+  void (*uartBegin)(uint32_t baud);                  // переоткрыть UART на скорости baud
+  bool (*testAT)(uint32_t timeoutMs);                // "AT" -> "OK"
+  bool (*command)(const char* cmd, uint32_t timeoutMs); // "AT" + cmd; true — пришёл OK
+};
+
+// скорость, на которой договорились (UART уже на ней); 0 — модем не отвечает
+uint32_t ModemBaudNegotiate(const BaudOps& ops, uint32_t target);
+// несколько AT подряд: на завышенной скорости единичный OK бывает случайным
+bool ModemLinkVerify(const BaudOps& ops, uint8_t tries);
@@ -0,0 +1,161 @@
+#include "perf_bench.h"
+
+#if PERF_BENCH
+#include <vector>
+#include <nvs.h>
+#include <esp_timer.h>
+#include "ring_store.h"
+#include "crypto_aes.h"
+#include "lz_pack.h"
+#include "gsm_uplink.h"
+
+// ===================== ALLOC COUNTER =====================
+// env:bench линкуется с -Wl,--wrap=malloc,calloc,realloc — считаем все выделения,
+// включая String/std::vector/new и mbedtls
+static volatile uint32_t allocCount = 0;
+static volatile uint32_t allocBytes = 0;
+
+extern "C" {
+void* __real_malloc(size_t n);
+void* __real_calloc(size_t n, size_t sz);
+void* __real_realloc(void* p, size_t n);
+
+void* __wrap_malloc(size_t n) {
+  allocCount++; allocBytes += n;
+  return __real_malloc(n);
+}
+void* __wrap_calloc(size_t n, size_t sz) {
+  allocCount++; allocBytes += n * sz;
+  return __real_calloc(n, sz);
+}
+void* __wrap_realloc(void* p, size_t n) {
+  allocCount++; allocBytes += n;
+  return __real_realloc(p, n);
+}
+}
+
+// ===================== HARNESS =====================
+struct BenchStat {
+  uint32_t iters;
+  int64_t  us;
+  uint32_t allocs;
+  uint32_t allocBytes;
+  int32_t  nvsEntries;   // записи NVS (по 32 байта)
+  uint32_t bytes;        // полезных байт на операцию (вход/выход — см. тест)
+};
+
+static int32_t nvsUsedEntries() {
+  nvs_stats_t st;
+  if (nvs_get_stats(nullptr, &st) != ESP_OK) return 0;
+  return (int32_t)st.used_entries;
+}
+
+template <typename Fn>
+static BenchStat runBench(uint32_t iters, Fn fn) {
+  BenchStat s{};
+  s.iters = iters;
+
+  int32_t nvs0 = nvsUsedEntries();
+  uint32_t a0 = allocCount, b0 = allocBytes;
+  int64_t t0 = esp_timer_get_time();
+
+  for (uint32_t i = 0; i < iters; i++) s.bytes = fn(i);
+
+  s.us = esp_timer_get_time() - t0;
+  s.allocs = allocCount - a0;
+  s.allocBytes = allocBytes - b0;
+  s.nvsEntries = nvsUsedEntries() - nvs0;
+  return s;
+}
+
+// одна строка JSON на тест; flash_b_op — данные файла + записи NVS
+static void report(const char* name, const BenchStat& s, uint32_t fileBytesOp = 0) {
+  double n = s.iters ? s.iters : 1;
+  double usOp = s.us / n;
+  Serial.printf("{\"bench\":\"%s\",\"iters\":%u,\"us_op\":%.2f,\"ops_s\":%.1f,"
+                "\"allocs_op\":%.2f,\"alloc_b_op\":%.1f,\"flash_b_op\":%.1f,\"bytes\":%u}\n",
+                name, (unsigned)s.iters, usOp, usOp > 0 ? 1e6 / usOp : 0.0,
+                s.allocs / n, s.allocBytes / n,
+                fileBytesOp + (s.nvsEntries > 0 ? s.nvsEntries * 32.0 / n : 0.0),
+                (unsigned)s.bytes);
+}
+
+static SampleRec benchRec(uint32_t i) {
+  SampleRec r{};
+  r.ts = 1700000000u + i * 30;
+  r.current_mA = 1234 + (int32_t)(i % 17);
+  r.power_dW = 2714 + (int32_t)(i % 31);
+  r.temp_cC = (int16_t)(2150 - (int32_t)(i % 50));
+  r.flags = i & 1;
+  return r;
+}
+
+// ===================== BENCHES =====================
+void PerfBenchRun() {
+  Serial.printf("{\"bench_start\":1,\"build\":\"%s %s\",\"idf\":\"%s\",\"cpu_mhz\":%u,\"heap_free\":%u}\n",
+                __DATE__, __TIME__, esp_get_idf_version(), (unsigned)getCpuFrequencyMhz(),
+                (unsigned)ESP.getFreeHeap());
+
+  // ---- CRC записи ----
+  {
+    uint8_t rec[20];
+    for (size_t i = 0; i < sizeof(rec); i++) rec[i] = (uint8_t)(i * 37);
+    volatile uint32_t sink = 0;
+    BenchStat s = runBench(20000, [&](uint32_t) { sink += RingStoreCrc32(rec, sizeof(rec)); return (uint32_t)sizeof(rec); });
+    report("crc32_rec", s);
+  }
+
+  // ---- кольцо ----
+  // свой файл и свой namespace NVS: очередь /queue.bin и её head/tail ("ring") не трогаем
+  if (RingStoreBegin("/bench.bin", 64 * 1024, "ringbench")) {
+    RingStoreDrop(RingStoreCountApprox());
+
+    BenchStat s = runBench(500, [](uint32_t i) { RingStoreAppend(benchRec(i)); return (uint32_t)sizeof(SampleRec); });
+    report("ring_append", s, 40);  // RecBin v2 — 40 байт в файле
+
+    std::vector<SampleRec> batch;
+    batch.reserve(8);
+    s = runBench(200, [&](uint32_t i) { return (uint32_t)RingStorePeek((i * 8) % 400, batch, 8); });
+    report("ring_peek8", s);
+
+    s = runBench(50, [&](uint32_t) { RingStoreDrop(8); return (uint32_t)8; });
+    report("ring_drop8", s);
+  } else {
+    Serial.println("{\"bench\":\"ring\",\"error\":\"begin\"}");
+  }
+
+  // ---- AES ----
+  {
+    static uint8_t plain[512];
+    for (size_t i = 0; i < sizeof(plain); i++) plain[i] = (uint8_t)('a' + i % 26);
+    std::vector<uint8_t> blob;
+
+    BenchStat s = runBench(200, [&](uint32_t) {
+      aesEncryptBlob("12345678", plain, sizeof(plain), blob); return (uint32_t)blob.size(); });
+    report("aes_blob_512", s);
+
+    CryptoSession cs;
+    cs.setPass("12345678");
+    s = runBench(200, [&](uint32_t) { cs.encrypt(plain, sizeof(plain), blob); return (uint32_t)blob.size(); });
+    report("aes_session_512", s);
+  }
+
+  // ---- пакет бэклога: JSON -> LZ -> AES ----
+  {
+    std::vector<SampleRec> batch;
+    for (uint32_t i = 0; i < 8; i++) batch.push_back(benchRec(i));
+    std::vector<uint8_t> blob;
+
+    BenchStat s = runBench(100, [&](uint32_t) { GsmBenchPayload(batch, blob); return (uint32_t)blob.size(); });
+    report("payload_batch8", s);
+
+    std::vector<uint8_t> packed;
+    static uint8_t json[600];
+    for (size_t i = 0; i < sizeof(json); i++) json[i] = (uint8_t)"{\"ts\":1700000000,\"current_mA\":1234},"[i % 36];
+    s = runBench(100, [&](uint32_t) { lzPack(json, sizeof(json), packed); return (uint32_t)packed.size(); });
+    report("lz_pack_600", s);
+  }
+
+  Serial.println("{\"bench_done\":1}");
+}
+#endif
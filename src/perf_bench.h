@@ -0,0 +1,10 @@
+#pragma once
+#include <Arduino.h>
+
+// Замеры горячих путей на самом устройстве (отдельная прошивка: pio run -e bench).
+// Результат — по строке JSON на тест в Serial, начиная с {"bench_start":...},
+// чтобы сравнивать релизы скриптом. Кольцо гоняется в /bench.bin, но счётчики
+// head/tail общие с /queue.bin — не прошивать на устройство с невыгруженными данными.
+#if PERF_BENCH
+void PerfBenchRun();
+#endif
@@ -0,0 +1,171 @@
+#include "pipeline.h"
+#include <freertos/message_buffer.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "power.h"
+#include "history.h"
+#include "metrics.h"
+#include "dlog.h"
+
+enum StageKind : uint8_t {
+  MSG_SAMPLE,
+  MSG_URGENT,   // замер с тревогой: сразу во flash и будим аплинк
+  MSG_FLUSH     // аплинк/выгрузка: всё из RTC-буфера во flash
+};
+
+// сообщение сбор -> хранение; t0 — для задержки стадии
+struct StageMsg {
+  SampleRec rec;
+  uint32_t  t0Us;
+  uint8_t   kind;
+};
+
+// 16 замеров (8 мин при записи раз в 30 с), +4 байта длины на сообщение
+static const size_t STAGE_MSGS = 16;
+static const size_t STAGE_BUF_BYTES = STAGE_MSGS * (sizeof(StageMsg) + sizeof(size_t));
+
+static MessageBufferHandle_t acqBuf = nullptr;
+static SemaphoreHandle_t sendMtx = nullptr;   // писателей несколько (сбор, запросы flush), буфер это не прощает
+static SemaphoreHandle_t flushDone = nullptr;
+static PipelineStoredFn storedFn = nullptr;
+
+// ===================== RTC STAGING =====================
+// Свежие записи копятся в RTC slow memory и уходят во flash пачкой: меньше
+// стираний и записей NVS, меньше времени без сна. RTC_NOINIT переживает
+// перезагрузку по панике/WDT/ESP.restart (RTC_DATA_ATTR загрузчик бы
+// перезаписал); после пропадания питания содержимое — мусор, его отсекает crc.
+static const uint32_t STAGE_MAGIC  = 0x53544732;  // 'STG2' (SampleRec v2)
+static const size_t   STAGE_COMMIT = 8;           // пачка во flash (4 мин при записи раз в 30 с)
+static const size_t   STAGE_RTC_MAX = 32;         // запас, если flash временно не пишется
+
+struct RtcStage {
+  uint32_t  magic;
+  uint32_t  count;
+  SampleRec recs[STAGE_RTC_MAX];
+  uint32_t  crc;
+};
+static RTC_NOINIT_ATTR RtcStage rtcStage;
+
+static uint32_t stageCrc() {
+  return RingStoreCrc32((const uint8_t*)&rtcStage.count,
+                        sizeof(rtcStage.count) + rtcStage.count * sizeof(SampleRec));
+}
+
+static void stageSeal() {
+  rtcStage.magic = STAGE_MAGIC;
+  rtcStage.crc = stageCrc();
+}
+
+static void stageRecover() {
+  bool valid = rtcStage.magic == STAGE_MAGIC && rtcStage.count <= STAGE_RTC_MAX && rtcStage.crc == stageCrc();
+  if (!valid) {
+    rtcStage.count = 0;
+    stageSeal();
+    return;
+  }
+  if (rtcStage.count) DLOGI("pipeline: %u staged records survived reset", (unsigned)rtcStage.count);
+}
+
+static void stagePush(const SampleRec& r) {
+  if (rtcStage.count == STAGE_RTC_MAX) {
+    // flash не пишется давно — старейшую запись теряем, свежие важнее
+    memmove(rtcStage.recs, rtcStage.recs + 1, (STAGE_RTC_MAX - 1) * sizeof(SampleRec));
+    rtcStage.count--;
+    MetricCount(MC_ACQ_DROP);
+  }
+  rtcStage.recs[rtcStage.count++] = r;
+  stageSeal();
+}
+
+static void stageCommit(bool urgent) {
+  size_t n = rtcStage.count;
+  if (!n) return;
+
+  bool ok = RingStoreAppendBatch(rtcStage.recs, n);
+  DLOG_AT(ok ? DLOG_LVL_INFO : DLOG_LVL_ERROR, "RingStoreAppendBatch: %s n=%u last ts=%u",
+          ok ? "OK" : "FAIL", (unsigned)n, rtcStage.recs[n - 1].ts);
+  if (!ok) return;   // останутся в RTC до следующей попытки
+
+  // архив — вслед за кольцом; его сбой не держит запись в RTC (кольцо уже приняло)
+  HistoryAppend(rtcStage.recs, n);
+
+  rtcStage.count = 0;
+  stageSeal();
+  MetricGaugeSet(MG_STORE_BACKLOG, RingStoreCountApprox());
+  if (storedFn) storedFn(n, urgent);
+}
+
+// ===================== STORE TASK =====================
+static void storeTask(void* pv) {
+  (void)pv;
+  MetricsTrackTask(xTaskGetCurrentTaskHandle(), "store");
+  PowerRegister(PWR_STORE, nullptr);
+
+  // пережившее перезагрузку — сразу во flash
+  stageCommit(false);
+
+  StageMsg m;
+  while (true) {
+    if (xMessageBufferIsEmpty(acqBuf)) PowerIdle(PWR_STORE);
+    if (xMessageBufferReceive(acqBuf, &m, sizeof(m), portMAX_DELAY) != sizeof(m)) continue;
+    PowerBusy(PWR_STORE);
+
+    if (m.kind == MSG_FLUSH) {
+      stageCommit(false);
+      xSemaphoreGive(flushDone);
+      continue;
+    }
+
+    stagePush(m.rec);
+    MetricObserveUs(MH_STAGE_STORE, micros() - m.t0Us);
+    DLOGD("staged ts=%u I=%ldmA P=%lddW T=%dcC n=%u", m.rec.ts, m.rec.current_mA, m.rec.power_dW,
+          m.rec.temp_cC, (unsigned)rtcStage.count);
+
+    bool urgent = m.kind == MSG_URGENT;
+    if (urgent || rtcStage.count >= STAGE_COMMIT) stageCommit(urgent);
+  }
+}
+
+static bool sendMsg(const StageMsg& m, TickType_t wait) {
+  if (xSemaphoreTake(sendMtx, wait) != pdTRUE) return false;
+  bool ok = xMessageBufferSend(acqBuf, &m, sizeof(m), wait) == sizeof(m);
+  xSemaphoreGive(sendMtx);
+  return ok;
+}
+
+// ===================== API =====================
+bool PipelineBegin(PipelineStoredFn onStored) {
+  if (acqBuf) return true;
+  storedFn = onStored;
+  stageRecover();
+
+  acqBuf = xMessageBufferCreate(STAGE_BUF_BYTES);
+  sendMtx = xSemaphoreCreateMutex();
+  flushDone = xSemaphoreCreateBinary();
+  if (!acqBuf || !sendMtx || !flushDone) return false;
+
+  return xTaskCreatePinnedToCore(storeTask, "storeTask", 4096, nullptr, PRIO_STORE, nullptr, CORE_IO) == pdPASS;
+}
+
+bool PipelinePublish(const SampleRec& r, bool urgent) {
+  if (!acqBuf) return false;
+
+  StageMsg m{ r, (uint32_t)micros(), (uint8_t)(urgent ? MSG_URGENT : MSG_SAMPLE) };
+  bool ok = sendMsg(m, 0);
+  if (!ok) MetricCount(MC_ACQ_DROP);
+
+  size_t used = STAGE_BUF_BYTES - xMessageBufferSpacesAvailable(acqBuf);
+  MetricGaugeSet(MG_ACQ_QUEUE, used / (sizeof(StageMsg) + sizeof(size_t)));
+  return ok;
+}
+
+bool PipelineFlush(uint32_t timeoutMs) {
+  if (!acqBuf) return false;
+
+  // прошлый запрос мог истечь по таймауту и отметиться позже
+  xSemaphoreTake(flushDone, 0);
+  StageMsg m{};
+  m.kind = MSG_FLUSH;
+  if (!sendMsg(m, pdMS_TO_TICKS(timeoutMs))) return false;
+  return xSemaphoreTake(flushDone, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
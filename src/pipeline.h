@@ -0,0 +1,43 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "ring_store.h"
+
+// Конвейер данных: сбор -> хранение -> аплинк.
+//   sensorsTask --MessageBuffer--> storeTask --RTC-буфер--пачкой--> /queue.bin + /history.bin
+//                                         \--onStored()--> gsmTask (будится по данным)
+//
+// ===================== РАЗМЕЩЕНИЕ ЗАДАЧ =====================
+// core 1 отдан сбору: окно выборок тока — плотный цикл АЦП на ~0.2 с, 1-Wire
+// чувствителен к задержкам; ни UART модема, ни WiFi/lwIP, ни записи во flash на этом ядре.
+// Там же термостат: выше сбора, реагирует на температуру даже посреди окна выборок.
+// core 0 — всё, что ждёт ввода-вывода: хранение, модем, веб, системный контроль, лог
+// (там же системные задачи WiFi/lwIP IDF).
+// Запись во flash на время стирания/программирования останавливает кэш обоих ядер —
+// это неизбежно, но хранение коротко и идёт пачками по одной записи раз в 30 с.
+//
+// Приоритеты: чем короче работа и чем дороже задержка — тем выше.
+static const BaseType_t CORE_ACQ    = 1;
+static const BaseType_t CORE_IO     = 0;
+
+static const UBaseType_t PRIO_HEATER = 5;  // микросекунды работы, задержка реакции — метрика
+static const UBaseType_t PRIO_ACQ    = 3;  // выше loopTask Arduino
+static const UBaseType_t PRIO_STORE  = 4;  // миллисекунды работы, разгружает буфер
+static const UBaseType_t PRIO_UPLINK = 2;  // долгие AT-обмены, уступает хранению
+static const UBaseType_t PRIO_WEB    = 2;
+static const UBaseType_t PRIO_SYSTEM = 1;  // опрос GPIO раз в 10 с
+static const UBaseType_t PRIO_LOG    = 1;
+static const UBaseType_t PRIO_POWER  = 1;  // решает про сон, когда остальные ждут
+
+// n записей легли в кольцо; urgent — среди них тревожная
+typedef void (*PipelineStoredFn)(size_t n, bool urgent);
+
+// запуск стадии хранения; onStored вызывается после каждой пачки в кольце (nullptr — нет аплинка)
+bool PipelineBegin(PipelineStoredFn onStored);
+
+// из стадии сбора: не блокирует, false — буфер полон (запись потеряна и посчитана);
+// urgent — не ждать пачки, сразу во flash и в аплинк
+bool PipelinePublish(const SampleRec& r, bool urgent = false);
+
+// дописать накопленное в RTC-буфере в кольцо (перед чтением кольца); ждёт не дольше timeoutMs
+bool PipelineFlush(uint32_t timeoutMs);
@@ -0,0 +1,115 @@
+#include "power.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "power_sched.h"
+#include "pipeline.h"
+#include "metrics.h"
+#include "dlog.h"
+
+static_assert(PWR_CLIENTS <= PWR_MAX_CLIENTS, "power clients");
+
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+static PowerSched sched{};
+static PowerWakeFn wakeFns[PWR_CLIENTS];
+static TaskHandle_t powerTaskHandle = nullptr;
+static PowerMeter meter{};
+
+// состояние клиента поменялось — powerTask пересматривает план
+static void kick() {
+  if (powerTaskHandle) xTaskNotifyGive(powerTaskHandle);
+}
+
+void PowerRegister(PowerClient c, PowerWakeFn wake) {
+  portENTER_CRITICAL(&mux);
+  wakeFns[c] = wake;
+  sched.busy |= (1u << c);
+  sched.timed &= ~(1u << c);
+  portEXIT_CRITICAL(&mux);
+}
+
+void PowerBusy(PowerClient c) {
+  portENTER_CRITICAL(&mux);
+  sched.busy |= (1u << c);
+  sched.timed &= ~(1u << c);
+  portEXIT_CRITICAL(&mux);
+}
+
+void PowerIdleUntil(PowerClient c, uint32_t dueMs) {
+  portENTER_CRITICAL(&mux);
+  sched.busy &= ~(1u << c);
+  sched.timed |= (1u << c);
+  sched.due[c] = dueMs;
+  portEXIT_CRITICAL(&mux);
+  kick();
+}
+
+void PowerIdle(PowerClient c) {
+  portENTER_CRITICAL(&mux);
+  sched.busy &= ~(1u << c);
+  sched.timed &= ~(1u << c);
+  portEXIT_CRITICAL(&mux);
+  kick();
+}
+
+void PowerKeepRadio(bool on) {
+  portENTER_CRITICAL(&mux);
+  sched.keepRadio = on;
+  portEXIT_CRITICAL(&mux);
+  kick();
+}
+
+// ===================== SLEEP =====================
+static void lightSleep(uint32_t ms) {
+  Serial.flush();   // хвост лога в FIFO UART при засыпании теряется
+  int64_t t0 = esp_timer_get_time();
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+  esp_light_sleep_start();
+  PowerMeterSlept(meter, (uint32_t)((esp_timer_get_time() - t0) / 1000));
+}
+
+static void powerTask(void* pv) {
+  (void)pv;
+  MetricsTrackTask(xTaskGetCurrentTaskHandle(), "power");
+
+  while (true) {
+    uint32_t now = millis();
+    if (PowerMeterRoll(meter, now)) {
+      MetricGaugeSet(MG_AWAKE_S, meter.lastAwakeMs / 1000);
+      DLOGI("awake %u s in last hour", (unsigned)(meter.lastAwakeMs / 1000));
+    }
+
+    portENTER_CRITICAL(&mux);
+    PowerPlan p = PowerSchedPlan(sched, now);
+    // разбуженный считается занятым, пока сам не отметится: иначе уснём раньше, чем он проснётся
+    sched.timed &= ~p.wake;
+    sched.busy |= p.wake;
+    portEXIT_CRITICAL(&mux);
+
+    if (p.wake) {
+      for (uint8_t i = 0; i < PWR_CLIENTS; i++) {
+        if ((p.wake & (1u << i)) && wakeFns[i]) wakeFns[i]();
+      }
+      continue;
+    }
+
+    // пока считали план, кто-то мог сменить состояние — тогда план устарел
+    if (p.sleepMs && !ulTaskNotifyTake(pdTRUE, 0)) {
+      lightSleep(p.sleepMs);
+      continue;
+    }
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(p.waitMs));
+  }
+}
+
+// ===================== API =====================
+bool PowerBegin() {
+  if (powerTaskHandle) return true;
+  PowerMeterRoll(meter, millis());
+  return xTaskCreatePinnedToCore(powerTask, "powerTask", 3072, nullptr, PRIO_POWER, &powerTaskHandle, CORE_IO) == pdPASS;
+}
+
+bool PowerEnabled() {
+  return powerTaskHandle != nullptr;
+}
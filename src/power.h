@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+
+// Управление питанием: light sleep между окнами сбора и отправки.
+// Задачи отмечают, заняты они или ждут (до срока или события); когда все ждут,
+// powerTask засыпает до ближайшего срока и будит владельца срока через wake().
+// Тики FreeRTOS во время light sleep стоят, millis() — нет, поэтому клиенты
+// ждут срок по millis() и полагаются на wake(), а не на таймаут в тиках.
+//
+// Без PowerBegin() (режим конфига) все вызовы — пустые, устройство не спит.
+
+enum PowerClient : uint8_t {
+  PWR_ACQ,
+  PWR_STORE,
+  PWR_UPLINK,
+  PWR_HEATER,
+  PWR_CLIENTS
+};
+
+typedef void (*PowerWakeFn)();
+
+// только в обычном режиме, после создания задач-клиентов не обязательно
+bool PowerBegin();
+bool PowerEnabled();
+
+// клиент зарегистрирован занятым; wake() зовётся из powerTask при наступлении срока
+void PowerRegister(PowerClient c, PowerWakeFn wake);
+void PowerBusy(PowerClient c);
+void PowerIdleUntil(PowerClient c, uint32_t dueMs);   // dueMs — по millis()
+void PowerIdle(PowerClient c);                        // ждёт события без срока
+
+// WiFi STA не переживает light sleep (точка доступа рвёт ассоциацию): пока
+// держим радио, powerTask не засыпает, а ждёт — WiFi сам уходит в modem-sleep
+void PowerKeepRadio(bool on);
@@ -0,0 +1,52 @@
+#include "power_sched.h"
+
+PowerPlan PowerSchedPlan(const PowerSched& s, uint32_t nowMs) {
+  PowerPlan p{0, 0, PWR_MAX_SLEEP_MS};
+
+  uint32_t nearest = PWR_MAX_SLEEP_MS;
+  for (uint8_t i = 0; i < PWR_MAX_CLIENTS; i++) {
+    if (!(s.timed & (1u << i))) continue;
+    int32_t left = (int32_t)(s.due[i] - nowMs);   // переживает переполнение millis
+    if (left <= 0) {
+      p.wake |= (1u << i);
+      continue;
+    }
+    if ((uint32_t)left < nearest) nearest = (uint32_t)left;
+  }
+
+  // кого будим — те сейчас станут заняты; пересмотр сразу после них
+  if (p.wake) {
+    p.waitMs = 0;
+    return p;
+  }
+
+  p.waitMs = nearest;
+  if (s.busy || s.keepRadio) return p;
+
+  if (nearest > PWR_WAKE_GUARD_MS + PWR_MIN_SLEEP_MS) {
+    p.sleepMs = nearest - PWR_WAKE_GUARD_MS;
+  }
+  return p;
+}
+
+void PowerMeterSlept(PowerMeter& m, uint32_t ms) {
+  m.sleptMs += ms;
+}
+
+bool PowerMeterRoll(PowerMeter& m, uint32_t nowMs) {
+  if (!m.started) {
+    m.started = true;
+    m.hourStartMs = nowMs;
+    m.sleptMs = 0;
+    return false;
+  }
+  uint32_t elapsed = nowMs - m.hourStartMs;
+  if (elapsed < PWR_METER_WINDOW_MS) return false;
+
+  // сон, захвативший границу, целиком уходит в закрываемый час
+  uint32_t slept = m.sleptMs < elapsed ? m.sleptMs : elapsed;
+  m.lastAwakeMs = elapsed - slept;
+  m.hourStartMs = nowMs;
+  m.sleptMs = 0;
+  return true;
+}
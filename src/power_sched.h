@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+
+// Логика планировщика сна без обращения к железу и к часам: время передаётся
+// параметром, поэтому на хосте её можно гонять виртуальными часами.
+//
+// Клиент (задача) либо занят — спать нельзя, — либо ждёт: до срока dueMs или
+// события без срока. Спим до ближайшего срока минус запас на пробуждение.
+
+static const uint8_t  PWR_MAX_CLIENTS = 8;
+static const uint32_t PWR_WAKE_GUARD_MS = 20;     // выход из light sleep + планировщик
+static const uint32_t PWR_MIN_SLEEP_MS  = 50;     // короче — дороже вход/выход, чем выигрыш
+static const uint32_t PWR_MAX_SLEEP_MS  = 60000;  // без сроков всё равно просыпаемся раз в минуту
+
+struct PowerSched {
+  uint8_t  busy;                      // маска занятых клиентов
+  uint8_t  timed;                     // маска ждущих со сроком
+  uint32_t due[PWR_MAX_CLIENTS];      // срок, millis
+  bool     keepRadio;                 // light sleep рвёт связь (WiFi STA): только ждём
+};
+
+struct PowerPlan {
+  uint8_t  wake;     // маска клиентов, чей срок наступил (разбудить, снять срок)
+  uint32_t sleepMs;  // 0 — не спать
+  uint32_t waitMs;   // если не спим: сколько ждать до следующего пересмотра
+};
+
+PowerPlan PowerSchedPlan(const PowerSched& s, uint32_t nowMs);
+
+// Учёт бодрствования по часам: сколько из последнего полного часа не спали.
+struct PowerMeter {
+  uint32_t hourStartMs;
+  uint32_t sleptMs;        // в текущем часе
+  uint32_t lastAwakeMs;    // за последний закрытый час
+  bool     started;
+};
+
+static const uint32_t PWR_METER_WINDOW_MS = 3600000;
+
+void PowerMeterSlept(PowerMeter& m, uint32_t ms);
+// true — час закрыт, lastAwakeMs обновлён
+bool PowerMeterRoll(PowerMeter& m, uint32_t nowMs);
@@ -4,18 +4,37 @@
 #include <FS.h>     
 #include <LittleFS.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "metrics.h"
  
 using namespace fs;
 static Preferences prefs;
+
+// Кольцо пишет стадия хранения, читают и сдвигают аплинк и /export — из разных задач.
+// Рекурсивный: составные операции (RingStoreLock) вызывают обычный API изнутри
+static SemaphoreHandle_t mtx = nullptr;
+
+struct RingLock {
+  RingLock()  { if (mtx) xSemaphoreTakeRecursive(mtx, portMAX_DELAY); }
+  ~RingLock() { if (mtx) xSemaphoreGiveRecursive(mtx); }
+};
 static String gPath;
 static size_t gFileSize = 0;
 
 static const uint32_t MAGIC = 0x52494E47; // 'RING'
-static const uint16_t VERSION = 1;
+static const uint16_t VERSION = 2;
 
-// выравнивание на 24 байта
+// выравнивание на 40 байт
 #pragma pack(push, 1)
 struct RecBin {
+  SampleRec r;
+  uint32_t  crc32;
+  uint8_t   pad[4]; // до 40
+};
+
+// формат v1 (одноканальные записи) — только для переноса старой очереди
+struct RecBinV1 {
   uint32_t ts;
   int32_t  current_mA;
   int32_t  power_dW;
@@ -39,6 +58,10 @@ static uint32_t crc32_simple(const uint8_t* data, size_t len) {
   return ~crc;
 }
 
+uint32_t RingStoreCrc32(const uint8_t* data, size_t len) {
+  return crc32_simple(data, len);
+}
+
 static uint32_t getU32(const char* key, uint32_t defv) { return prefs.getUInt(key, defv); }
 static void putU32(const char* key, uint32_t v) { prefs.putUInt(key, v); }
 
@@ -86,35 +109,149 @@ static bool ensureFileSized(const char* path, size_t sizeBytes) {
   return true;
 }
 
-bool RingStoreBegin(const char* path, size_t fileSizeBytes) {
+static void resetCounters() {
+  putU32("head", 0);
+  putU32("tail", 0);
+  putU32("full", 0);
+}
+
+// пустое кольцо v2 на месте gPath
+static bool createEmpty() {
+  File f = LittleFS.open(gPath, "w");
+  if (!f) return false;
+  f.seek(gFileSize - 1);
+  f.write((uint8_t)0);
+  writeHeader(f);
+  f.close();
+  return true;
+}
+
+// ===================== MIGRATION =====================
+// Очередь формата v1 не выбрасываем: её счётчики запоминаются под ключами v1*,
+// файл переименовывается в <path>.v1, новый создаётся заново, неотправленное
+// переписывается в него пачками (не влезет — остаются свежие).
+// Пока <path>.v1 существует, перенос не закончен: после сброса питания
+// RingStoreBegin начинает копирование заново с пустого кольца.
+static void copyFromV1(const String& old) {
+  uint32_t head  = getU32("v1head", 0);
+  uint32_t tail  = getU32("v1tail", 0);
+  uint32_t capV1 = getU32("v1cap", 0);
+
+  if (!createEmpty()) return;   // .v1 остаётся — повторим при следующем старте
+  resetCounters();
+
+  File src = LittleFS.open(old, "r");
+  uint32_t n = head - tail;
+  if (n > capV1) { tail = head - capV1; n = capV1; }
+  if (n > capacityRecs()) tail += n - capacityRecs();
+
+  size_t copied = 0;
+  SampleRec batch[8];
+  while (src && capV1 && tail != head) {
+    size_t k = 0;
+    for (; k < 8 && tail != head; tail++) {
+      RecBinV1 v{};
+      src.seek(16 + (tail % capV1) * sizeof(RecBinV1));
+      if (src.read((uint8_t*)&v, sizeof(v)) != sizeof(v)) { tail = head; break; }
+      if (crc32_simple((uint8_t*)&v, offsetof(RecBinV1, crc32)) != v.crc32) continue;
+      SampleRec& r = batch[k++];
+      r = SampleRec{};
+      r.ts = v.ts;
+      r.current_mA = v.current_mA;
+      r.power_dW = v.power_dW;
+      r.temp_cC = v.temp_cC;
+      r.flags = v.flags;
+    }
+    if (k && !RingStoreAppendBatch(batch, k)) break;
+    copied += k;
+  }
+  if (src) src.close();
+
+  LittleFS.remove(old);
+  prefs.remove("v1head");
+  prefs.remove("v1tail");
+  prefs.remove("v1cap");
+  Serial.printf("RingStore: %u records migrated from v1\n", (unsigned)copied);
+}
+
+// версия формата существующего файла; 0 — файла нет или заголовок чужой
+static uint16_t fileVersion(const char* path, uint32_t& cap) {
+  if (!LittleFS.exists(path)) return 0;
+  File f = LittleFS.open(path, "r");
+  if (!f) return 0;
+  uint32_t m = 0;
+  uint16_t ver = 0;
+  f.read((uint8_t*)&m, 4);
+  f.read((uint8_t*)&ver, 2);
+  f.seek(8);
+  f.read((uint8_t*)&cap, 4);
+  f.close();
+  return m == MAGIC ? ver : 0;
+}
+
+static void migrateV1(uint32_t capV1) {
+  String old = gPath + ".v1";
+  putU32("v1head", getU32("head", 0));
+  putU32("v1tail", getU32("tail", 0));
+  putU32("v1cap", capV1);
+
+  LittleFS.remove(old);
+  if (!capV1 || !LittleFS.rename(gPath, old)) {
+    // переносить нечего (или не вышло переименовать) — просто новое кольцо
+    if (createEmpty()) resetCounters();
+    prefs.remove("v1head");
+    prefs.remove("v1tail");
+    prefs.remove("v1cap");
+    return;
+  }
+  copyFromV1(old);
+}
+
+bool RingStoreBegin(const char* path, size_t fileSizeBytes, const char* nvsNamespace) {
     if (!LittleFS.begin(true)) {
   Serial.println("❌ LittleFS mount failed even after format");
   return false;
 }
+  if (!mtx) mtx = xSemaphoreCreateRecursiveMutex();
+  RingLock lock;
   gPath = path;
   gFileSize = fileSizeBytes;
 
   if (gFileSize < dataStart() + REC_SIZE * 16) return false; // минимум
 
-  if (!ensureFileSized(path, fileSizeBytes)) return false;
+  prefs.end();   // повторный Begin (стенд PERF_BENCH) — на другое кольцо
+  prefs.begin(nvsNamespace, false);
 
-  prefs.begin("ring", false);
+  // перенос v1 прервали — продолжаем, файл v2 при этом создаётся заново
+  String old = gPath + ".v1";
+  if (LittleFS.exists(old)) {
+    copyFromV1(old);
+    return !LittleFS.exists(old);
+  }
+
+  // v1 — до подгонки размера: длина файла v1 другая, ensureFileSized его бы пересоздал
+  uint32_t capV1 = 0;
+  if (fileVersion(path, capV1) == 1) {
+    migrateV1(capV1);
+    return !LittleFS.exists(old);
+  }
+
+  if (!ensureFileSized(path, fileSizeBytes)) return false;
 
   File f = LittleFS.open(path, "r+");
   if (!f) return false;
 
   // проверим header
   uint32_t m = 0;
+  uint16_t ver = 0;
   f.read((uint8_t*)&m, 4);
-  if (m != MAGIC) {
+  f.read((uint8_t*)&ver, 2);
+  if (m != MAGIC || ver != VERSION) {
     // init
     f.seek(0);
     writeHeader(f);
-    putU32("head", 0);
-    putU32("tail", 0);
-    putU32("full", 0);
+    resetCounters();
   }
-
   f.close();
   return true;
 }
@@ -122,6 +259,7 @@ bool RingStoreBegin(const char* path, size_t fileSizeBytes) {
 static bool isFull() { return getU32("full", 0) != 0; }
 
 size_t RingStoreCountApprox() {
+  RingLock lock;
   uint32_t head = getU32("head", 0);
   uint32_t tail = getU32("tail", 0);
   if (!isFull()) {
@@ -133,33 +271,67 @@ size_t RingStoreCountApprox() {
   }
 }
 
+uint32_t RingStoreTail() {
+  RingLock lock;
+  return getU32("tail", 0);
+}
+
 bool RingStoreAppend(const SampleRec& r) {
+  return RingStoreAppendBatch(&r, 1);
+}
+
+// пачка: одно открытие файла, запись подряд до конца кольца (не больше двух кусков),
+// один flush и одна пара записей head/tail в NVS — вместо n штук каждого
+bool RingStoreAppendBatch(const SampleRec* recs, size_t n) {
+  if (!n) return true;
+  MetricScope m(MH_RING_APPEND);
+  RingLock lock;
 
   File f = LittleFS.open(gPath, "r+");
-  if (!f) return false;
+  if (!f) {
+    MetricCount(MC_RING_APPEND_FAIL);
+    return false;
+  }
 
   uint32_t head = getU32("head", 0);
   uint32_t tail = getU32("tail", 0);
   uint32_t cap  = capacityRecs();
+  if (n > cap) {
+    // больше кольца всё равно не удержать — оставляем самые свежие
+    recs += n - cap;
+    n = cap;
+  }
 
-  RecBin rb{};
-  rb.ts = r.ts;
-  rb.current_mA = r.current_mA;
-  rb.power_dW = r.power_dW;
-  rb.temp_cC = r.temp_cC;
-  rb.flags = r.flags;
-
-  rb.crc32 = crc32_simple((uint8_t*)&rb, offsetof(RecBin, crc32));
-
-  uint32_t idx = head % cap;
-  uint32_t off = dataOffset(idx);
+  static const size_t CHUNK = 8;
+  RecBin buf[CHUNK];
+  bool ok = true;
+  size_t done = 0;
+  while (done < n && ok) {
+    uint32_t idx = (head + done) % cap;
+    size_t k = min(CHUNK, n - done);
+    k = min(k, (size_t)(cap - idx));   // кусок не переходит через конец кольца
+
+    for (size_t i = 0; i < k; i++) {
+      const SampleRec& r = recs[done + i];
+      RecBin& rb = buf[i];
+      rb = RecBin{};
+      rb.r = r;
+      rb.crc32 = crc32_simple((uint8_t*)&rb, offsetof(RecBin, crc32));
+    }
 
-  f.seek(off);
-  f.write((uint8_t*)&rb, REC_SIZE);
+    f.seek(dataOffset(idx));
+    ok = f.write((uint8_t*)buf, k * REC_SIZE) == k * REC_SIZE;
+    done += k;
+  }
   f.flush();
   f.close();
 
-  head++;
+  if (!ok) {
+    MetricCount(MC_RING_APPEND_FAIL);
+    return false;
+  }
+
+  head += n;
 
   // если переполнили буфер — двигаем tail
   if (head - tail > cap) {
@@ -181,10 +353,12 @@ static bool readOne(File& f, uint32_t idx, RecBin& out) {
   return (crc == out.crc32);
 }
 
-size_t RingStoreReadBatch(std::vector<SampleRec>& out, size_t maxItems) {
+size_t RingStorePeek(size_t skip, std::vector<SampleRec>& out, size_t maxSlots) {
+  MetricScope m(MH_RING_PEEK);
+  RingLock lock;
   out.clear();
   size_t count = RingStoreCountApprox();
-  if (count == 0) return 0;
+  if (skip >= count) return 0;
 
   uint32_t tail = getU32("tail", 0);
   uint32_t cap  = capacityRecs();
@@ -192,28 +366,28 @@ size_t RingStoreReadBatch(std::vector<SampleRec>& out, size_t maxItems) {
   File f = LittleFS.open(gPath, "r");
   if (!f) return 0;
 
-  size_t n = min(maxItems, count);
+  size_t n = min(maxSlots, count - skip);
   for (size_t i = 0; i < n; i++) {
     RecBin rb{};
-    uint32_t idx = (tail + i) % cap;
+    uint32_t idx = (tail + skip + i) % cap;
     if (!readOne(f, idx, rb)) {
-      // если запись битая — пропустим её, но лучше сдвинуть tail позже (можно усилить логику)
+      // битая запись: слот считаем просмотренным, чтобы его можно было сдвинуть вместе с пакетом
       continue;
     }
-    SampleRec s{};
-    s.ts = rb.ts;
-    s.current_mA = rb.current_mA;
-    s.power_dW = rb.power_dW;
-    s.temp_cC = rb.temp_cC;
-    s.flags = rb.flags;
-    out.push_back(s);
+    out.push_back(rb.r);
   }
 
   f.close();
+  return n;
+}
+
+size_t RingStoreReadBatch(std::vector<SampleRec>& out, size_t maxItems) {
+  RingStorePeek(0, out, maxItems);
   return out.size();
 }
 
 bool RingStoreDrop(size_t count) {
+  RingLock lock;
   size_t have = RingStoreCountApprox();
   if (count > have) count = have;
 
@@ -234,3 +408,11 @@ bool RingStoreDrop(size_t count) {
   putU32("tail", tail);
   return true;
 }
+
+void RingStoreLock() {
+  if (mtx) xSemaphoreTakeRecursive(mtx, portMAX_DELAY);
+}
+
+void RingStoreUnlock() {
+  if (mtx) xSemaphoreGiveRecursive(mtx);
+}
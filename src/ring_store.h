@@ -2,16 +2,35 @@
 #include <Arduino.h>
 #include <vector>
 
+static const uint8_t REC_CURRENT_CH = 4;   // каналов тока в записи
+static const uint8_t REC_TEMP_CH    = 4;   // датчиков температуры в записи
+
+// формат v2: поля v1 — сводка (сумма по фазам, датчик 0), за ними — по каналам
 struct SampleRec {
   uint32_t ts;
-  int32_t  current_mA;  // Current * 1000
-  int32_t  power_dW;    // Power * 10
-  int16_t  temp_cC;     // temp * 100
+  int32_t  current_mA;  // Current * 1000, сумма по фазам
+  int32_t  power_dW;    // Power * 10, сумма по фазам
+  int16_t  temp_cC;     // temp * 100, датчик 0 (по нему — нагреватель)
   uint16_t flags;       // bit0=heater
+  int16_t  ch_cA[REC_CURRENT_CH];        // ток по каналам, A * 100
+  int16_t  tempX_cC[REC_TEMP_CH - 1];    // датчики 1.., temp * 100
+  uint8_t  nCurrent;    // заполнено каналов тока (0 — запись v1)
+  uint8_t  nTemp;       // заполнено датчиков, включая 0
 };
+static_assert(sizeof(SampleRec) == 32, "SampleRec layout");
 
-bool RingStoreBegin(const char* path, size_t fileSizeBytes); // создаёт файл/структуры
+// создаёт файл/структуры; head/tail — в NVS nvsNamespace (у каждого кольца свой)
+bool RingStoreBegin(const char* path, size_t fileSizeBytes, const char* nvsNamespace = "ring");
 bool RingStoreAppend(const SampleRec& r);                    // пишет, при переполнении затирает старое
+bool RingStoreAppendBatch(const SampleRec* recs, size_t n);  // то же пачкой: один flush и одно обновление NVS
 size_t RingStoreReadBatch(std::vector<SampleRec>& out, size_t maxItems); // читает от tail, но НЕ удаляет
+size_t RingStorePeek(size_t skip, std::vector<SampleRec>& out, size_t maxSlots); // от tail+skip; возвращает число просмотренных слотов (битые не попадают в out)
 bool RingStoreDrop(size_t count);                            // удалить (сдвинуть tail) после успешной отправки
 size_t RingStoreCountApprox();                               // приблизительно сколько записей в очереди
+uint32_t RingStoreTail();                                    // абсолютный индекс tail (растёт, не по модулю)
+uint32_t RingStoreCrc32(const uint8_t* data, size_t len);    // CRC записи (PERF_BENCH, RTC-буфер конвейера)
+
+// каждый вызов выше атомарен сам по себе; составная операция (tail -> peek -> drop)
+// из одной задачи держит кольцо явно. Рекурсивно: внутри можно звать API выше
+void RingStoreLock();
+void RingStoreUnlock();
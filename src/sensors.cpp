@@ -1,12 +1,17 @@
 #include "sensors.h"
 #include <Wire.h>
-#include "EmonLib.h"
 #include "RTClib.h"
 #include <OneWire.h>
 #include <DallasTemperature.h>
-#include "ring_store.h"
-#include <Preferences.h>
-static EnergyMonitor energyMonitor;
+#include "current_sampler.h"
+#include "heater.h"
+#include "pipeline.h"
+#include "power.h"
+#include "config_store.h"
+#include "metrics.h"
+#include "dlog.h"
+static_assert(REC_CURRENT_CH == CT_MAX_CHANNELS, "record channels");
+
   RTC_DS3231 rtc;
 bool rtcOk = false;
 // DS18B20 moved off GPIO4 to avoid conflict with WIFI_CFG_PIN
@@ -14,71 +19,182 @@ static const uint8_t ONE_WIRE_BUS = 27;
 static OneWire oneWire(ONE_WIRE_BUS);
 static DallasTemperature ds18b20(&oneWire);
 
-static Preferences prefs;
-static float Voltage = 220.0;
-
-static void loadVoltage() {
-  prefs.begin("cfg", true);
-  Voltage = prefs.getFloat("voltage", 220.0);
-  prefs.end();
+// датчики на шине — по порядку поиска (по адресу), 0-й управляет нагревателем
+static DeviceAddress probeAddr[REC_TEMP_CH];
+static uint8_t probeCount = 0;
+static bool probeRescan = true;
+
+static volatile float Voltage = 220.0;
+static volatile uint8_t ctChannels = 1;
+static volatile bool ctNeutral = false;
+
+// калибровка из config_store; при сохранении — сразу в работу
+static void applyCalibration(const Config& c) {
+  Voltage = c.voltage;
+  for (uint8_t i = 0; i < CT_MAX_CHANNELS; i++) CurrentSamplerSetCal(i, c.ct[i]);
+  ctNeutral = c.ctNeutral;
+  ctChannels = c.ctChannels;   // число каналов sensorsTask меняет между окнами
 }
-static const float irmsOffset = 1.0;
-static const float currentThreshold = 0.10;
 
-static const int HEATER_PIN = 25;
-static const float TEMP_ON  = -5.0;
-static const float TEMP_OFF = 0.0;
+static void onCalibrationChanged(const Config& c, uint32_t, void*) {
+  applyCalibration(c);
+}
 
-static bool heaterState = false;
+static void loadCalibration() {
+  ConfigSnapshot c = ConfigGet();
+  applyCalibration(*c);
+  CurrentSamplerBegin(c->ctChannels);
+  ConfigSubscribe(onCalibrationChanged, CFG_CH_VOLTAGE | CFG_CH_CT);
+}
+static const float currentThreshold = 0.10;
 
 static SensorData latest{};
 static bool hasData = false;
 static SemaphoreHandle_t dataMtx;
 
-static void heaterControl(float tempC) {
-  if (!heaterState && tempC <= TEMP_ON) {
-    digitalWrite(HEATER_PIN, HIGH);
-    heaterState = true;
-  } else if (heaterState && tempC >= TEMP_OFF) {
-    digitalWrite(HEATER_PIN, LOW);
-    heaterState = false;
+struct Subscriber { TaskHandle_t task; uint32_t bits; };
+static const size_t MAX_SUBSCRIBERS = 4;
+static Subscriber subs[MAX_SUBSCRIBERS];
+static volatile size_t subsCount = 0;
+
+static const uint32_t ACQ_PERIOD_MS  = 10000;  // окно сбора
+static const uint32_t STORE_PERIOD_MS = 30000; // запись в кольцо
+static TaskHandle_t sensorsTaskHandle = nullptr;
+
+// срок окна наступил, пока спали: тики стояли, будит планировщик питания
+static void wakeSensors() {
+  if (sensorsTaskHandle) xTaskNotifyGive(sensorsTaskHandle);
+}
+
+// ждём до dueMs по millis(); в обычном режиме хватает таймаута, при сне — wakeSensors()
+static void waitUntil(uint32_t dueMs) {
+  PowerIdleUntil(PWR_ACQ, dueMs);
+  int32_t left;
+  while ((left = (int32_t)(dueMs - millis())) > 0) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(left));
   }
+  PowerBusy(PWR_ACQ);
 }
 
 void SensorsInit() {
-  pinMode(HEATER_PIN, OUTPUT);
-  digitalWrite(HEATER_PIN, LOW);
-  heaterState = false;
-loadVoltage();
+  HeaterBegin();
   Wire.begin();
 rtcOk = rtc.begin();
 analogReadResolution(12);
-  // токовый датчик
-energyMonitor.current(34, 50);
+  // токовые датчики: общий планировщик выборок
+  loadCalibration();
 
-  // температура
+  // температура: преобразование идёт, пока снимается ток
   ds18b20.begin();
+  ds18b20.setWaitForConversion(false);
 
   dataMtx = xSemaphoreCreateMutex();
 }
 
+// ===================== TEMPERATURE =====================
+// поиск на шине — при старте и, пока не нашли ни одного, каждый цикл. Пропавший
+// позже датчик остаётся на своём месте с -127: переиндексация увела бы нагреватель
+// на чужой датчик
+static void probesScan() {
+  ds18b20.begin();
+  ds18b20.setWaitForConversion(false);
+  uint8_t n = min((uint8_t)ds18b20.getDeviceCount(), REC_TEMP_CH);
+  probeCount = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (ds18b20.getAddress(probeAddr[probeCount], i)) probeCount++;
+  }
+  probeRescan = false;
+  DLOGI("ds18b20: %u probes", (unsigned)probeCount);
+}
+
+// все датчики одной командой: преобразуют параллельно
+static uint32_t probesRequest() {
+  if (probeRescan) probesScan();
+  ds18b20.requestTemperatures();
+  return millis() + ds18b20.millisToWaitForConversion(ds18b20.getResolution());
+}
+
+// датчика нет или не ответил — -127 (как DEVICE_DISCONNECTED_C)
+static float probeRead(uint8_t i) {
+  if (i >= probeCount) {
+    probeRescan = true;
+    return -127.0;
+  }
+  float t = ds18b20.getTempC(probeAddr[i]);
+  return t == DEVICE_DISCONNECTED_C ? -127.0 : t;
+}
+
+// остальные датчики — после решения термостата; хотя бы один канал всегда есть
+static uint8_t probesReadRest(float* out) {
+  for (uint8_t i = 1; i < probeCount; i++) out[i] = probeRead(i);
+  return probeCount ? probeCount : 1;
+}
+
 static void sensorsTask(void* pv) {
   (void)pv;
   uint32_t lastStoreMs = 0;
+  bool lastTempFault = false;
+  bool lastHeater = false;
+  sensorsTaskHandle = xTaskGetCurrentTaskHandle();
+  MetricsTrackTask(sensorsTaskHandle, "sensors");
+  PowerRegister(PWR_ACQ, wakeSensors);
   while (true) {
-    // Current / Power
-    double rawI = energyMonitor.calcIrms(1480); // 1480 samples = ~3 сек при 50 Гц
-    double current = rawI - irmsOffset;
-    if (current < currentThreshold) current = 0.0;
-    double power = current * Voltage;
-Serial.print(":");Serial.println(rawI);Serial.println(current);
-Serial.println(power);
-    // Temp
-    ds18b20.requestTemperatures();
-    float tempC = ds18b20.getTempCByIndex(0);
-    if (tempC == DEVICE_DISCONNECTED_C) tempC = -127.0;
-
-    heaterControl(tempC);
+    uint32_t cycleMs = millis();
+    uint32_t readT0 = micros();
+    if (ctChannels != CurrentSamplerChannels()) CurrentSamplerBegin(ctChannels);
+
+    // Temp: запрос всем датчикам — преобразуются, пока снимается ток
+    uint32_t tempReadyMs = probesRequest();
+
+    // Current / Power: одно окно по всем каналам вперемешку
+    CtWindow w;
+    CurrentSamplerRun(w);
+    uint8_t nCh = CurrentSamplerChannels();
+    uint8_t phases = ctNeutral && nCh > 1 ? nCh - 1 : nCh;   // нейтраль в сумму не входит
+    double current = 0, power = 0;
+    for (uint8_t i = 0; i < nCh; i++) {
+      if (w.irmsA[i] < currentThreshold) w.irmsA[i] = 0.0;
+      if (i < phases) {
+        current += w.irmsA[i];
+        power += w.irmsA[i] * Voltage;
+      }
+    }
+    DLOGD("Irms ch=%u n=%u late=%u I=%.3f P=%.1f", (unsigned)nCh, (unsigned)w.samples,
+          (unsigned)w.late, current, power);
+
+    int32_t left = (int32_t)(tempReadyMs - millis());
+    if (left > 0) vTaskDelay(pdMS_TO_TICKS(left));
+    // датчик 0 — первым: термостат (выше по приоритету) решает сразу, не дожидаясь
+    // чтения остальных датчиков (каждый — ~10 мс на шине 1-Wire)
+    uint32_t tempT0 = micros();
+    float temps[REC_TEMP_CH];
+    temps[0] = probeRead(0);
+    float tempC = temps[0];
+    HeaterUpdate(tempC, tempT0);
+    uint8_t nTemp = probesReadRest(temps);
+    MetricObserveUs(MH_SENSOR_READ, micros() - readT0);
+    MetricCount(MC_SENSOR_CYCLES);
+    bool heaterState = HeaterOn();
+
+    uint32_t ts = 0;
+    if (rtcOk) {
+      ts = rtc.now().unixtime();
+    } else {
+      // fallback — если RTC недоступны (лучше чем 0): для локального порядка записей;
+      // сервер хранит ts раньше 2020 с пометкой ts_bad
+      ts = millis() / 1000;
+    }
+
+    SampleRec rec{};
+    rec.ts = ts;
+    rec.current_mA = (int32_t)(current * 1000);
+    rec.power_dW   = (int32_t)(power);
+    rec.temp_cC    = (int16_t)(tempC * 100);
+    rec.flags      = heaterState ? 1 : 0;
+    rec.nCurrent   = nCh;
+    rec.nTemp      = nTemp;
+    for (uint8_t i = 0; i < nCh; i++) rec.ch_cA[i] = (int16_t)min(w.irmsA[i] * 100.0f, 32767.0f);
+    for (uint8_t i = 1; i < nTemp; i++) rec.tempX_cC[i - 1] = (int16_t)(temps[i] * 100);
 
     // publish
     if (xSemaphoreTake(dataMtx, pdMS_TO_TICKS(30)) == pdTRUE) {
@@ -86,49 +202,41 @@ Serial.println(power);
       latest.currentA = current;
       latest.powerW = power;
       latest.heaterState = heaterState;
-    uint32_t ts = 0;
-
-if (rtcOk) {
-  ts = rtc.now().unixtime();
-} else {
-  ts = millis() / 1000;
-}
-
-latest.ts = ts;
+      latest.ts = ts;
+      latest.nCurrent = nCh;
+      memcpy(latest.currentChA, w.irmsA, sizeof(latest.currentChA));
+      latest.nTemp = nTemp;
+      memcpy(latest.tempChC, temps, nTemp * sizeof(float));
+      latest.rec = rec;
       hasData = true;
       xSemaphoreGive(dataMtx);
+
+      for (size_t i = 0; i < subsCount; i++) xTaskNotify(subs[i].task, subs[i].bits, eSetBits);
     }
+    // тревога: пропал/вернулся датчик температуры или переключился нагреватель —
+    // пишем вне очереди и будим аплинк, не дожидаясь пачки
+    bool tempFault = false;
+    for (uint8_t i = 0; i < nTemp; i++) tempFault |= temps[i] == -127.0;
+    bool alarm = tempFault != lastTempFault || heaterState != lastHeater;
+    lastTempFault = tempFault;
+    lastHeater = heaterState;
+
  // ---- запись в кольцо раз в 30 сек ----
-    if (millis() - lastStoreMs >= 30000) {
+    if (alarm || millis() - lastStoreMs >= STORE_PERIOD_MS) {
       lastStoreMs = millis();
 
-      // RTC время (реальные секунды)
-      uint32_t ts = 0;
-      if (rtc.begin()) {
-        ts = (uint32_t)rtc.now().unixtime();
-      } else {
-        // fallback — если RTC недоступны (лучше чем 0)
-        ts = (uint32_t)(millis() / 1000);
-      }
-    // === запись в кольцо ===
-    SampleRec rec{};
-    rec.ts =ts;  // или RTC unix time
-    rec.current_mA = (int32_t)(current * 1000);
-    rec.power_dW   = (int32_t)(power);
-    rec.temp_cC    = (int16_t)(tempC * 100);
-    rec.flags      = heaterState ? 1 : 0;
-
-   bool ok = RingStoreAppend(rec);
-        Serial.printf("RingStoreAppend: %s ts=%u I=%ldmA P=%lddW T=%dcC\n",
-                    ok ? "OK" : "FAIL", rec.ts, rec.current_mA, rec.power_dW, rec.temp_cC);
+    // === в конвейер: запись в кольцо делает storeTask на core 0 ===
+    if (alarm) DLOGW("sensor alarm: T=%dcC heater=%d", rec.temp_cC, (int)heaterState);
+    if (!PipelinePublish(rec, alarm)) DLOGW("pipeline full, sample dropped ts=%u", rec.ts);
     }
-    vTaskDelay(pdMS_TO_TICKS(10000)); // 1 минута
+    waitUntil(cycleMs + ACQ_PERIOD_MS);
   }
 }
 
 
 void SensorsStartTasks() {
-  xTaskCreatePinnedToCore(sensorsTask, "sensorsTask", 4096, nullptr, 2, nullptr, 1);
+  HeaterStartTask();
+  xTaskCreatePinnedToCore(sensorsTask, "sensorsTask", 4096, nullptr, PRIO_ACQ, nullptr, CORE_ACQ);
 }
 
 bool SensorsGetLatest(SensorData& out) {
@@ -138,3 +246,10 @@ bool SensorsGetLatest(SensorData& out) {
   xSemaphoreGive(dataMtx);
   return true;
 }
+
+bool SensorsSubscribe(TaskHandle_t task, uint32_t notifyBits) {
+  if (!task || subsCount >= MAX_SUBSCRIBERS) return false;
+  subs[subsCount] = { task, notifyBits };
+  subsCount++;   // запись до инкремента: sensorsTask видит только готовые слоты
+  return true;
+}
@@ -1,15 +1,26 @@
 #pragma once
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "ring_store.h"
+#include "current_sampler.h"
 
 struct SensorData {
-  float tempC;
-  double currentA;
+  float tempC;         // датчик 0
+  double currentA;     // сумма по фазам
   double powerW;
   bool heaterState;
   uint32_t tsMs;
   uint32_t ts;
+  uint8_t nCurrent;
+  float currentChA[CT_MAX_CHANNELS];
+  uint8_t nTemp;
+  float tempChC[REC_TEMP_CH];
+  SampleRec rec;       // тот же замер в формате записи
 };
 
 void SensorsInit();
 void SensorsStartTasks();
 bool SensorsGetLatest(SensorData& out); // non-blocking (returns false if no data yet)
+// после каждого нового замера задаче приходит xTaskNotify(task, notifyBits, eSetBits)
+bool SensorsSubscribe(TaskHandle_t task, uint32_t notifyBits);
@@ -0,0 +1,37 @@
+#include "seq_lease.h"
+#include <Preferences.h>
+
+static Preferences prefs;      // namespace "uplink"
+static uint32_t seqCeiling = 0;
+
+// потолок в RAM сдвигается только после записи: не записалось (NVS полна/сбой) —
+// продлим на следующей выдаче, а не будем раздавать номера сверх сохранённого
+static void persistCeiling(uint32_t ceiling) {
+  prefs.begin("uplink", false);
+  bool ok = prefs.putUInt("seq", ceiling) == sizeof(uint32_t);
+  prefs.end();
+  if (ok) seqCeiling = ceiling;
+}
+
+uint32_t SeqLeaseBegin() {
+  prefs.begin("uplink", true);
+  uint32_t seq = prefs.getUInt("seq", 1);
+  prefs.end();
+
+  seqCeiling = 0;
+  persistCeiling(seq + SEQ_LEASE);
+  return seq;
+}
+
+void SeqLeaseSave(uint32_t seq) {
+  if (seq < seqCeiling) return;
+  persistCeiling(seq + SEQ_LEASE);
+}
+
+// seq под новое содержимое занимается до отправки: после отказа следующая
+// попытка соберёт новый payload (другой nonce, свежие данные) — и с новым seq
+uint32_t SeqTake(uint32_t& seq) {
+  uint32_t s = seq++;
+  SeqLeaseSave(seq);
+  return s;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <Arduino.h>
+
+// Номера seq аплинка арендуются блоками: в NVS лежит только потолок блока,
+// номера выдаются из RAM. Инвариант: любой выданный seq < сохранённого потолка,
+// поэтому после перезагрузки (в т.ч. по питанию) продолжаем с потолка и не повторяемся.
+static const uint32_t SEQ_LEASE = 64;
+
+uint32_t SeqLeaseBegin();              // первый seq после загрузки (арендует новый блок)
+void     SeqLeaseSave(uint32_t seq);   // seq — следующий к выдаче; продлить аренду до его использования
+uint32_t SeqTake(uint32_t& seq);       // выдать seq и сдвинуть счётчик
@@ -0,0 +1,87 @@
+#include "time_sync.h"
+#include <RTClib.h>
+#include "dlog.h"
+
+extern RTC_DS3231 rtc;
+extern bool rtcOk;
+
+static const uint8_t  WINDOW = 4;                         // выборок для min-RTT фильтра
+static const int32_t  ADJUST_THRESHOLD_MS = 2000;         // точность RTC/сервера — секунда
+static const uint32_t MAX_RTT_MS = 10000;                 // такие выборки слишком грубые
+static const uint32_t MAX_AGE_MS = 6UL * 3600UL * 1000UL; // без выборок дольше — явный sync
+static const uint32_t DRIFT_MIN_SPAN_MS = 3600UL * 1000UL;
+
+struct TimeSample {
+  uint32_t rttMs;
+  int32_t  offsetMs;
+};
+
+static TimeSample samples[WINDOW];
+static uint8_t  nSamples = 0;
+static uint8_t  nextSample = 0;
+static uint32_t lastSampleMs = 0;
+static bool     haveSample = false;
+
+static int32_t  lastOffsetMs = 0;
+static uint32_t lastAdjustMs = 0;  // после правки остаточное смещение ~0
+static float    driftPpm = 0;
+
+static const TimeSample& bestSample() {
+  uint8_t best = 0;
+  for (uint8_t i = 1; i < nSamples; i++) {
+    if (samples[i].rttMs < samples[best].rttMs) best = i;
+  }
+  return samples[best];
+}
+
+void TimeSyncSample(uint32_t sentMs, uint32_t recvMs, uint32_t serverTs) {
+  uint32_t rtt = recvMs - sentMs;
+  if (!serverTs || rtt > MAX_RTT_MS) return;
+
+  lastSampleMs = recvMs;
+  haveSample = true;
+  if (!rtcOk) return;
+
+  uint32_t local = rtc.now().unixtime();
+  int64_t off = ((int64_t)serverTs - (int64_t)local) * 1000 + rtt / 2;
+  if (off > INT32_MAX) off = INT32_MAX;
+  if (off < INT32_MIN) off = INT32_MIN;
+
+  samples[nextSample] = { rtt, (int32_t)off };
+  nextSample = (nextSample + 1) % WINDOW;
+  if (nSamples < WINDOW) nSamples++;
+
+  lastOffsetMs = bestSample().offsetMs;
+
+  // уход RTC с момента последней правки
+  uint32_t span = recvMs - lastAdjustMs;
+  if (lastAdjustMs && span >= DRIFT_MIN_SPAN_MS) {
+    float ppm = (float)lastOffsetMs * 1e6f / (float)span;
+    driftPpm = driftPpm ? driftPpm * 0.75f + ppm * 0.25f : ppm;
+  }
+
+  if (abs(lastOffsetMs) < ADJUST_THRESHOLD_MS) return;
+
+  int32_t corr = (lastOffsetMs + (lastOffsetMs > 0 ? 500 : -500)) / 1000;
+  DLOGI("RTC adjust %+ld s (rtt=%u ms, drift=%.1f ppm)",
+        (long)corr, (unsigned)bestSample().rttMs, driftPpm);
+  rtc.adjust(DateTime(rtc.now().unixtime() + corr));
+
+  // старые выборки измерены до правки
+  nSamples = 0;
+  nextSample = 0;
+  lastOffsetMs = 0;
+  lastAdjustMs = recvMs ? recvMs : 1;
+}
+
+bool TimeSyncDue() {
+  return !haveSample || (millis() - lastSampleMs) > MAX_AGE_MS;
+}
+
+int32_t TimeSyncOffsetMs() {
+  return lastOffsetMs;
+}
+
+float TimeSyncDriftPpm() {
+  return driftPpm;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <Arduino.h>
+
+// Подстройка RTC по времени сервера, пришедшему в обычных ответах
+// (/data, /register: поле "ts" или заголовок Date), без отдельного /sync_time.
+// NTP-подобно: offset = server - (local_recv - rtt/2), из последних выборок
+// берётся с минимальным RTT; RTC правится только при |offset| >= порога.
+void TimeSyncSample(uint32_t sentMs, uint32_t recvMs, uint32_t serverTs);
+bool TimeSyncDue();          // давно не было ни одной выборки — нужен явный /sync_time
+int32_t TimeSyncOffsetMs();  // последняя оценка смещения (server - RTC)
+float TimeSyncDriftPpm();    // оценка ухода RTC, ppm (+ = RTC отстаёт)
@@ -0,0 +1,28 @@
+#include "transport.h"
+#include <vector>
+
+static std::vector<Transport*> transports;
+
+void TransportAdd(Transport* t) {
+  if (t) transports.push_back(t);
+}
+
+static uint32_t effectiveRate(const Transport* t) {
+  return t->rateBps ? t->rateBps : t->priorBps;
+}
+
+Transport* TransportSelect() {
+  Transport* best = nullptr;
+  for (Transport* t : transports) {
+    if (!t->linkUp()) continue;
+    if (!best || effectiveRate(t) > effectiveRate(best)) best = t;
+  }
+  return best;
+}
+
+void TransportReport(Transport* t, size_t bytes, uint32_t us) {
+  if (!t || !bytes) return;
+  uint64_t bps = (uint64_t)bytes * 1000000 / (us ? us : 1);
+  if (bps > UINT32_MAX) bps = UINT32_MAX;
+  t->rateBps = t->rateBps ? (t->rateBps * 3 + bps) / 4 : bps;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+
+// Канал аплинка под HTTP-слоем: GSM (GPRS), Ethernet (W5x00), WiFi STA.
+// Выбор — среди поднятых по измеренной пропускной способности (до первого
+// замера — по априорной оценке). Выбор делается на каждое соединение, так что
+// переключение не теряет данные: из кольца удаляется только подтверждённое.
+class Transport {
+public:
+  virtual ~Transport() {}
+  virtual const char* name() const = 0;
+  virtual bool begin() = 0;      // поднять интерфейс (недолго блокирует)
+  virtual bool linkUp() = 0;     // можно открывать соединение
+  virtual bool resolve(const String& host, String& ip) = 0;
+  virtual Client& client() = 0;
+
+  // датаграммы (режим UDP-аплинка); по умолчанию не поддерживаются
+  virtual bool udpOpen(const String& /*ip*/, uint16_t /*port*/) { return false; }
+  virtual bool udpSend(const uint8_t* /*data*/, size_t /*len*/) { return false; }
+  virtual int  udpRecv(uint8_t* /*buf*/, size_t /*maxLen*/) { return -1; } // сколько прочитано, 0 — пока ничего
+  virtual void udpClose() {}
+
+  uint32_t priorBps = 0;  // априорная скорость
+  uint32_t rateBps = 0;   // EWMA по реальным обменам, 0 — ещё не мерили
+};
+
+void TransportAdd(Transport* t);
+Transport* TransportSelect();                             // лучший поднятый или nullptr
+// замер обмена: объём и чистое время передачи, мкс (запись запроса + приход ответа,
+// без ожидания сервера — иначе на коротких обменах мерилась бы задержка, а не скорость)
+void TransportReport(Transport* t, size_t bytes, uint32_t us);
+
+// каналы на железе — transport_links.cpp; GSM — в gsm_uplink.cpp
+// Ethernet W5x00 по SPI: -D UPLINK_ETHERNET=1 (CS — ETH_CS_PIN)
+Transport* TransportEthernet();
+// WiFi STA: один на устройство. begin() с новыми ssid/pass переподключает,
+// с пустым ssid выключает радио и возвращает false
+Transport* TransportWifiSta(const String& ssid, const String& pass);
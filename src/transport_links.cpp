@@ -0,0 +1,179 @@
+#include "transport.h"
+#include <Udp.h>
+#include <WiFi.h>
+
+#ifndef UPLINK_ETHERNET
+#define UPLINK_ETHERNET 0
+#endif
+#ifndef ETH_CS_PIN
+#define ETH_CS_PIN 5
+#endif
+
+#if UPLINK_ETHERNET
+#include <SPI.h>
+#include <Ethernet.h>
+#include <Dns.h>
+#endif
+
+// ===================== UDP =====================
+// датаграммы поверх Arduino UDP (WiFiUDP / EthernetUDP)
+class UdpChannel {
+public:
+  explicit UdpChannel(UDP& u) : udp(u) {}
+
+  bool open(const String& ip, uint16_t port) {
+    close();
+    if (!addr.fromString(ip.c_str()) || !udp.begin(0)) return false;
+    dstPort = port;
+    active = true;
+    return true;
+  }
+
+  bool send(const uint8_t* data, size_t len) {
+    if (!active || !udp.beginPacket(addr, dstPort)) return false;
+    udp.write(data, len);
+    return udp.endPacket() == 1;
+  }
+
+  int recv(uint8_t* buf, size_t maxLen) {
+    if (!active) return -1;
+    if (udp.parsePacket() <= 0) return 0;
+    return udp.read(buf, maxLen);
+  }
+
+  void close() {
+    if (active) udp.stop();
+    active = false;
+  }
+
+private:
+  UDP& udp;
+  IPAddress addr;
+  uint16_t dstPort = 0;
+  bool active = false;
+};
+
+// ===================== ETHERNET =====================
+#if UPLINK_ETHERNET
+class EthernetTransport : public Transport {
+public:
+  EthernetTransport() { priorBps = 500000; }
+
+  const char* name() const override { return "eth"; }
+
+  bool begin() override {
+    Ethernet.init(ETH_CS_PIN);
+
+    // MAC Ethernet у ESP32 — базовый + 3
+    uint64_t efuse = ESP.getEfuseMac();
+    uint8_t mac[6];
+    for (int i = 0; i < 6; i++) mac[i] = (uint8_t)(efuse >> (8 * i));
+    mac[5] += 3;
+
+    if (!Ethernet.begin(mac, 8000, 2000)) {
+      hw = Ethernet.hardwareStatus() != EthernetNoHardware;
+      Serial.println(hw ? "ETH: DHCP failed" : "ETH: no W5x00 found");
+      return false;
+    }
+    hw = true;
+    Serial.print("ETH IP: ");
+    Serial.println(Ethernet.localIP());
+    return true;
+  }
+
+  bool linkUp() override {
+    if (!hw) return false;
+    Ethernet.maintain();  // продление DHCP
+    return Ethernet.linkStatus() != LinkOFF && (uint32_t)Ethernet.localIP() != 0;
+  }
+
+  bool resolve(const String& host, String& ip) override {
+    DNSClient dns;
+    IPAddress addr;
+    dns.begin(Ethernet.dnsServerIP());
+    if (dns.getHostByName(host.c_str(), addr) != 1) return false;
+    ip = addr.toString();
+    return true;
+  }
+
+  Client& client() override { return cl; }
+
+  bool udpOpen(const String& ip, uint16_t port) override { return dg.open(ip, port); }
+  bool udpSend(const uint8_t* data, size_t len) override { return dg.send(data, len); }
+  int  udpRecv(uint8_t* buf, size_t maxLen) override { return dg.recv(buf, maxLen); }
+  void udpClose() override { dg.close(); }
+
+private:
+  bool hw = false;
+  EthernetClient cl;
+  EthernetUDP udp;
+  UdpChannel dg{udp};
+};
+
+static EthernetTransport ethTransport;
+
+Transport* TransportEthernet() {
+  return &ethTransport;
+}
+#else
+Transport* TransportEthernet() {
+  return nullptr;
+}
+#endif
+
+// ===================== WIFI STA =====================
+class WifiStaTransport : public Transport {
+public:
+  WifiStaTransport() { priorBps = 200000; }
+
+  const char* name() const override { return "wifi"; }
+
+  bool begin() override {
+    if (!ssid.length()) {
+      if (started) WiFi.disconnect(true);   // выключен в конфиге: гасим радио
+      started = false;
+      return false;
+    }
+    started = true;
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(true);
+    WiFi.setSleep(true);                     // modem-sleep между DTIM: light sleep связь рвёт
+    WiFi.begin(ssid.c_str(), pass.c_str());  // подключение идёт в фоне
+    return true;
+  }
+
+  bool linkUp() override {
+    return ssid.length() && WiFi.status() == WL_CONNECTED;
+  }
+
+  bool resolve(const String& host, String& ip) override {
+    IPAddress addr;
+    if (!WiFi.hostByName(host.c_str(), addr)) return false;
+    ip = addr.toString();
+    return true;
+  }
+
+  Client& client() override { return cl; }
+
+  bool udpOpen(const String& ip, uint16_t port) override { return dg.open(ip, port); }
+  bool udpSend(const uint8_t* data, size_t len) override { return dg.send(data, len); }
+  int  udpRecv(uint8_t* buf, size_t maxLen) override { return dg.recv(buf, maxLen); }
+  void udpClose() override { dg.close(); }
+
+  String ssid;
+  String pass;
+
+private:
+  bool started = false;
+  WiFiClient cl;
+  WiFiUDP udp;
+  UdpChannel dg{udp};
+};
+
+static WifiStaTransport wifiTransport;
+
+Transport* TransportWifiSta(const String& ssid, const String& pass) {
+  wifiTransport.ssid = ssid;
+  wifiTransport.pass = pass;
+  return &wifiTransport;
+}
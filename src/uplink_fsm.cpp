@@ -0,0 +1,267 @@
+#include "uplink_fsm.h"
+#include <atomic>
+#include "ring_store.h"
+#include "metrics.h"
+#include "dlog.h"
+
+static const uint32_t SEND_INTERVAL      = 30000;  // GPRS всегда подключён (uplinkMaxS = 0)
+static const uint32_t MODEM_INIT_TIMEOUT = 60000;  // скорость AT + рестарт модема
+static const uint32_t CONNECT_TIMEOUT    = 90000;  // сеть + GPRS
+static const uint32_t SYNC_BUDGET        = 45000;  // время + отчёт о здоровье
+static const uint32_t LATEST_BUDGET      = 45000;  // последний замер (UDP, затем HTTP)
+static const uint32_t DRAIN_BUDGET       = 180000; // пакет выгребает бэклог на полной скорости, но не бесконечно
+static const uint32_t WAIT_GRACE         = 5000;   // IDLE/BACKOFF: запас сверх их собственного срока
+static const uint32_t BACKOFF_MIN        = 5000;
+static const uint32_t BACKOFF_MAX        = 300000;
+
+// пакетный режим: между сеансами модем спит, срок следующего — адаптивный
+static const uint32_t BURST_RECORDS      = 4 * DATA_BATCH_MAX; // набралось столько — сеанс сразу
+static const uint32_t BURST_MIN_GAP      = 60000;  // бэклог не влез в сеанс — следующий через минуту
+static const uint32_t REST_MIN_MS        = 60000;  // короче — не усыпляем: переподключение дороже
+
+static const UplinkOps* ops = nullptr;
+static uint32_t maxLatencyMs = 0;  // пакетный режим: наибольшая задержка доставки, 0 — GPRS всегда
+
+// записи, сохранённые с начала последнего цикла, и время первой из них
+static std::atomic<uint32_t> storedPending{0};
+static std::atomic<uint32_t> storedSinceMs{0};
+
+const char* UplinkStateName(UplinkState st) {
+  switch (st) {
+    case UL_MODEM_INIT:  return "MODEM_INIT";
+    case UL_CONNECT:     return "CONNECT";
+    case UL_SYNC:        return "SYNC";
+    case UL_SEND_LATEST: return "SEND_LATEST";
+    case UL_DRAIN:       return "DRAIN";
+    case UL_IDLE:        return "IDLE";
+    case UL_BACKOFF:     return "BACKOFF";
+  }
+  return "?";
+}
+
+static bool burstMode() {
+  return maxLatencyMs != 0;
+}
+
+// сколько сохранённых записей будят задачу раньше срока
+static uint32_t wakeRecords() {
+  return burstMode() ? BURST_RECORDS : DATA_BATCH_MAX;
+}
+
+static uint32_t earlier(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) < 0 ? a : b;
+}
+
+// сколько ждать следующего сеанса. Каждый сеанс начинается с flush хранения, поэтому
+// любая неотправленная запись моложе lastCycleMs и срок lastCycleMs + uplinkMaxS
+// ограничивает её задержку. Раньше — если накопилось на полный сеанс или бэклог не влез
+static uint32_t nextCycleWaitMs(const Uplink& u, uint32_t now) {
+  if (storedPending.load() >= wakeRecords()) return 0;
+  if (!burstMode()) {
+    uint32_t since = now - u.lastCycleMs;
+    return since >= SEND_INTERVAL ? 0 : SEND_INTERVAL - since;
+  }
+
+  uint32_t due = u.lastCycleMs + maxLatencyMs;
+  if (u.backlogLeft) due = earlier(due, u.enteredMs + BURST_MIN_GAP);
+  int32_t left = (int32_t)(due - now);
+  return left > 0 ? (uint32_t)left : 0;
+}
+
+// конец сеанса: в пакетном режиме — GPRS долой, модем спать
+static void endBurst(Uplink& u, bool backlogLeft) {
+  u.backlogLeft = backlogLeft;
+  if (burstMode()) ops->modemRest();
+}
+
+static void enterState(Uplink& u, UplinkState st) {
+  if (u.state != st) {
+    DLOGI("UPLINK %s -> %s", UplinkStateName(u.state), UplinkStateName(st));
+  }
+  u.state = st;
+  u.enteredMs = millis();
+}
+
+static void enterBackoff(Uplink& u) {
+  u.backoffMs = u.backoffMs ? min(u.backoffMs * 2, BACKOFF_MAX) : BACKOFF_MIN;
+  // джиттер ±25%, чтобы устройства не ломились на сервер синхронно
+  uint32_t jitter = ops->random() % (u.backoffMs / 2 + 1);
+  u.backoffWaitMs = u.backoffMs - u.backoffMs / 4 + jitter;
+  DLOGI("Backoff %u ms", (unsigned)u.backoffWaitMs);
+  if (burstMode() && u.backoffWaitMs >= REST_MIN_MS) ops->modemRest();
+  enterState(u, UL_BACKOFF);
+}
+
+// срок пребывания в состоянии. Цикл задачи проверяет его перед каждым шагом,
+// шаги из нескольких обменов — между обменами: зависшее состояние (модем молчит,
+// сеть тормозит) не держит автомат дольше срока
+uint32_t UplinkStateDeadlineMs(const Uplink& u) {
+  switch (u.state) {
+    case UL_MODEM_INIT:  return MODEM_INIT_TIMEOUT;
+    case UL_CONNECT:     return CONNECT_TIMEOUT;
+    case UL_SYNC:        return SYNC_BUDGET;
+    case UL_SEND_LATEST: return LATEST_BUDGET;
+    case UL_DRAIN:       return DRAIN_BUDGET;
+    case UL_IDLE:        return (burstMode() ? maxLatencyMs : SEND_INTERVAL) + WAIT_GRACE;
+    case UL_BACKOFF:     return u.backoffWaitMs + WAIT_GRACE;
+  }
+  return CONNECT_TIMEOUT;
+}
+
+bool UplinkStateExpired(const Uplink& u) {
+  return millis() - u.enteredMs > UplinkStateDeadlineMs(u);
+}
+
+static void onStateExpired(Uplink& u) {
+  switch (u.state) {
+    case UL_DRAIN:
+      // бюджет сеанса, не сбой: остаток бэклога — в следующем
+      DLOGI("Drain budget used, backlog=%u", (unsigned)RingStoreCountApprox());
+      endBurst(u, true);
+      enterState(u, UL_IDLE);
+      break;
+    case UL_IDLE:
+    case UL_BACKOFF:
+      ops->modemWake();
+      enterState(u, UL_CONNECT);
+      break;
+    default:
+      DLOGW("UPLINK %s timeout (%u ms)", UplinkStateName(u.state), (unsigned)UplinkStateDeadlineMs(u));
+      enterBackoff(u);
+      break;
+  }
+}
+
+// ===================== STEPS =====================
+static void stepModemInit(Uplink& u) {
+  if (!ops->modemInit()) {
+    if (ops->linkUp()) {
+      // модема нет, но есть проводной/WiFi канал — работаем через него
+      DLOGW("Modem init failed, using other link");
+      enterState(u, UL_CONNECT);
+      return;
+    }
+    DLOGW("Modem init failed");
+    enterBackoff(u);
+    return;
+  }
+  u.backoffMs = 0;
+  enterState(u, UL_CONNECT);
+}
+
+static void stepConnect(Uplink& u) {
+  if (ops->sessionBegin()) {
+    MetricCount(MC_BURSTS);
+    u.lastCycleMs = millis();
+    // задержка стадии: первая несохранённая в облако запись -> начало цикла
+    if (storedPending.exchange(0)) {
+      MetricObserveUs(MH_STAGE_UPLINK, (u.lastCycleMs - storedSinceMs.load()) * 1000);
+    }
+    enterState(u, UL_SYNC);
+    return;
+  }
+
+  if (!ops->modemReady()) {
+    enterBackoff(u);
+    return;
+  }
+  ops->reconnect();
+}
+
+static void stepSync(Uplink& u) {
+  ops->sync(u);
+  if (UplinkStateExpired(u)) {
+    onStateExpired(u);
+    return;
+  }
+  enterState(u, UL_SEND_LATEST);
+}
+
+static void stepSendLatest(Uplink& u) {
+  bool ok = ops->sendLatest(u);
+  if (ok) ops->uploaded();
+  if (!ok && UplinkStateExpired(u)) {
+    onStateExpired(u);
+    return;
+  }
+  enterState(u, UL_DRAIN);
+}
+
+static void stepDrain(Uplink& u) {
+  SendResult r = ops->sendData(u);
+
+  switch (r) {
+    case SEND_OK:
+      u.backoffMs = 0;
+      ops->uploaded();
+      break;              // следующий пакет на следующем шаге
+    case SEND_EMPTY:
+      u.backoffMs = 0;
+      // кольцо пусто — время досылать архив по просьбе сервера
+      r = ops->sendBackfill();
+      if (r == SEND_OK) break;
+      if (r == SEND_FAIL) { enterBackoff(u); break; }
+      endBurst(u, false);
+      enterState(u, UL_IDLE);
+      break;
+    case SEND_FAIL:
+      enterBackoff(u);
+      break;
+  }
+}
+
+// новый цикл: по сроку (nextCycleWaitMs), по команде (тревога) или по накопленным данным
+static void stepIdle(Uplink& u) {
+  uint32_t wait = nextCycleWaitMs(u, millis());
+  if (wait) {
+    // срок или данные — перепроверим на следующем шаге (команда DATA могла устареть)
+    if (ops->waitCommand(wait) != UL_CMD_SEND_NOW) return;
+  }
+  ops->modemWake();
+  enterState(u, UL_CONNECT);
+}
+
+static void stepBackoff(Uplink& u) {
+  uint32_t since = millis() - u.enteredMs;
+  // в паузе будит только явная команда: полный пакет подождёт конца backoff
+  if (since < u.backoffWaitMs && ops->waitCommand(u.backoffWaitMs - since) != UL_CMD_SEND_NOW) return;
+  ops->modemWake();
+  enterState(u, ops->modemReady() ? UL_CONNECT : UL_MODEM_INIT);
+}
+
+// ===================== API =====================
+void UplinkFsmInit(Uplink& u, const UplinkOps& o, uint32_t seq) {
+  ops = &o;
+  u = Uplink{};
+  u.state = UL_MODEM_INIT;
+  u.enteredMs = millis();
+  u.seq = seq;
+}
+
+void UplinkFsmStep(Uplink& u) {
+  if (UplinkStateExpired(u)) {
+    onStateExpired(u);
+    return;
+  }
+  switch (u.state) {
+    case UL_MODEM_INIT:  stepModemInit(u);  break;
+    case UL_CONNECT:     stepConnect(u);    break;
+    case UL_SYNC:        stepSync(u);       break;
+    case UL_SEND_LATEST: stepSendLatest(u); break;
+    case UL_DRAIN:       stepDrain(u);      break;
+    case UL_IDLE:        stepIdle(u);       break;
+    case UL_BACKOFF:     stepBackoff(u);    break;
+  }
+}
+
+void UplinkFsmSetMaxLatency(uint32_t ms) {
+  maxLatencyMs = ms;
+}
+
+bool UplinkFsmNoteStored(size_t n) {
+  uint32_t prev = storedPending.fetch_add(n);
+  if (!prev) storedSinceMs = millis();
+  // будим только на пороге, чтобы не забить очередь команд
+  uint32_t th = wakeRecords();
+  return prev < th && prev + n >= th;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+
+// Конечный автомат аплинка без железа: состояния, сроки, backoff и расписание
+// сеансов. Модем, транспорт и обмены с сервером — через UplinkOps: в прошивке их
+// даёт gsm_uplink.cpp, в тестах на хосте — сценарий с поддельным модемом.
+//
+//   MODEM_INIT -> CONNECT -> SYNC -> SEND_LATEST -> DRAIN -> IDLE -> (срок/данные/команда) -> CONNECT
+// в пакетном режиме (maxLatencyMs > 0) DRAIN -> IDLE отключает GPRS и усыпляет модем
+// любая ошибка -> BACKOFF (экспонента с джиттером) -> CONNECT
+// у каждого состояния свой срок (UplinkStateDeadlineMs): вышел — BACKOFF, для DRAIN — IDLE
+enum UplinkState : uint8_t {
+  UL_MODEM_INIT,
+  UL_CONNECT,
+  UL_SYNC,
+  UL_SEND_LATEST,
+  UL_DRAIN,
+  UL_IDLE,
+  UL_BACKOFF
+};
+
+// команды от других задач
+enum UplinkCmd : uint8_t {
+  UL_CMD_NONE = 0,
+  UL_CMD_SEND_NOW,
+  UL_CMD_DATA,         // стадия хранения набрала полный пакет
+  UL_CMD_WAKE          // планировщик питания: срок ожидания наступил, пока спали
+};
+
+enum SendResult { SEND_OK, SEND_EMPTY, SEND_FAIL };
+
+static const size_t DATA_BATCH_MAX = 8; // записей в одном пакете /data
+
+struct Uplink {
+  UplinkState state;
+  uint32_t    enteredMs;     // вход в текущее состояние
+  uint32_t    lastCycleMs;   // начало последнего цикла отправки
+  uint32_t    backoffMs;     // текущая (базовая) пауза
+  uint32_t    backoffWaitMs; // пауза с джиттером для этого захода
+  uint32_t    seq;
+  uint32_t    lastAck;       // последний кумулятивный ack сервера
+  bool        backlogLeft;   // сеанс закончился по DRAIN_BUDGET, в кольце ещё есть
+};
+
+// всё, что автомат делает с модемом и сетью. Вызовы блокируют (обмены по GPRS — секунды);
+// многошаговые (sync, sendLatest, sendData) между обменами смотрят UplinkStateExpired
+struct UplinkOps {
+  bool       (*modemInit)();           // скорость AT + рестарт; false — модем не отвечает
+  bool       (*linkUp)();              // есть ли сейчас хоть один канал (модема может не быть)
+  bool       (*sessionBegin)();        // канал есть — начать сеанс (flush хранения, конфиг); false — нет
+  bool       (*modemReady)();
+  void       (*reconnect)();           // сеть + GPRS
+  void       (*sync)(Uplink& u);       // время + отчёт о здоровье
+  bool       (*sendLatest)(Uplink& u);
+  SendResult (*sendData)(Uplink& u);   // один пакет бэклога
+  SendResult (*sendBackfill)();        // кусок архива по просьбе сервера; SEND_EMPTY — нечего
+  void       (*modemRest)();
+  void       (*modemWake)();
+  UplinkCmd  (*waitCommand)(uint32_t waitMs);  // UL_CMD_NONE — срок вышел
+  void       (*uploaded)();            // успешная выгрузка
+  uint32_t   (*random)();
+};
+
+void UplinkFsmInit(Uplink& u, const UplinkOps& ops, uint32_t seq);
+void UplinkFsmStep(Uplink& u);                        // один шаг цикла задачи (срок, затем действие состояния)
+void UplinkFsmSetMaxLatency(uint32_t ms);             // 0 — GPRS всегда подключён
+bool UplinkFsmNoteStored(size_t n);                   // записи легли в кольцо; true — пора будить задачу
+uint32_t UplinkStateDeadlineMs(const Uplink& u);
+bool UplinkStateExpired(const Uplink& u);
+const char* UplinkStateName(UplinkState st);
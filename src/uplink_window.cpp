@@ -0,0 +1,185 @@
+#include "uplink_window.h"
+#include "uplink_fsm.h"
+#include "metrics.h"
+#include "dlog.h"
+
+struct Prepared {
+  uint32_t pos;    // абсолютный индекс первого слота в кольце
+  uint32_t slots;  // сколько слотов кольца покрывает
+  uint32_t seq;    // у пакета только из битых записей — seq предыдущего, блоба нет
+  uint32_t recs;
+  std::vector<uint8_t> blob;
+};
+
+static const WindowOps* ops = nullptr;
+static size_t window = UPLINK_WINDOW;
+
+// неподтверждённые и заготовленные пакеты подряд от tail кольца
+static std::vector<Prepared> outq;
+
+void UplinkWindowInit(const WindowOps& o, size_t w) {
+  ops = &o;
+  window = w ? w : 1;
+  outq.clear();
+}
+
+// снять заготовки: смена ключа или регистрации делает их негодными
+void UplinkWindowReset() {
+  outq.clear();
+}
+
+bool JsonGetUInt(const String& body, const char* key, uint32_t& out) {
+  String k = String("\"") + key + "\":";
+  int p = body.indexOf(k);
+  if (p < 0) return false;
+  const char* v = body.c_str() + p + k.length();
+  while (*v == ' ') v++;
+  if (*v < '0' || *v > '9') return false;
+  out = (uint32_t)strtoul(v, nullptr, 10);
+  return true;
+}
+
+// снять с кольца слоты [pos, pos + slots), если их ещё не сняли раньше (/export с ack).
+// Хвост не на месте (перед пакетом в кольце что-то есть) — не трогаем: сдвиг снял бы чужое
+void UplinkWindowDrop(uint32_t pos, uint32_t slots) {
+  RingStoreLock();
+  uint32_t tail = RingStoreTail();
+  int32_t n = (int32_t)(pos + slots - tail);
+  if ((int32_t)(tail - pos) >= 0 && n > 0) RingStoreDrop(n);
+  RingStoreUnlock();
+}
+
+// заготовки, чьи слоты уже ушли из кольца (ack датаграммой, переполнение),
+// и всё после первой несовпавшей — выбросить: цепочка prev у них не та
+static void outqValidate() {
+  uint32_t expect = RingStoreTail();
+  for (size_t i = 0; i < outq.size(); i++) {
+    if (outq[i].pos != expect) {
+      outq.erase(outq.begin() + i, outq.end());
+      break;
+    }
+    expect += outq[i].slots;
+  }
+}
+
+// прочитать, собрать и зашифровать следующий пакет в конец очереди; false — нечего/не вышло
+static bool prepareNext(uint32_t& seq, uint32_t lastAck) {
+  MetricScope m(MH_BATCH_PREP);
+
+  // хвост и чтение от него — одним куском: между ними кольцо могли сдвинуть
+  RingStoreLock();
+  uint32_t tail = RingStoreTail();
+  uint32_t pos = outq.empty() ? tail : outq.back().pos + outq.back().slots;
+  uint32_t prev = outq.empty() ? lastAck : outq.back().seq;
+
+  std::vector<SampleRec> batch;
+  size_t slots = (int32_t)(pos - tail) >= 0 ? RingStorePeek(pos - tail, batch, DATA_BATCH_MAX) : 0;
+  RingStoreUnlock();
+  if (slots == 0) return false;
+
+  Prepared p{ pos, (uint32_t)slots, prev, 0, {} };
+  if (batch.empty()) {
+    // только битые записи: уходят вместе с предыдущим пакетом
+    outq.push_back(std::move(p));
+    return true;
+  }
+
+  if (!ops->build(batch, seq, prev, p.blob)) {
+    DLOGE("AES encrypt failed");
+    return false;
+  }
+  p.seq = ops->takeSeq(seq);
+  p.recs = batch.size();
+  outq.push_back(std::move(p));
+  return true;
+}
+
+WindowResult UplinkWindowSend(uint32_t& seq, uint32_t& lastAck) {
+  if (RingStoreCountApprox() == 0) {
+    DLOGD("No data in ring buffer");
+    outq.clear();
+    return WIN_EMPTY;
+  }
+
+  outqValidate();
+  DLOGI("Sending data, seq=%u ack=%u ready=%u", (unsigned)seq, (unsigned)lastAck, (unsigned)outq.size());
+  if (!outq.empty()) MetricCount(MC_PREP_REUSED, outq.size());
+
+  if (!ops->open()) return WIN_FAIL;
+
+  size_t next = 0;        // outq[next] — следующий к отправке
+  size_t pending = 0;     // ответов ещё ждём
+  bool noMore = false;
+  bool failed = false;
+  bool notreg = false;
+  bool progress = false;
+
+  // снять с кольца всё, что покрыто ack
+  auto dropAcked = [&]() {
+    while (next > 0 && outq.front().seq <= lastAck) {
+      UplinkWindowDrop(outq.front().pos, outq.front().slots);
+      outq.erase(outq.begin());
+      next--;
+      progress = true;
+    }
+  };
+
+  while (true) {
+    // ---- дозаполняем окно: готовое уходит сразу ----
+    while (pending < window && !noMore) {
+      if (next == outq.size() && !prepareNext(seq, lastAck)) { noMore = true; break; }
+
+      Prepared& p = outq[next];
+      if (p.blob.empty()) {
+        next++;
+        dropAcked();
+        continue;
+      }
+
+      if (!ops->send(p.blob.data(), p.blob.size())) {
+        DLOGW("TCP write FAILED");
+        failed = true;
+        break;
+      }
+
+      DLOGI("-> seq=%u recs=%u bytes=%u",
+            (unsigned)p.seq, (unsigned)p.recs, (unsigned)p.blob.size());
+      next++;
+      pending++;
+    }
+
+    if (failed || pending == 0) break;
+
+    // ---- пока пакет в пути — готовим следующий ----
+    if (!noMore && next == outq.size() && outq.size() < window + 1) {
+      if (!prepareNext(seq, lastAck)) noMore = true;
+    }
+
+    // ---- ответы приходят по порядку ----
+    HttpResp resp;
+    if (!ops->recv(resp)) { failed = true; break; }
+    pending--;
+
+    DLOGI("<- %d (%u bytes)", resp.status, (unsigned)resp.body.length());
+
+    if (resp.body.indexOf("notreg") >= 0) { notreg = true; break; }
+
+    uint32_t ack;
+    if (JsonGetUInt(resp.body, "ack", ack) && ack > lastAck) lastAck = ack;
+    ops->onBody(resp.body);
+    dropAcked();
+
+    // разрыв цепочки или ошибка: новые пакеты не шлём, дочитываем ответы
+    if (resp.status != 200) noMore = true;
+    if (!resp.keepAlive) break;
+  }
+
+  ops->close();
+
+  if (notreg) {
+    outq.clear();
+    return WIN_NOTREG;
+  }
+  if (failed || !progress) return WIN_FAIL;
+  return WIN_OK;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include "ring_store.h"
+#include "http_resp.h"
+
+// Конвейерная выгрузка бэклога: до UPLINK_WINDOW пакетов в полёте на одном
+// keep-alive соединении. Каждый пакет несёт seq и prev (seq предыдущего в цепочке),
+// сервер отвечает кумулятивным "ack" — старшим seq непрерывной цепочки.
+// Из кольца удаляем только то, что покрыто ack.
+//
+// Пакеты готовятся заранее (двойной буфер): пока ждём ответ, следующий уже
+// прочитан из кольца, собран и зашифрован — после ack уходит сразу. Очередь
+// заготовок переживает обрыв: повтор шлёт те же блобы, не пересобирая их
+// (сервер принимает повтор с тем же nonce по цепочке seq/prev).
+static const size_t UPLINK_WINDOW = 4;
+
+// сборка пакета и соединение — снаружи (gsm_uplink.cpp; в тестах — подставной сервер)
+struct WindowOps {
+  bool     (*build)(const std::vector<SampleRec>& batch, uint32_t seq, uint32_t prev,
+                    std::vector<uint8_t>& blob);         // JSON + сжатие + шифрование
+  uint32_t (*takeSeq)(uint32_t& seq);
+  bool     (*open)();                                     // соединение с сервером
+  bool     (*send)(const uint8_t* blob, size_t len);      // запрос /data, keep-alive
+  bool     (*recv)(HttpResp& resp);                       // следующий ответ; false — таймаут/обрыв
+  void     (*close)();
+  void     (*onBody)(const String& body);                 // ответ сервера (просьба о досылке)
+};
+
+enum WindowResult { WIN_OK, WIN_EMPTY, WIN_FAIL, WIN_NOTREG };
+
+void UplinkWindowInit(const WindowOps& ops, size_t window = UPLINK_WINDOW);
+WindowResult UplinkWindowSend(uint32_t& seq, uint32_t& lastAck); // одно соединение: шлём, пока есть что и пока идёт
+void UplinkWindowReset();                                 // заготовки негодны (смена ключа, регистрации)
+void UplinkWindowDrop(uint32_t pos, uint32_t slots);      // снять слоты, подтверждённые в обход окна (датаграммой)
+
+// "key":123 в плоском JSON-ответе сервера
+bool JsonGetUInt(const String& body, const char* key, uint32_t& out);
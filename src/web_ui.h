@@ -0,0 +1,211 @@
+#pragma once
+// Сгенерировано scripts/embed_web.py из web/index.html — не править руками
+#include <Arduino.h>
+
+// 7903 -> 3246 байт (gzip)
+static const size_t WEB_INDEX_GZ_LEN = 3246;
+static const uint8_t WEB_INDEX_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xbd, 0x59, 0x7d, 0x6f, 0xdb, 0xc6,
+  0x19, 0xff, 0xdf, 0x9f, 0xe2, 0xa2, 0x66, 0x20, 0xb9, 0x4a, 0x94, 0x28, 0x5b, 0xae, 0x23, 0x59,
+  0xca, 0x32, 0xe7, 0xa5, 0x19, 0x9a, 0xd8, 0xa8, 0x9c, 0x05, 0x58, 0x10, 0x24, 0x14, 0x79, 0x92,
+  0x58, 0x4b, 0x3c, 0x96, 0x3c, 0xfa, 0xa5, 0x82, 0x07, 0x27, 0x59, 0x96, 0x16, 0x0d, 0x9a, 0x36,
+  0x28, 0xb0, 0x61, 0x6b, 0x37, 0x74, 0xd8, 0xfa, 0xb7, 0xea, 0xc6, 0x8d, 0xe3, 0x24, 0x0e, 0xd0,
+  0x4f, 0x40, 0x7d, 0x85, 0x7c, 0x92, 0x3d, 0xcf, 0x1d, 0x29, 0x51, 0xb6, 0xe5, 0xda, 0xfb, 0x63,
+  0x09, 0x64, 0x89, 0xf7, 0xf2, 0xbc, 0xdd, 0xef, 0xf9, 0xdd, 0x73, 0xc7, 0xf9, 0x33, 0x36, 0xb3,
+  0xf8, 0x86, 0x47, 0x49, 0x9b, 0x77, 0x3b, 0xb5, 0xa9, 0x79, 0xfc, 0x22, 0x1d, 0xd3, 0x6d, 0x55,
+  0x33, 0x7e, 0x98, 0xc1, 0x06, 0x6a, 0xda, 0xf0, 0xd5, 0xa5, 0xdc, 0x24, 0x56, 0xdb, 0xf4, 0x03,
+  0xca, 0xab, 0x99, 0x90, 0x37, 0x73, 0x73, 0x99, 0x7c, 0xd2, 0xee, 0x9a, 0x5d, 0x5a, 0xcd, 0xac,
+  0x3a, 0x74, 0xcd, 0x63, 0x3e, 0xcf, 0x10, 0x8b, 0xb9, 0x9c, 0xba, 0x30, 0x6e, 0xcd, 0xb1, 0x79,
+  0xbb, 0x6a, 0xd3, 0x55, 0xc7, 0xa2, 0x39, 0xf1, 0x90, 0x25, 0x8e, 0xeb, 0x70, 0xc7, 0xec, 0xe4,
+  0x02, 0xcb, 0xec, 0xd0, 0xaa, 0x21, 0xa4, 0x70, 0x87, 0x77, 0x68, 0xed, 0x52, 0x7d, 0x69, 0xba,
+  0x48, 0x16, 0x98, 0xdb, 0x74, 0x5a, 0xf3, 0x79, 0xd9, 0x36, 0x35, 0x7f, 0x26, 0x97, 0x23, 0xd1,
+  0x77, 0x83, 0xfb, 0x51, 0x1f, 0x3e, 0xbb, 0xd1, 0x5e, 0xd4, 0x2f, 0x93, 0xc1, 0xbd, 0x68, 0x3f,
+  0xfa, 0x21, 0xda, 0x1d, 0x6c, 0x45, 0xfd, 0x68, 0x67, 0x70, 0x7f, 0x70, 0x6f, 0xf0, 0x84, 0x44,
+  0xdb, 0x24, 0xf0, 0xad, 0xfc, 0x1a, 0x6d, 0xdc, 0x09, 0x1d, 0xbd, 0x4d, 0xd4, 0xd6, 0x27, 0x8e,
+  0xa7, 0xe1, 0xd8, 0x3d, 0x18, 0xb7, 0x1b, 0xbd, 0x81, 0xf9, 0xfb, 0xd1, 0x2b, 0x12, 0x58, 0xbe,
+  0xe3, 0xf1, 0x20, 0x4f, 0xbb, 0x0d, 0x6a, 0xdf, 0x81, 0xe1, 0xba, 0xb7, 0xa1, 0x4f, 0x11, 0xfc,
+  0x17, 0xfd, 0x25, 0x7a, 0x0d, 0x7a, 0x1e, 0x45, 0x3b, 0xf0, 0xbd, 0x8b, 0x32, 0xf1, 0xf1, 0x1e,
+  0x28, 0xd8, 0x82, 0xa9, 0x3b, 0xd1, 0x1e, 0x89, 0x1f, 0xfa, 0xa2, 0xff, 0xcf, 0x51, 0x9f, 0x80,
+  0x19, 0x3b, 0x83, 0xad, 0xc1, 0x57, 0x83, 0xfb, 0x04, 0x74, 0x3c, 0x27, 0x57, 0x2e, 0x2d, 0x93,
+  0xbc, 0xe9, 0x39, 0x79, 0x4b, 0xf8, 0xa1, 0x93, 0x5c, 0x0e, 0x9c, 0x08, 0xf8, 0x06, 0x3a, 0xd3,
+  0x60, 0xf6, 0x46, 0xaf, 0x09, 0xd1, 0xc9, 0x35, 0xcd, 0xae, 0xd3, 0xd9, 0x28, 0x07, 0x1b, 0x01,
+  0xa7, 0xdd, 0x5c, 0xe8, 0x64, 0x73, 0xa6, 0xe7, 0x75, 0x68, 0x4e, 0x36, 0x64, 0xeb, 0xb4, 0xc5,
+  0x28, 0xb9, 0x71, 0x35, 0xfb, 0x21, 0x6b, 0x30, 0xce, 0xb2, 0x17, 0x7c, 0x08, 0x59, 0xa5, 0x6b,
+  0xfa, 0x2d, 0xc7, 0x2d, 0x17, 0x2a, 0x0d, 0xd3, 0x5a, 0x69, 0xf9, 0x2c, 0x74, 0xed, 0xf2, 0x3b,
+  0x85, 0x86, 0x51, 0x2c, 0x16, 0x2a, 0x16, 0xeb, 0x30, 0xbf, 0xfc, 0x0e, 0x9d, 0xa3, 0xb4, 0x69,
+  0x55, 0x36, 0xa7, 0xf4, 0x35, 0xdf, 0xf4, 0x7a, 0x5d, 0x73, 0x5d, 0xc6, 0xbd, 0xfc, 0x5e, 0xb1,
+  0xe0, 0xad, 0x0f, 0x25, 0x10, 0x33, 0xe4, 0xac, 0xe2, 0x99, 0xb6, 0xed, 0xb8, 0xad, 0xb2, 0x31,
+  0x0b, 0x5d, 0x30, 0xc5, 0x32, 0x7d, 0xbb, 0x97, 0x96, 0x6d, 0x14, 0x8d, 0x46, 0x91, 0x56, 0x1a,
+  0xcc, 0xb7, 0xa9, 0x5f, 0x36, 0xbc, 0x75, 0x12, 0xb0, 0x8e, 0x63, 0x13, 0xbf, 0xd5, 0x30, 0xd5,
+  0x62, 0xa9, 0x94, 0x4d, 0x3e, 0x7a, 0x61, 0x4e, 0x8b, 0x87, 0xe5, 0x7c, 0xd3, 0x76, 0xc2, 0x40,
+  0x0a, 0x1d, 0xd3, 0xd0, 0x60, 0xeb, 0xb9, 0xa0, 0x6d, 0xda, 0x6c, 0x0d, 0x0c, 0x98, 0x03, 0x61,
+  0xc5, 0x19, 0xf8, 0x23, 0x64, 0x15, 0xb2, 0xf8, 0x5f, 0x2f, 0x96, 0x34, 0xb0, 0xa3, 0x6d, 0xc8,
+  0x18, 0x05, 0xce, 0x27, 0xb4, 0x3c, 0x6e, 0x76, 0x81, 0x18, 0x45, 0x61, 0x6b, 0xc7, 0x6c, 0xd0,
+  0x4e, 0xcf, 0x76, 0x02, 0xaf, 0x63, 0x6e, 0x94, 0x1b, 0x1d, 0x66, 0xad, 0x24, 0xa3, 0x0c, 0x98,
+  0x01, 0x03, 0x51, 0xe3, 0x48, 0x8c, 0x01, 0xaa, 0x2a, 0xcc, 0x33, 0x2d, 0x87, 0x6f, 0x94, 0xf5,
+  0x73, 0x25, 0x10, 0xe1, 0xb8, 0x5e, 0xc8, 0xb3, 0x9c, 0xae, 0x73, 0xd3, 0xa7, 0x66, 0x36, 0xa0,
+  0x1d, 0x6a, 0xf1, 0x9e, 0x8c, 0x96, 0x51, 0x28, 0xfc, 0x6a, 0x64, 0x7c, 0x51, 0x18, 0x3f, 0xe6,
+  0xdc, 0xa8, 0xe9, 0xd8, 0xb0, 0x18, 0x45, 0xed, 0x97, 0x17, 0x8b, 0x85, 0xbc, 0xe3, 0xb8, 0xb4,
+  0xec, 0x32, 0x97, 0xca, 0x20, 0x39, 0x9f, 0xa0, 0xde, 0x58, 0x25, 0xb4, 0x80, 0xb5, 0x89, 0x9d,
+  0xbd, 0xae, 0xe3, 0xe6, 0xda, 0xd4, 0x69, 0xb5, 0x79, 0xd9, 0x40, 0x57, 0x2b, 0x3e, 0x15, 0x1e,
+  0xae, 0x52, 0x9f, 0x3b, 0x90, 0x53, 0xb8, 0x90, 0x3e, 0x5b, 0x1b, 0xc6, 0xa6, 0xe5, 0x3b, 0x76,
+  0x05, 0xff, 0xe4, 0x00, 0x58, 0xd0, 0xc2, 0x69, 0x0e, 0xd4, 0x87, 0x5d, 0x17, 0xbc, 0x68, 0xfa,
+  0x04, 0x3e, 0x95, 0x96, 0xe9, 0x95, 0xe3, 0xb8, 0xfe, 0xa6, 0x4b, 0x6d, 0xc7, 0x54, 0x47, 0xb8,
+  0x29, 0xcd, 0x82, 0x0e, 0xad, 0x27, 0x44, 0x4e, 0x94, 0x52, 0xd9, 0x04, 0xa5, 0x0d, 0xee, 0xf6,
+  0xe4, 0x12, 0xe4, 0x38, 0xf3, 0x64, 0xc4, 0x27, 0x44, 0x93, 0x88, 0xce, 0x38, 0x7e, 0x85, 0x23,
+  0x63, 0x9b, 0x0a, 0x5a, 0xd1, 0x9c, 0x9d, 0x6d, 0x36, 0xe3, 0xa0, 0xad, 0xb5, 0x1d, 0x4e, 0xd3,
+  0x0b, 0x3b, 0x5c, 0xe7, 0x35, 0x19, 0x94, 0xd9, 0x42, 0x01, 0x43, 0xd0, 0x0d, 0x39, 0xb5, 0x7b,
+  0xc3, 0x15, 0x7f, 0xaf, 0x94, 0x9e, 0x83, 0x1a, 0x30, 0xe4, 0xc3, 0x40, 0xea, 0xd3, 0xa5, 0x4a,
+  0xda, 0xf6, 0x82, 0x4c, 0x08, 0xb6, 0xd2, 0x1b, 0x9a, 0x8d, 0xa8, 0x9a, 0x88, 0x84, 0x91, 0xb5,
+  0x02, 0x03, 0x33, 0x85, 0xac, 0x31, 0x57, 0xc8, 0x9e, 0x3b, 0x07, 0x08, 0x28, 0x69, 0x13, 0x80,
+  0x92, 0x1a, 0x84, 0xb8, 0x8f, 0xd5, 0x43, 0xba, 0x73, 0xd6, 0x95, 0x62, 0x93, 0x25, 0x14, 0xc0,
+  0xd8, 0x9c, 0x9a, 0xcf, 0xc7, 0x34, 0x32, 0x9f, 0x8f, 0x59, 0x19, 0xf9, 0xa4, 0x36, 0x6f, 0x3b,
+  0xab, 0xc4, 0xea, 0x98, 0x41, 0x00, 0x84, 0x0b, 0x49, 0x9f, 0x19, 0x6b, 0xc1, 0x9c, 0x16, 0x3c,
+  0x6e, 0xd4, 0xa2, 0x6f, 0x53, 0x64, 0xf6, 0x02, 0x98, 0x74, 0x97, 0x0c, 0x1e, 0x8c, 0x1a, 0xf0,
+  0x57, 0xb4, 0x1d, 0xf5, 0x41, 0xba, 0x01, 0x13, 0x50, 0x86, 0x63, 0x57, 0x33, 0x1d, 0x67, 0x95,
+  0x66, 0x12, 0x69, 0x22, 0xaa, 0x19, 0x22, 0xec, 0x80, 0xa7, 0xf1, 0xb4, 0xcc, 0xd4, 0xa2, 0x7f,
+  0x82, 0x20, 0x60, 0xe8, 0xe8, 0x79, 0xcc, 0x90, 0x4f, 0xca, 0x04, 0x5a, 0x7e, 0x02, 0x66, 0x7c,
+  0x26, 0x5b, 0xa2, 0x9d, 0xb7, 0x5b, 0xdf, 0xcf, 0xe7, 0x41, 0x78, 0x4a, 0x05, 0x5b, 0x19, 0x2a,
+  0x80, 0x9f, 0xb5, 0xb7, 0xdf, 0x3c, 0x04, 0xc6, 0x8f, 0xf6, 0x07, 0x0f, 0x63, 0xa6, 0x45, 0x36,
+  0xde, 0x3f, 0x93, 0xcc, 0x6a, 0x32, 0xbf, 0x2b, 0xa6, 0x35, 0xc1, 0x2f, 0x42, 0xe6, 0x05, 0x15,
+  0xd4, 0xa2, 0x2f, 0xa3, 0x67, 0x30, 0x7c, 0x67, 0x70, 0x0f, 0x19, 0x1f, 0x28, 0x19, 0x5c, 0xc1,
+  0xbf, 0x7d, 0xa2, 0x5e, 0x5d, 0xca, 0x83, 0x7a, 0xa0, 0x7e, 0x14, 0x94, 0x25, 0x38, 0x0a, 0x0c,
+  0x94, 0x43, 0x5e, 0x0f, 0x3e, 0x8f, 0x76, 0x08, 0x32, 0xbe, 0x6c, 0x26, 0xc2, 0xf4, 0x37, 0x83,
+  0x27, 0x10, 0x95, 0x07, 0x83, 0x2f, 0xca, 0xa4, 0xcd, 0x02, 0x7e, 0xab, 0x8c, 0xfb, 0xda, 0xed,
+  0xac, 0xae, 0xeb, 0xda, 0x7c, 0x5e, 0xea, 0x43, 0xcd, 0x82, 0x41, 0xe2, 0xdd, 0x2f, 0xa0, 0x3e,
+  0x64, 0xe0, 0xfb, 0x30, 0x3a, 0x43, 0x7c, 0xfa, 0x71, 0xe8, 0xf8, 0xd4, 0x86, 0xad, 0x0d, 0x87,
+  0xa5, 0x56, 0x03, 0xb2, 0x48, 0x18, 0x2d, 0x5b, 0x6b, 0x89, 0xed, 0x10, 0x36, 0xd8, 0x43, 0xee,
+  0x27, 0xb2, 0x8f, 0x10, 0xbc, 0x24, 0x36, 0x56, 0xdc, 0xa9, 0xab, 0x19, 0x37, 0x84, 0x9d, 0xcb,
+  0xcf, 0x10, 0x60, 0x82, 0x6a, 0xc6, 0x80, 0x6f, 0x73, 0xbd, 0x9a, 0x99, 0x2d, 0x95, 0xa6, 0x4b,
+  0x69, 0xd5, 0x71, 0xb8, 0x8e, 0xd0, 0xd5, 0x17, 0xeb, 0xfd, 0x72, 0xf0, 0x98, 0x0c, 0x3e, 0x85,
+  0x35, 0xfa, 0x93, 0x78, 0xdc, 0x4e, 0x56, 0xec, 0x48, 0x23, 0x2c, 0x7f, 0xc3, 0xe3, 0x6c, 0x09,
+  0x7c, 0x10, 0x6a, 0x3b, 0xd4, 0x6d, 0xc1, 0xc6, 0x9e, 0xc1, 0x1a, 0x60, 0xa8, 0x27, 0xfe, 0x71,
+  0x22, 0x8f, 0x6f, 0x5c, 0x5c, 0xca, 0x45, 0x6f, 0xa4, 0xd7, 0x44, 0x45, 0x70, 0xe0, 0x06, 0x1f,
+  0xfd, 0x28, 0x16, 0xfc, 0x55, 0xf4, 0x6a, 0xf0, 0x79, 0x16, 0x40, 0xf5, 0x76, 0xeb, 0x6b, 0x22,
+  0x36, 0x6d, 0xb0, 0x15, 0x60, 0xb5, 0x4f, 0xde, 0x5f, 0x5e, 0x5e, 0xd2, 0x8e, 0x34, 0x30, 0xb4,
+  0xbd, 0x89, 0x21, 0x2a, 0x8c, 0x85, 0x68, 0x72, 0x64, 0xbe, 0x01, 0xdd, 0x7b, 0x83, 0x7b, 0xba,
+  0xc4, 0xc0, 0x33, 0x01, 0x89, 0x9f, 0x10, 0xce, 0x80, 0x61, 0x30, 0xe3, 0x8d, 0x30, 0x6e, 0x1b,
+  0xf3, 0x06, 0x40, 0x74, 0x8f, 0xa8, 0xd2, 0xc0, 0x2b, 0x4b, 0x1f, 0xd6, 0xa1, 0xf6, 0x40, 0xd0,
+  0x45, 0x3f, 0xa2, 0x27, 0x04, 0x1d, 0x83, 0x1f, 0x7b, 0x60, 0xf6, 0x17, 0x83, 0x47, 0x83, 0xaf,
+  0xa2, 0xd7, 0x13, 0x6c, 0xf6, 0x80, 0x83, 0x56, 0xae, 0x99, 0xeb, 0xf5, 0xd3, 0x99, 0x9d, 0x0a,
+  0xf4, 0xd0, 0xf2, 0x1d, 0x91, 0xbd, 0xfb, 0x42, 0xf5, 0x4b, 0x91, 0x72, 0x3b, 0x32, 0xdd, 0x44,
+  0x74, 0xf7, 0x49, 0xa9, 0x50, 0xc0, 0xbc, 0xd8, 0x85, 0xe0, 0x6e, 0xc7, 0x43, 0xb6, 0xc7, 0xb0,
+  0x9c, 0xec, 0x2f, 0xb1, 0x6d, 0xb0, 0xa1, 0x9a, 0xdc, 0x61, 0xae, 0xb0, 0x21, 0x59, 0x6e, 0x10,
+  0x02, 0xe4, 0x92, 0x4f, 0x86, 0xa6, 0xb3, 0xef, 0x5b, 0x91, 0x35, 0x5b, 0x83, 0x27, 0x29, 0xcd,
+  0x22, 0x0f, 0xa1, 0x66, 0x03, 0x13, 0x9e, 0x4e, 0xcc, 0x9b, 0x55, 0xd6, 0xe1, 0x66, 0x8b, 0x1e,
+  0x8c, 0x00, 0x54, 0x41, 0x1e, 0x84, 0x40, 0x17, 0xf5, 0x21, 0xce, 0x69, 0x1b, 0xe3, 0xac, 0x23,
+  0x79, 0x7a, 0x4e, 0xb0, 0xce, 0xbf, 0x04, 0xeb, 0x80, 0x47, 0x22, 0x99, 0x25, 0x9a, 0x20, 0xa5,
+  0xb1, 0x58, 0xdc, 0x95, 0x6c, 0x76, 0xa2, 0x2c, 0xfc, 0x9b, 0x48, 0x81, 0xbe, 0x0c, 0x0e, 0x51,
+  0xaf, 0x2c, 0x5d, 0x5d, 0x9c, 0x9e, 0xc9, 0x92, 0xe9, 0x12, 0x7c, 0x8a, 0xf0, 0x99, 0x3e, 0x7a,
+  0x19, 0x2d, 0xbe, 0xd0, 0x36, 0x5d, 0x97, 0x76, 0x82, 0x63, 0x13, 0x74, 0x26, 0x73, 0x5c, 0x4e,
+  0xee, 0x43, 0xb0, 0x5e, 0x42, 0xe4, 0x9e, 0x89, 0xd8, 0xbd, 0x20, 0x82, 0x45, 0x85, 0x31, 0x02,
+  0x64, 0x82, 0x04, 0x5f, 0xc4, 0xa5, 0x27, 0x64, 0xc3, 0xd0, 0x10, 0x59, 0xb5, 0x0c, 0x2d, 0xb9,
+  0x4e, 0x43, 0xee, 0x9b, 0x1d, 0x58, 0x25, 0xe6, 0xe1, 0xf2, 0x91, 0x55, 0xb3, 0x13, 0x52, 0xc4,
+  0x52, 0x0d, 0x45, 0x20, 0xc5, 0xc8, 0x8e, 0x83, 0x03, 0x0c, 0x18, 0xf0, 0x0c, 0xb9, 0x3f, 0xe9,
+  0xce, 0x4b, 0xc9, 0x87, 0x50, 0x77, 0xe2, 0x48, 0xbe, 0x04, 0x3f, 0x7e, 0x88, 0xa9, 0x05, 0x9c,
+  0xc9, 0x92, 0xe8, 0x4b, 0x51, 0x4e, 0x23, 0xe9, 0xec, 0x09, 0x2f, 0x1e, 0x10, 0x75, 0x22, 0xf1,
+  0x8a, 0x24, 0x4a, 0x45, 0x01, 0x69, 0x61, 0x62, 0xf8, 0xc1, 0xe1, 0xc9, 0xb1, 0xfd, 0x0e, 0x79,
+  0x7f, 0xf0, 0xd9, 0x10, 0x95, 0x40, 0xf9, 0x0f, 0x40, 0xf9, 0x13, 0x61, 0xd0, 0x64, 0x03, 0x26,
+  0x29, 0x5b, 0x6c, 0x36, 0xe1, 0x08, 0x34, 0x21, 0x1d, 0x8f, 0x03, 0xe9, 0xb7, 0x31, 0xbf, 0xed,
+  0x20, 0xd5, 0x42, 0x5a, 0xec, 0xc8, 0x75, 0x3c, 0x31, 0x3a, 0xbf, 0x01, 0xeb, 0x5f, 0xeb, 0xc8,
+  0x34, 0x28, 0xe3, 0x95, 0x38, 0xf0, 0x24, 0x1c, 0x93, 0x9c, 0x57, 0x90, 0x97, 0x8e, 0xb4, 0x1b,
+  0xea, 0x05, 0x7e, 0xcd, 0x71, 0x17, 0xdd, 0xe3, 0xa9, 0x66, 0x1a, 0x8a, 0xa7, 0x63, 0x09, 0xf2,
+  0xb0, 0x09, 0x90, 0x72, 0xa7, 0x35, 0xa2, 0xd9, 0x3c, 0x9d, 0x15, 0x47, 0x22, 0x4f, 0x56, 0x22,
+  0xb5, 0xe8, 0x29, 0xaa, 0x07, 0x9b, 0x90, 0x9d, 0x77, 0x09, 0x27, 0x6f, 0x3f, 0xfb, 0x37, 0x79,
+  0xfb, 0xe9, 0xd3, 0x12, 0xf9, 0xb9, 0xbf, 0x90, 0x1d, 0xda, 0x37, 0x36, 0xe0, 0x3f, 0xb0, 0xb5,
+  0x40, 0x2f, 0xb4, 0x7d, 0x3d, 0x62, 0x0a, 0x39, 0x00, 0x09, 0x74, 0x98, 0x73, 0x69, 0xdf, 0x46,
+  0xc7, 0x4c, 0xf8, 0x83, 0x49, 0xf8, 0x7c, 0xf0, 0x40, 0x3f, 0xd9, 0xca, 0xdf, 0x74, 0x2e, 0x3b,
+  0x48, 0x4a, 0x2f, 0x31, 0x5e, 0x07, 0x36, 0x12, 0x12, 0xd7, 0x45, 0x50, 0x86, 0x0c, 0x1e, 0x9e,
+  0x02, 0x0c, 0xdf, 0x09, 0x73, 0x1e, 0x13, 0xb5, 0x5e, 0xbf, 0x7a, 0x31, 0x8b, 0xb6, 0x3f, 0x90,
+  0x1b, 0xc0, 0xe1, 0x3d, 0xf3, 0x4a, 0xfd, 0xda, 0xd1, 0x58, 0x5e, 0x73, 0x9a, 0x4e, 0x3d, 0x70,
+  0xec, 0xcc, 0xc9, 0x6a, 0x05, 0x74, 0x63, 0xa2, 0x1c, 0x51, 0x19, 0x9c, 0x3e, 0x27, 0xbe, 0x46,
+  0xde, 0xc3, 0x7c, 0x8b, 0xde, 0x9c, 0xc2, 0xf9, 0xbf, 0x83, 0x45, 0x3f, 0x22, 0x14, 0x8f, 0x34,
+  0xc7, 0xb4, 0x01, 0x4c, 0x1f, 0x30, 0xd0, 0x74, 0x32, 0xc7, 0x26, 0x0b, 0x39, 0xc6, 0xa9, 0x46,
+  0x08, 0x55, 0xba, 0x9b, 0xd8, 0x09, 0x27, 0x9f, 0x04, 0xd0, 0x41, 0xd8, 0xe8, 0x3a, 0x3c, 0x53,
+  0x1b, 0xab, 0x5f, 0x77, 0x71, 0xad, 0xe6, 0xf3, 0x72, 0xd2, 0x04, 0x20, 0xdf, 0x74, 0x72, 0x08,
+  0x93, 0xed, 0xa3, 0x10, 0x97, 0x5e, 0xce, 0x18, 0xc7, 0x82, 0xac, 0x5e, 0x09, 0x80, 0xca, 0xba,
+  0x7a, 0x97, 0xe0, 0x7e, 0x35, 0x23, 0x29, 0xf6, 0xca, 0xf5, 0x8b, 0xc9, 0x40, 0x01, 0x8b, 0x3e,
+  0xd6, 0x59, 0xd1, 0x8e, 0x3e, 0xdf, 0xf0, 0x51, 0x7d, 0x02, 0x9f, 0x32, 0x38, 0x22, 0x6f, 0x5d,
+  0x72, 0x0b, 0x8b, 0xd7, 0x2f, 0x5f, 0xbd, 0x02, 0x36, 0xd6, 0x90, 0x79, 0x87, 0xc1, 0x11, 0x23,
+  0x8c, 0xe2, 0xf4, 0x4c, 0x69, 0xf6, 0xbd, 0x39, 0xd9, 0xdb, 0x4f, 0xea, 0x6c, 0xd1, 0xd7, 0xe6,
+  0xdc, 0x2b, 0xe7, 0xf3, 0xc6, 0xb9, 0xa2, 0x6e, 0xcc, 0xce, 0xe9, 0x33, 0xba, 0x91, 0xc7, 0x61,
+  0x49, 0xad, 0x9e, 0xc7, 0x62, 0x1d, 0xbf, 0x47, 0x05, 0x7f, 0xfa, 0x5c, 0x72, 0x14, 0x32, 0x66,
+  0x11, 0x19, 0x12, 0x38, 0x90, 0xdd, 0xe0, 0x21, 0x90, 0x26, 0x00, 0xe4, 0xb9, 0x2c, 0xc4, 0x70,
+  0x33, 0xd8, 0x13, 0x69, 0xfa, 0x52, 0xf0, 0x8d, 0x48, 0x9c, 0xff, 0x39, 0x8b, 0x88, 0x7a, 0x63,
+  0x79, 0xe1, 0x60, 0x76, 0xe0, 0xd1, 0x62, 0xfd, 0xb2, 0xcf, 0xba, 0xc9, 0x9a, 0xda, 0x70, 0xda,
+  0xe5, 0x4e, 0x97, 0xe6, 0xb0, 0x28, 0xea, 0x1c, 0xbf, 0x8d, 0x4f, 0x96, 0xb8, 0xcc, 0x7e, 0x59,
+  0xde, 0xe8, 0x47, 0x2c, 0xf1, 0xaf, 0x32, 0xab, 0x01, 0x0e, 0xb8, 0xc6, 0x7b, 0xe9, 0x22, 0x2a,
+  0xde, 0xf9, 0x85, 0xec, 0xba, 0x6f, 0x1d, 0xda, 0xf2, 0x3f, 0x0e, 0x69, 0x48, 0x01, 0x88, 0xfb,
+  0xc3, 0x2d, 0xee, 0x19, 0x64, 0xf1, 0x41, 0x02, 0x9a, 0x54, 0x0f, 0xb4, 0x9d, 0x80, 0x33, 0x7f,
+  0x03, 0xe6, 0x23, 0x76, 0x1e, 0x82, 0x72, 0xa8, 0x88, 0xfe, 0x58, 0x42, 0x38, 0x3d, 0x10, 0x78,
+  0xdc, 0xcb, 0x8e, 0x81, 0xf5, 0x20, 0xb7, 0xc5, 0xab, 0x83, 0xb7, 0x66, 0xda, 0xe1, 0xa2, 0x62,
+  0xe4, 0x61, 0x3a, 0x42, 0x17, 0xac, 0x95, 0x24, 0x44, 0x56, 0x9b, 0x5a, 0x2b, 0x0d, 0xb6, 0x3e,
+  0x44, 0x88, 0xbc, 0x48, 0xc0, 0x5b, 0x2b, 0x88, 0x17, 0x1c, 0x5b, 0xc5, 0x8a, 0xbf, 0x94, 0x99,
+  0x25, 0x99, 0x5a, 0xc2, 0xe4, 0xa7, 0x91, 0x5e, 0x79, 0x1f, 0x97, 0xf6, 0x1f, 0xdd, 0x1d, 0x05,
+  0xf0, 0x68, 0x7c, 0x4c, 0xcc, 0x6c, 0xd9, 0x91, 0x21, 0xcc, 0xb5, 0x3a, 0x8e, 0xb5, 0x52, 0xcd,
+  0xd0, 0x75, 0x4f, 0x55, 0xac, 0x60, 0x55, 0xd1, 0x32, 0xb5, 0x85, 0xfa, 0xef, 0xd3, 0xf9, 0x7d,
+  0x7a, 0x39, 0xae, 0xfd, 0x51, 0xc0, 0x5c, 0x14, 0x75, 0xfd, 0xe2, 0xef, 0xea, 0x8b, 0xd7, 0xc7,
+  0xd8, 0x62, 0x88, 0x8a, 0x53, 0x0a, 0xf5, 0xcd, 0x35, 0x94, 0x18, 0x7d, 0x85, 0x64, 0x29, 0x92,
+  0x1a, 0x8f, 0xbb, 0x2f, 0x88, 0x3a, 0x5d, 0xc4, 0x7b, 0xcb, 0x3e, 0x56, 0x94, 0x51, 0x3f, 0x2f,
+  0x0b, 0x1f, 0x88, 0xe5, 0xbd, 0xc1, 0x63, 0x6d, 0x4c, 0xf1, 0xc9, 0xf5, 0x05, 0x61, 0x57, 0xd5,
+  0x04, 0xed, 0x6d, 0xc7, 0x87, 0x9f, 0x7e, 0x5c, 0xc2, 0x0d, 0xf1, 0x03, 0xf5, 0x1e, 0x6a, 0xc2,
+  0xe6, 0x1d, 0x71, 0x21, 0x0b, 0xe3, 0x0e, 0x91, 0xa2, 0x84, 0x73, 0xd8, 0x3d, 0x70, 0xe3, 0x30,
+  0x22, 0x94, 0xb1, 0x2f, 0x79, 0x95, 0x5b, 0x9b, 0xb2, 0x98, 0x1b, 0x70, 0xd2, 0xac, 0xda, 0xcc,
+  0x0a, 0xbb, 0xd4, 0xe5, 0x7a, 0x8b, 0xf2, 0x4b, 0x1d, 0x8a, 0x3f, 0x7f, 0xbb, 0x71, 0xd5, 0x56,
+  0x95, 0xa6, 0xa2, 0x55, 0xa6, 0x9a, 0x94, 0x5b, 0x6d, 0x55, 0x49, 0xdd, 0xce, 0x2a, 0x9a, 0xce,
+  0xdb, 0xd4, 0x55, 0xfd, 0x6a, 0xcd, 0xd7, 0x71, 0x01, 0x54, 0x2d, 0x6e, 0xb1, 0xaa, 0xb5, 0x1e,
+  0xd8, 0x04, 0xf4, 0xa5, 0x4a, 0xe1, 0xb7, 0x56, 0xb2, 0xab, 0xb7, 0x09, 0x6b, 0x92, 0xc5, 0xc6,
+  0x47, 0x00, 0x61, 0x1d, 0x44, 0xfb, 0x0e, 0x0d, 0x54, 0x4b, 0xd3, 0x7a, 0xc4, 0x69, 0xaa, 0x4d,
+  0x9d, 0x4a, 0x85, 0xc1, 0xad, 0x95, 0xdb, 0x1a, 0x19, 0x7b, 0xd4, 0x65, 0x52, 0xad, 0x56, 0xc8,
+  0xe6, 0xd4, 0xa6, 0xa6, 0xc3, 0xc9, 0x0a, 0xec, 0x50, 0xb5, 0x6a, 0xcd, 0xec, 0x50, 0x9f, 0xab,
+  0x0a, 0xd4, 0x86, 0x3b, 0x23, 0x4c, 0xe3, 0x96, 0xf8, 0x58, 0x12, 0x7c, 0x42, 0x7d, 0x31, 0xcc,
+  0x5f, 0x1f, 0xbc, 0xbf, 0x51, 0x34, 0x70, 0x4b, 0xda, 0x47, 0x83, 0xaa, 0x4b, 0xd7, 0xc8, 0xa5,
+  0x55, 0xd0, 0x59, 0x67, 0xa1, 0x6f, 0x51, 0xf0, 0x94, 0xe2, 0x53, 0x80, 0xbe, 0xd3, 0x40, 0x67,
+  0x6e, 0x97, 0x06, 0x01, 0x9c, 0xb5, 0xaa, 0x2a, 0xd5, 0xa4, 0x7b, 0x72, 0xaa, 0x5d, 0x45, 0xc4,
+  0xe9, 0x1e, 0x5e, 0xee, 0xab, 0x54, 0x07, 0x7a, 0x32, 0x61, 0x46, 0xd2, 0x6b, 0xb5, 0xab, 0xb6,
+  0x6e, 0xb5, 0x75, 0x79, 0x08, 0xac, 0x19, 0xe7, 0xef, 0x12, 0xf5, 0x6c, 0x4f, 0x34, 0x75, 0x4d,
+  0x4f, 0x35, 0xc1, 0x0b, 0x9d, 0xb3, 0xcb, 0xce, 0x3a, 0xb5, 0xd5, 0x22, 0x84, 0xef, 0x23, 0xe6,
+  0xb8, 0xaa, 0x42, 0xf2, 0x44, 0xd1, 0x36, 0xb5, 0xbb, 0x65, 0x45, 0x19, 0x89, 0xe2, 0x20, 0x89,
+  0x8f, 0x04, 0xe1, 0xc3, 0x21, 0x11, 0xc6, 0xb8, 0x88, 0x32, 0x0c, 0xa2, 0x5d, 0x6f, 0x21, 0xd5,
+  0x8f, 0xf2, 0x26, 0x2e, 0x34, 0xde, 0x56, 0xe1, 0xaa, 0xc2, 0x11, 0x75, 0x21, 0x7e, 0x0b, 0x21,
+  0xf2, 0xf1, 0xae, 0x3c, 0x24, 0x12, 0x61, 0x79, 0xe8, 0xfb, 0xd0, 0x71, 0x21, 0x65, 0xf6, 0x26,
+  0x1c, 0x06, 0xce, 0xf6, 0xac, 0xf6, 0x26, 0xf9, 0x19, 0x28, 0xe3, 0x15, 0xac, 0xc1, 0x67, 0x48,
+  0x22, 0x22, 0xda, 0x8f, 0xc5, 0x24, 0x8f, 0xad, 0x51, 0xff, 0xe6, 0x70, 0x4a, 0x01, 0xa7, 0x3c,
+  0x1d, 0xdc, 0xc7, 0xf1, 0x77, 0xdf, 0x95, 0x2a, 0x38, 0x0c, 0xe4, 0x9b, 0x58, 0x5a, 0x0a, 0x29,
+  0xaf, 0x47, 0x05, 0xbf, 0x90, 0x80, 0xe5, 0x2f, 0xf5, 0xcf, 0x2b, 0x92, 0x36, 0x95, 0xb2, 0x92,
+  0x14, 0x98, 0x8a, 0xd0, 0x7a, 0xb6, 0x87, 0xeb, 0x77, 0x11, 0xc6, 0xa8, 0xe0, 0x73, 0xf0, 0x6b,
+  0xa3, 0x50, 0x28, 0x80, 0x23, 0xec, 0x6a, 0x7d, 0xb1, 0x0e, 0x50, 0x73, 0x5b, 0xaa, 0xa6, 0x07,
+  0x90, 0x6c, 0x54, 0x35, 0x8c, 0xac, 0x71, 0x0e, 0xf4, 0xc3, 0x4e, 0x73, 0xb7, 0x32, 0xb5, 0x09,
+  0xc0, 0x0e, 0x5d, 0x4b, 0x90, 0x37, 0x0f, 0x54, 0xc7, 0xd6, 0x7a, 0x32, 0xda, 0xab, 0x13, 0xd3,
+  0x01, 0xc6, 0x48, 0x48, 0x56, 0x7c, 0xca, 0x43, 0x1f, 0x48, 0xff, 0xfc, 0x35, 0x93, 0xb7, 0xf5,
+  0x66, 0x87, 0x01, 0xde, 0xd1, 0x84, 0x18, 0x0c, 0xab, 0xef, 0x2a, 0x7f, 0x50, 0xb4, 0xbc, 0x30,
+  0xa5, 0xec, 0x86, 0x1d, 0xbc, 0x5c, 0x1e, 0x2a, 0x43, 0x8a, 0x69, 0x76, 0xb9, 0x36, 0x02, 0x92,
+  0x27, 0x20, 0x78, 0xe3, 0xc3, 0x0f, 0xea, 0xd4, 0xf4, 0xad, 0xf6, 0x92, 0xe9, 0x9b, 0xdd, 0x40,
+  0xed, 0xc1, 0xa0, 0xcd, 0x14, 0xa0, 0xcc, 0x2a, 0x98, 0xa9, 0x88, 0x1d, 0x56, 0xd1, 0xb2, 0xa4,
+  0x21, 0x1f, 0x97, 0x99, 0x22, 0xc6, 0x40, 0x2a, 0x99, 0x67, 0xaa, 0x55, 0x54, 0xa6, 0x11, 0x4f,
+  0x87, 0xb3, 0x16, 0x64, 0x2f, 0x0e, 0xcd, 0x9a, 0x49, 0x7f, 0xe3, 0x60, 0x3f, 0x67, 0x4a, 0xb6,
+  0x91, 0xf4, 0x4e, 0x84, 0x06, 0xee, 0x92, 0x4a, 0xec, 0x78, 0xb5, 0x5a, 0x55, 0xe2, 0x2d, 0x4e,
+  0x19, 0x8a, 0x09, 0xa0, 0x3f, 0x3b, 0x6a, 0x46, 0x79, 0x70, 0xa8, 0xa7, 0xc7, 0x0b, 0x85, 0x4d,
+  0x0b, 0x84, 0x8a, 0xfd, 0x8a, 0xda, 0x43, 0x51, 0x26, 0xb4, 0x66, 0x15, 0x43, 0x0a, 0x49, 0xee,
+  0x52, 0xf4, 0xb6, 0x4f, 0x9b, 0x55, 0xc8, 0xca, 0x75, 0xbc, 0x4e, 0x3c, 0xaf, 0xbc, 0xeb, 0xc1,
+  0xea, 0x4d, 0x99, 0xc1, 0x86, 0x6b, 0x91, 0x61, 0x54, 0x05, 0x91, 0xfe, 0x52, 0x48, 0xff, 0x4f,
+  0xd1, 0x94, 0x1a, 0x82, 0xaa, 0xb9, 0x66, 0x3a, 0x9c, 0xa8, 0xf2, 0x2b, 0xcd, 0xa2, 0x71, 0xac,
+  0xd0, 0x15, 0x4c, 0x5b, 0x41, 0xa0, 0xc7, 0xa6, 0x27, 0x52, 0xfb, 0x81, 0xf4, 0x0c, 0x74, 0x8b,
+  0x85, 0x2e, 0x3f, 0x2f, 0x73, 0xe8, 0x6c, 0x2f, 0x7e, 0xde, 0x24, 0xa3, 0x6d, 0x09, 0xef, 0x3e,
+  0x64, 0x8a, 0x04, 0xc0, 0xbb, 0xd4, 0x6f, 0x6d, 0xdc, 0xb9, 0xd9, 0x96, 0xf9, 0xf7, 0xf3, 0xf3,
+  0xc1, 0x23, 0xec, 0x92, 0x35, 0x09, 0x11, 0x77, 0x5d, 0x67, 0x7b, 0x6a, 0x90, 0x24, 0xf9, 0x9d,
+  0xee, 0x85, 0x5b, 0xc6, 0xed, 0x7c, 0x92, 0x4c, 0xe9, 0x7c, 0x3f, 0x98, 0xba, 0x30, 0x09, 0xa9,
+  0xe6, 0x8e, 0xb5, 0x70, 0xab, 0x20, 0x66, 0x68, 0x29, 0xd2, 0xd9, 0x7c, 0xbb, 0xf5, 0xfd, 0xd8,
+  0x10, 0xe3, 0xf0, 0x90, 0x09, 0x99, 0x1f, 0xc4, 0x99, 0x7f, 0x07, 0x4c, 0x1e, 0x3c, 0x02, 0x46,
+  0x94, 0x37, 0x31, 0x07, 0xfc, 0x53, 0x10, 0x0b, 0x4d, 0xdd, 0xb4, 0x6d, 0x41, 0xe1, 0x1f, 0x40,
+  0x64, 0xd1, 0x55, 0x40, 0xa5, 0x38, 0x51, 0x28, 0x59, 0x22, 0x81, 0x32, 0xe4, 0x6e, 0xc8, 0x51,
+  0x5f, 0xf0, 0xfb, 0x45, 0xda, 0x34, 0xc3, 0x0e, 0x4f, 0x83, 0xc2, 0xaf, 0x8e, 0xaf, 0x55, 0x60,
+  0x02, 0x2b, 0x66, 0x7b, 0x5d, 0xca, 0xdb, 0xcc, 0x2e, 0x2b, 0x4b, 0x8b, 0xf5, 0x65, 0x58, 0x63,
+  0x66, 0x6f, 0x94, 0x8f, 0x42, 0x17, 0xb6, 0x5d, 0x86, 0xba, 0x1d, 0x88, 0xc0, 0x54, 0x9b, 0x9a,
+  0xb6, 0x99, 0x40, 0xc5, 0xd7, 0xd9, 0x4a, 0xc2, 0x2e, 0x6c, 0x65, 0xf2, 0x6e, 0xcb, 0x20, 0x25,
+  0x2a, 0x6c, 0x45, 0x17, 0xb5, 0x9b, 0x1e, 0xbf, 0xc5, 0xa8, 0x2a, 0xe2, 0x2d, 0x9d, 0x52, 0x01,
+  0x90, 0x2d, 0x43, 0xf5, 0xcb, 0x42, 0x2e, 0xf6, 0xc0, 0xc3, 0xe3, 0xf0, 0x75, 0x87, 0x82, 0xef,
+  0x46, 0x0a, 0xf8, 0x36, 0x30, 0x4e, 0xc2, 0x64, 0xab, 0xfc, 0x07, 0xde, 0x59, 0x43, 0xf1, 0x02,
+  0x05, 0x06, 0x42, 0x1c, 0x6d, 0x83, 0xb2, 0x32, 0xae, 0x03, 0xa0, 0x9c, 0xc0, 0x37, 0x22, 0xf8,
+  0x82, 0x44, 0xbc, 0xce, 0xfe, 0x2f, 0xa3, 0x2a, 0x24, 0xcf, 0xdf, 0x1e, 0x00, 0x00,
+};
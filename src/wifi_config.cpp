@@ -1,127 +1,372 @@
 #include "wifi_config.h"
+#include "web_ui.h"
+#include "ring_store.h"
+#include "history.h"
+#include "sensors.h"
 #include <WiFi.h>
 #include <WebServer.h>
-#include <Preferences.h>
+#include "config_store.h"
+#include "metrics.h"
+#include "pipeline.h"
 
 static const char* AP_SSID = "ESP32-CONFIG";
 static const char* AP_PASS = "12345678";
 
-static Preferences prefs;
 static WebServer web(80);
 
-static Config cfg; // local copy
+static bool requireAuth() {
+  ConfigSnapshot cfg = ConfigGet();
+  const String u = cfg->adminLogin.length() ? cfg->adminLogin : "admin";
+  const String p = cfg->adminPass.length()  ? cfg->adminPass  : "admin";
+  if (!web.authenticate(u.c_str(), p.c_str())) {
+    web.requestAuthentication();
+    return false;
+  }
+  return true;
+}
 
-static String prefGetString(const char* key, const char* defVal) {
-  return prefs.getString(key, defVal);
+// строка JSON с экранированием (значения вводит пользователь)
+static void jsonAddStr(String& out, const char* key, const String& val) {
+  out += '"'; out += key; out += "\":\"";
+  for (size_t i = 0; i < val.length(); i++) {
+    char c = val[i];
+    if (c == '"' || c == '\\') { out += '\\'; out += c; }
+    else if ((uint8_t)c < 0x20) { char esc[8]; snprintf(esc, sizeof(esc), "\\u%04x", c); out += esc; }
+    else out += c;
+  }
+  out += "\",";
 }
-static uint16_t prefGetUShort(const char* key, uint16_t defVal) {
-  return prefs.getUShort(key, defVal);
+
+// калибровка CT в форме — список через запятую по каналам
+static String ctList(const Config& c, bool offset) {
+  String s;
+  for (uint8_t i = 0; i < CT_MAX_CHANNELS; i++) {
+    if (i) s += ',';
+    s += String(offset ? c.ct[i].offsetA : c.ct[i].ical, offset ? 2 : 1);
+  }
+  return s;
 }
-static void loadConfig() {
-  cfg.serverHost = prefGetString("serverHost", "78.138.169.178");
-  cfg.serverPort = prefGetUShort("serverPort", 33775);
-  cfg.location   = prefGetString("location", "");
-  if (cfg.location.length() > 500) cfg.location = cfg.location.substring(0, 500);
 
-  cfg.cryptoPass = prefGetString("cryptoPass", "12345678");
-  cfg.adminLogin = prefGetString("adminLogin", "admin");
-  cfg.adminPass  = prefGetString("adminPass",  "admin");
-  cfg.voltage = prefs.getFloat("voltage", 220.0);
+static void ctParse(Config& c, const String& list, bool offset) {
+  int p = 0;
+  for (uint8_t i = 0; i < CT_MAX_CHANNELS && p <= (int)list.length(); i++) {
+    int e = list.indexOf(',', p);
+    if (e < 0) e = list.length();
+    String v = list.substring(p, e);
+    v.trim();
+    if (v.length()) {
+      float x = v.toFloat();
+      if (offset) c.ct[i].offsetA = x;
+      else if (x > 0) c.ct[i].ical = x;
+    }
+    p = e + 1;
+  }
 }
-static void saveConfig() {
-  prefs.putString("serverHost", cfg.serverHost);
-  prefs.putUShort("serverPort", cfg.serverPort);
-  prefs.putString("location", cfg.location);
-  prefs.putString("cryptoPass", cfg.cryptoPass);
-  prefs.putString("adminLogin", cfg.adminLogin);
-  prefs.putString("adminPass",  cfg.adminPass);
-  prefs.putFloat("voltage", cfg.voltage);
+
+static String configJson() {
+  ConfigSnapshot cfg = ConfigGet();
+  String j; j.reserve(384 + cfg->location.length());
+  j += "{";
+  jsonAddStr(j, "serverHost", cfg->serverHost);
+  j += "\"serverPort\":" + String(cfg->serverPort) + ",";
+  j += "\"udpPort\":" + String(cfg->udpPort) + ",";
+  j += "\"uplinkMaxS\":" + String(cfg->uplinkMaxS) + ",";
+  jsonAddStr(j, "cryptoPass", cfg->cryptoPass);
+  jsonAddStr(j, "location",   cfg->location);
+  j += "\"voltage\":" + String(cfg->voltage, 1) + ",";
+  j += "\"ctChannels\":" + String(cfg->ctChannels) + ",";
+  j += "\"ctNeutral\":" + String(cfg->ctNeutral ? 1 : 0) + ",";
+  jsonAddStr(j, "ctCal",      ctList(*cfg, false));
+  jsonAddStr(j, "ctOffset",   ctList(*cfg, true));
+  j += "\"heatMinOnS\":" + String(cfg->heatMinOnS) + ",";
+  j += "\"heatMinOffS\":" + String(cfg->heatMinOffS) + ",";
+  jsonAddStr(j, "wifiSsid",   cfg->wifiSsid);
+  jsonAddStr(j, "wifiPass",   cfg->wifiPass);
+  jsonAddStr(j, "adminLogin", cfg->adminLogin);
+  jsonAddStr(j, "adminPass",  cfg->adminPass);
+  j.remove(j.length() - 1);
+  j += "}";
+  return j;
 }
 
-static bool requireAuth() {
-  const String u = cfg.adminLogin.length() ? cfg.adminLogin : "admin";
-  const String p = cfg.adminPass.length()  ? cfg.adminPass  : "admin";
-  if (!web.authenticate(u.c_str(), p.c_str())) {
-    web.requestAuthentication();
-    return false;
+// ===================== EXPORT =====================
+// GET /export?fmt=raw|csv|ndjson&from=<ts>&to=<ts>&ack=1&src=queue|history
+// Кольцо (или архив, src=history) читается окнами по EXPORT_WINDOW записей и сразу
+// уходит chunked-ответом, так что память не зависит от объёма выгрузки.
+// Архив ищет по индексу блоков: блоки вне [from, to] не читаются; ack к нему не относится.
+// raw: подряд SampleRec v2 по 32 байта (LE: ts u32, current_mA i32, power_dW i32, temp_cC i16,
+//      flags u16, ch_cA i16[4], tempX_cC i16[3], nCurrent u8, nTemp u8).
+// csv: пустые ячейки каналов — канала нет.
+// ack=1: после полной отправки удаляется непрерывный от хвоста участок,
+// целиком попавший в выгрузку (битые слоты — вместе с ним).
+enum ExportFmt { EXP_RAW, EXP_CSV, EXP_NDJSON };
+
+static const size_t EXPORT_WINDOW = 64;
+static const size_t EXPORT_CHUNK  = 1460;  // ~один TCP-сегмент
+
+static void sseService(uint32_t waitMs);
+
+static void exportRecord(String& out, ExportFmt fmt, const SampleRec& r) {
+  char line[112];
+  if (fmt == EXP_CSV) {
+    snprintf(line, sizeof(line), "%lu,%ld,%ld,%d,%u",
+             (unsigned long)r.ts, (long)r.current_mA, (long)r.power_dW, r.temp_cC, r.flags);
+    out += line;
+    for (uint8_t i = 0; i < REC_CURRENT_CH; i++) {
+      out += ',';
+      if (i < r.nCurrent) out += r.ch_cA[i];
+    }
+    for (uint8_t i = 1; i < REC_TEMP_CH; i++) {
+      out += ',';
+      if (i < r.nTemp) out += r.tempX_cC[i - 1];
+    }
+    out += '\n';
+    return;
   }
-  return true;
+
+  snprintf(line, sizeof(line),
+           "{\"ts\":%lu,\"current_mA\":%ld,\"power_dW\":%ld,\"temp_cC\":%d,\"flags\":%u",
+           (unsigned long)r.ts, (long)r.current_mA, (long)r.power_dW, r.temp_cC, r.flags);
+  out += line;
+  if (r.nCurrent > 1) {
+    out += ",\"ch_cA\":[";
+    for (uint8_t i = 0; i < r.nCurrent; i++) { if (i) out += ','; out += r.ch_cA[i]; }
+    out += ']';
+  }
+  if (r.nTemp > 1) {
+    out += ",\"t_cC\":[";
+    out += r.temp_cC;
+    for (uint8_t i = 1; i < r.nTemp; i++) { out += ','; out += r.tempX_cC[i - 1]; }
+    out += ']';
+  }
+  out += "}\n";
 }
 
-static String htmlPage() {
-  String h; h.reserve(5200);
-  h += "<!doctype html><html lang='ru'><head>";
-  h += "<meta charset='utf-8'/>";
-  h += "<meta name='viewport' content='width=device-width, initial-scale=1'/>";
-  h += "<title>ESP32 Config</title>";
-  h += "<style>";
-  h += "body{font-family:system-ui,-apple-system,Segoe UI,Roboto,Arial;margin:0;background:#0b1220;color:#e8eefc;}";
-  h += ".wrap{max-width:720px;margin:0 auto;padding:16px;}";
-  h += ".card{background:#121b2e;border:1px solid rgba(255,255,255,.08);border-radius:16px;padding:16px;box-shadow:0 8px 24px rgba(0,0,0,.25);}";
-  h += "h1{font-size:20px;margin:0 0 12px;}";
-  h += "label{display:block;margin:10px 0 6px;font-size:14px;opacity:.95;}";
-  h += "input,textarea{width:100%;padding:12px;border-radius:12px;border:1px solid rgba(255,255,255,.12);background:#0b1220;color:#e8eefc;outline:none;}";
-  h += "textarea{min-height:110px;resize:vertical;}";
-  h += ".row{display:grid;grid-template-columns:1fr 1fr;gap:12px;}";
-  h += "@media(max-width:560px){.row{grid-template-columns:1fr;}}";
-  h += ".btn{margin-top:14px;width:100%;padding:12px 14px;border:0;border-radius:12px;background:#2a66ff;color:white;font-size:16px;font-weight:600;}";
-  h += ".muted{opacity:.75;font-size:12px;line-height:1.35;margin-top:10px;}";
-  h += ".ok{padding:10px 12px;border-radius:12px;background:rgba(40,180,99,.15);border:1px solid rgba(40,180,99,.25);margin-bottom:12px;display:none;}";
-  h += "</style></head><body><div class='wrap'><div class='card'>";
-  h += "<h1>Настройки устройства</h1>";
-  h += "<div id='ok' class='ok'>✅ Сохранено!</div>";
-  h += "<form id='f'>";
-
-  h += "<label>Адрес сервера (IP/домен)</label>";
-  h += "<input name='serverHost' required value='" + cfg.serverHost + "'/>";
-
-  h += "<div class='row'>";
-  h += "<div><label>Порт</label>";
-  h += "<input name='serverPort' type='number' min='1' max='65535' required value='" + String(cfg.serverPort) + "'/></div>";
-  h += "<div><label>Пароль шифрования</label>";
-  h += "<input name='cryptoPass' minlength='8' value='" + cfg.cryptoPass + "'/></div>";
-  h += "</div>";
-
-  h += "<label>Местоположение (до 500 символов)</label>";
-  h += "<textarea name='location' maxlength='500'>";
-  h += cfg.location;
-  h += "</textarea>";
-  h += "<label>Напряжение сети (В)</label>";
-  h += "<input name='voltage' type='number' step='0.1' value='" + String(cfg.voltage) + "'/>";
-  h += "<h1 style='margin-top:18px'>Доступ</h1>";
-  h += "<div class='row'>";
-  h += "<div><label>Логин</label><input name='adminLogin' value='" + cfg.adminLogin + "'/></div>";
-  h += "<div><label>Пароль</label><input name='adminPass' value='" + cfg.adminPass + "'/></div>";
-  h += "</div>";
-
-  h += "<button class='btn' type='submit'>Сохранить</button>";
-  h += "<div class='muted'>Wi-Fi включается только при замыкании GPIO4 на GND при старте.<br>";
-  h += "Сеть: <b>ESP32-CONFIG</b> пароль: <b>12345678</b> адрес: <b>http://192.168.4.1/</b></div>";
-  h += "</form>";
-
-  h += "<script>";
-  h += "const f=document.getElementById('f');";
-  h += "f.addEventListener('submit', async (e)=>{e.preventDefault();";
-  h += "const fd=new FormData(f); const p=new URLSearchParams();";
-  h += "for(const [k,v] of fd.entries()) p.append(k,v);";
-  h += "const r=await fetch('/save',{method:'POST',body:p});";
-  h += "if(r.ok){const ok=document.getElementById('ok');ok.style.display='block';setTimeout(()=>ok.style.display='none',1800);}else alert('Ошибка');";
-  h += "});";
-  h += "</script>";
-
-  h += "</div></div></body></html>";
-  return h;
+static void handleExport() {
+  if (!requireAuth()) return;
+
+  String f = web.hasArg("fmt") ? web.arg("fmt") : "csv";
+  ExportFmt fmt = f == "raw" ? EXP_RAW : f == "ndjson" ? EXP_NDJSON : EXP_CSV;
+  uint32_t from = web.hasArg("from") ? (uint32_t)web.arg("from").toInt() : 0;
+  uint32_t to   = web.hasArg("to")   ? (uint32_t)web.arg("to").toInt()   : UINT32_MAX;
+  bool hist = web.hasArg("src") && web.arg("src") == "history";
+  bool ack = !hist && web.hasArg("ack") && web.arg("ack") == "1";
+
+  // последние замеры ещё в RTC-буфере хранения — дописать, чтобы попали в выгрузку
+  PipelineFlush(1000);
+
+  const char* ctype = fmt == EXP_RAW ? "application/octet-stream"
+                    : fmt == EXP_NDJSON ? "application/x-ndjson" : "text/csv";
+  const char* ext   = fmt == EXP_RAW ? "bin" : fmt == EXP_NDJSON ? "ndjson" : "csv";
+
+  web.sendHeader("Content-Disposition", String("attachment; filename=\"") + (hist ? "history." : "queue.") + ext + "\"");
+  web.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  web.send(200, ctype, "");
+
+  String buf;
+  buf.reserve(EXPORT_CHUNK + 128);
+  if (fmt == EXP_CSV) buf += "ts,current_mA,power_dW,temp_cC,flags,ch1_cA,ch2_cA,ch3_cA,ch4_cA,t2_cC,t3_cC,t4_cC\n";
+
+  static uint8_t raw[(EXPORT_CHUNK / sizeof(SampleRec)) * sizeof(SampleRec)];
+  size_t rawLen = 0;
+
+  std::vector<SampleRec> win;
+  win.reserve(EXPORT_WINDOW);
+
+  // позиции в кольце — абсолютные (как RingStoreTail): аплинк сдвигает хвост,
+  // пока идёт выгрузка, смещение от хвоста «поехало» бы
+  RingStoreLock();
+  uint32_t pos = RingStoreTail();
+  RingStoreUnlock();
+  uint32_t ackEnd = pos;   // конец непрерывного выгруженного участка
+  bool contiguous = true;
+  size_t sent = 0;
+  uint32_t t0 = millis();
+  uint32_t histPos = 0;
+  bool histMore = true;
+
+  while (true) {
+    size_t slots;
+    if (hist) {
+      if (!histMore) break;
+      histMore = HistoryRead(histPos, from, to, win, EXPORT_WINDOW);
+      slots = win.size();
+      if (!slots && !histMore) break;
+    } else {
+      // хвост и окно от него — под замком; кольцо держим только на чтение окна
+      RingStoreLock();
+      uint32_t tail = RingStoreTail();
+      if ((int32_t)(tail - pos) > 0) pos = tail;   // начало уже снял аплинк — оно доставлено
+      slots = RingStorePeek(pos - tail, win, EXPORT_WINDOW);
+      RingStoreUnlock();
+      if (slots == 0) break;
+    }
+
+    for (const SampleRec& r : win) {
+      bool match = r.ts >= from && r.ts <= to;
+      if (!match) { contiguous = false; continue; }
+
+      if (fmt == EXP_RAW) {
+        memcpy(raw + rawLen, &r, sizeof(r));
+        rawLen += sizeof(r);
+        if (rawLen == sizeof(raw)) {
+          web.sendContent((const char*)raw, rawLen);
+          rawLen = 0;
+        }
+      } else {
+        exportRecord(buf, fmt, r);
+        if (buf.length() >= EXPORT_CHUNK) {
+          web.sendContent(buf);
+          buf = "";
+        }
+      }
+      sent++;
+    }
+
+    pos += slots;
+    if (contiguous) ackEnd = pos;
+    if (!web.client().connected()) break;
+    // выгрузка занимает задачу веб-сервера надолго — живые вкладки (SSE) не ждут её конца
+    sseService(0);
+  }
+
+  if (rawLen) web.sendContent((const char*)raw, rawLen);
+  if (buf.length()) web.sendContent(buf);
+  web.sendContent("");   // завершающий chunk
+
+  bool complete = web.client().connected();
+  if (ack && complete) {
+    // снимаем только выгруженное: то, что за время выгрузки снял аплинк, уже не в счёт
+    RingStoreLock();
+    int32_t n = (int32_t)(ackEnd - RingStoreTail());
+    if (n > 0) RingStoreDrop(n);
+    RingStoreUnlock();
+  }
+
+  Serial.printf("Export%s: %u recs in %lu ms%s\n", hist ? " (history)" : "", (unsigned)sent,
+                (unsigned long)(millis() - t0), ack && complete ? ", acked" : "");
+}
+
+// GET /api/history?from=<ts>&to=<ts> — сводка по архиву: из сводок блоков, по записям — только края
+static void handleHistorySummary() {
+  if (!requireAuth()) return;
+  uint32_t from = web.hasArg("from") ? (uint32_t)web.arg("from").toInt() : 0;
+  uint32_t to   = web.hasArg("to")   ? (uint32_t)web.arg("to").toInt()   : UINT32_MAX;
+
+  PipelineFlush(1000);
+  uint32_t t0 = millis();
+  HistAgg a;
+  if (!HistoryAggregate(from, to, a)) {
+    web.send(503, "application/json", "{\"error\":\"history\"}");
+    return;
+  }
+
+  char j[400];
+  snprintf(j, sizeof(j),
+           "{\"count\":%lu,\"first\":%lu,\"last\":%lu,"
+           "\"current_mA\":[%ld,%ld],\"power_dW\":[%ld,%ld],\"temp_cC\":[%d,%d],"
+           "\"energy_Wh\":%.1f,\"heater_h\":%.2f,"
+           "\"blocks\":{\"summary\":%lu,\"scanned\":%lu},\"ms\":%lu}",
+           (unsigned long)a.count, (unsigned long)a.tsFirst, (unsigned long)a.tsLast,
+           (long)a.currentMin_mA, (long)a.currentMax_mA, (long)a.powerMin_dW, (long)a.powerMax_dW,
+           a.tempMin_cC, a.tempMax_cC,
+           a.energy_dWs / 36000.0, a.heaterS / 3600.0,
+           (unsigned long)a.blocksSummary, (unsigned long)a.blocksScanned, (unsigned long)(millis() - t0));
+  web.send(200, "application/json", j);
+}
+
+// ===================== LIVE (SSE) =====================
+// GET /events — text/event-stream с каждым новым замером.
+// Сокет забираем у WebServer и держим сами: обработчик сразу возвращается,
+// поэтому открытые вкладки не занимают цикл обслуживания и не мешают /save.
+// Запись неблокирующая по смыслу: клиент, не принявший событие целиком, отключается.
+static const size_t   SSE_MAX_CLIENTS = 3;
+static const uint32_t SSE_PING_MS = 15000;   // чтобы замечать закрытые вкладки
+static const uint32_t WEB_EV_SENSORS = 1u << 0;
+
+static WiFiClient sseClients[SSE_MAX_CLIENTS];
+static uint32_t sseLastPingMs = 0;
+
+static void handleEvents() {
+  if (!requireAuth()) return;
+
+  for (size_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (sseClients[i].connected()) continue;
+
+    WiFiClient c = web.client();
+    c.setNoDelay(true);
+    c.print("HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/event-stream\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Connection: keep-alive\r\n\r\n"
+            "retry: 3000\n\n");
+    sseClients[i] = c;
+    return;
+  }
+  web.send(503, "text/plain", "busy");
+}
+
+static void ssePublish(const char* data, size_t len) {
+  for (size_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+    WiFiClient& c = sseClients[i];
+    if (!c.connected()) continue;
+    if (c.write((const uint8_t*)data, len) != len) c.stop();
+  }
+}
+
+static void ssePushSensors() {
+  SensorData d;
+  if (!SensorsGetLatest(d)) return;
+
+  char ev[288];
+  int n = snprintf(ev, sizeof(ev),
+                   "data: {\"ts\":%lu,\"tempC\":%.2f,\"currentA\":%.3f,\"powerW\":%.1f,\"heater\":%d,\"ch\":[",
+                   (unsigned long)d.ts, d.tempC, d.currentA, d.powerW, d.heaterState ? 1 : 0);
+  for (uint8_t i = 0; i < d.nCurrent && n > 0 && n < (int)sizeof(ev); i++) {
+    n += snprintf(ev + n, sizeof(ev) - n, "%s%.3f", i ? "," : "", d.currentChA[i]);
+  }
+  if (n > 0 && n < (int)sizeof(ev)) n += snprintf(ev + n, sizeof(ev) - n, "],\"t\":[");
+  for (uint8_t i = 0; i < d.nTemp && n > 0 && n < (int)sizeof(ev); i++) {
+    n += snprintf(ev + n, sizeof(ev) - n, "%s%.2f", i ? "," : "", d.tempChC[i]);
+  }
+  if (n > 0 && n < (int)sizeof(ev)) n += snprintf(ev + n, sizeof(ev) - n, "]}\n\n");
+  if (n > 0 && n < (int)sizeof(ev)) ssePublish(ev, n);
+}
+
+static void ssePing() {
+  if (millis() - sseLastPingMs < SSE_PING_MS) return;
+  sseLastPingMs = millis();
+  static const char ping[] = ": ping\n\n";
+  ssePublish(ping, sizeof(ping) - 1);
+}
+
+// новый замер — разослать; ждём его не дольше waitMs (0 — только проверить)
+static void sseService(uint32_t waitMs) {
+  uint32_t ev = 0;
+  xTaskNotifyWait(0, UINT32_MAX, &ev, pdMS_TO_TICKS(waitMs));
+  if (ev & WEB_EV_SENSORS) ssePushSensors();
+  ssePing();
 }
 
 static void webSetupRoutes() {
   web.on("/", HTTP_GET, []() {
     if (!requireAuth()) return;
-    web.send(200, "text/html; charset=utf-8", htmlPage());
+    // страница статична и лежит во flash уже сжатой (web/index.html -> web_ui.h)
+    web.sendHeader("Content-Encoding", "gzip");
+    web.sendHeader("Cache-Control", "no-cache");
+    web.send_P(200, "text/html; charset=utf-8", (const char*)WEB_INDEX_GZ, WEB_INDEX_GZ_LEN);
+  });
+
+  web.on("/api/config", HTTP_GET, []() {
+    if (!requireAuth()) return;
+    web.sendHeader("Cache-Control", "no-store");
+    web.send(200, "application/json", configJson());
   });
 
   web.on("/save", HTTP_POST, []() {
     if (!requireAuth()) return;
 
+    Config cfg = *ConfigGet();
     if (web.hasArg("serverHost")) cfg.serverHost = web.arg("serverHost");
     if (web.hasArg("serverPort")) cfg.serverPort = (uint16_t)web.arg("serverPort").toInt();
     if (web.hasArg("location"))   cfg.location   = web.arg("location");
@@ -129,15 +374,30 @@ static void webSetupRoutes() {
     if (web.hasArg("adminLogin")) cfg.adminLogin = web.arg("adminLogin");
     if (web.hasArg("adminPass"))  cfg.adminPass  = web.arg("adminPass");
     if (web.hasArg("voltage"))     cfg.voltage = web.arg("voltage").toFloat();
+    if (web.hasArg("wifiSsid"))   cfg.wifiSsid   = web.arg("wifiSsid");
+    if (web.hasArg("wifiPass"))   cfg.wifiPass   = web.arg("wifiPass");
+    if (web.hasArg("udpPort"))    cfg.udpPort    = (uint16_t)web.arg("udpPort").toInt();
+    if (web.hasArg("uplinkMaxS")) cfg.uplinkMaxS = (uint16_t)web.arg("uplinkMaxS").toInt();
+    if (web.hasArg("ctChannels")) cfg.ctChannels = constrain((int)web.arg("ctChannels").toInt(), 1, (int)CT_MAX_CHANNELS);
+    if (web.hasArg("ctNeutral"))  cfg.ctNeutral  = web.arg("ctNeutral") == "1";
+    if (web.hasArg("ctCal"))      ctParse(cfg, web.arg("ctCal"), false);
+    if (web.hasArg("ctOffset"))   ctParse(cfg, web.arg("ctOffset"), true);
+    if (web.hasArg("heatMinOnS"))  cfg.heatMinOnS  = constrain((int)web.arg("heatMinOnS").toInt(), 0, 3600);
+    if (web.hasArg("heatMinOffS")) cfg.heatMinOffS = constrain((int)web.arg("heatMinOffS").toInt(), 0, 3600);
     if (cfg.location.length() > 500) cfg.location = cfg.location.substring(0, 500);
-    if (cfg.cryptoPass.length() < 8) cfg.cryptoPass = "12345678";
-    if (!cfg.serverPort) cfg.serverPort = 33775;
-    if (!cfg.serverHost.length()) cfg.serverHost = "78.138.169.178";
+    ConfigSnapshot def = ConfigDefaults();
+    if (cfg.cryptoPass.length() < 8) cfg.cryptoPass = def->cryptoPass;
+    if (!cfg.serverPort) cfg.serverPort = def->serverPort;
+    if (!cfg.serverHost.length()) cfg.serverHost = def->serverHost;
 
-    saveConfig();
+    ConfigSave(cfg);   // NVS пишется только при реальных изменениях
     web.send(200, "text/plain; charset=utf-8", "OK");
   });
 
+  web.on("/export", HTTP_GET, handleExport);
+  web.on("/api/history", HTTP_GET, handleHistorySummary);
+  web.on("/events", HTTP_GET, handleEvents);
+
   web.onNotFound([]() {
     web.sendHeader("Location", "/");
     web.send(302, "text/plain", "");
@@ -146,6 +406,7 @@ static void webSetupRoutes() {
 
 static void wifiTask(void* pv) {
   (void)pv;
+  MetricsTrackTask(xTaskGetCurrentTaskHandle(), "web");
 
   WiFi.mode(WIFI_AP);
   WiFi.softAP(AP_SSID, AP_PASS);
@@ -159,10 +420,13 @@ static void wifiTask(void* pv) {
   web.begin();
   Serial.println("WiFi config web server started");
 
-  // Асинхронность: отдельная задача, которая постоянно обслуживает клиентов
+  SensorsSubscribe(xTaskGetCurrentTaskHandle(), WEB_EV_SENSORS);
+
+  // Цикл по событиям: новый замер будит задачу сразу (рассылка SSE),
+  // а handleClient() не блокирует и опрашивается с шагом ожидания уведомления
   while (true) {
     web.handleClient();
-    vTaskDelay(pdMS_TO_TICKS(10));
+    sseService(5);
   }
 }
 
@@ -172,21 +436,7 @@ bool WifiConfigModeActive() {
   return (digitalRead(WIFI_CFG_PIN) == LOW);
 }
 
-void WifiConfigStart(const Config& initialCfg) {
-  prefs.begin("cfg", false);
-  loadConfig();
-
-  // если Preferences пустые — заполним дефолтами из initialCfg
-  // (не затираем существующие)
-  if (!prefs.isKey("serverHost")) cfg.serverHost = initialCfg.serverHost;
-  if (!prefs.isKey("serverPort")) cfg.serverPort = initialCfg.serverPort;
-  if (!prefs.isKey("location"))   cfg.location = initialCfg.location;
-  if (!prefs.isKey("cryptoPass")) cfg.cryptoPass = initialCfg.cryptoPass;
-  if (!prefs.isKey("adminLogin")) cfg.adminLogin = initialCfg.adminLogin;
-  if (!prefs.isKey("adminPass"))  cfg.adminPass  = initialCfg.adminPass;
-
-  saveConfig();
-
+void WifiConfigStart() {
   // Запускаем WiFi таску на core 0 (обычно WiFi/Netstack удобнее там)
-  xTaskCreatePinnedToCore(wifiTask, "wifiTask", 8192, nullptr, 2, nullptr, 0);
+  xTaskCreatePinnedToCore(wifiTask, "wifiTask", 8192, nullptr, PRIO_WEB, nullptr, CORE_IO);
 }
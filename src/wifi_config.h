@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "current_sampler.h"
 
 // GPIO4 (D4) -> GND => WiFi config only
 static const gpio_num_t WIFI_CFG_PIN = GPIO_NUM_15;
@@ -12,7 +13,16 @@ struct Config {
   String adminLogin;   // default admin
   String adminPass;    // default admin
    float voltage;   // ← ДОБАВИТЬ
+  String wifiSsid;     // WiFi STA для аплинка в обычном режиме ("" — выкл)
+  String wifiPass;
+  uint16_t udpPort;    // датаграммный аплинк (udp.php), 0 — только HTTP
+  uint16_t uplinkMaxS; // наибольшая задержка доставки, с; между пакетами модем спит (0 — GPRS всегда)
+  uint8_t ctChannels;  // каналов тока, 1..CT_MAX_CHANNELS (CT_PINS по порядку)
+  bool    ctNeutral;   // последний канал — нейтраль: пишется, но в сумму по фазам не входит
+  CtCal   ct[CT_MAX_CHANNELS];
+  uint16_t heatMinOnS;  // нагреватель: минимум во включённом состоянии, с
+  uint16_t heatMinOffS; // и в выключенном (отказ датчика выключает без ожидания)
 };
 
 bool WifiConfigModeActive();   // true if GPIO4 grounded at boot
-void WifiConfigStart(const Config& initialCfg); // starts AP + web task
+void WifiConfigStart();        // starts AP + web task (config — из config_store)
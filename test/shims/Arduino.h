@@ -0,0 +1,112 @@
+#pragma once
+// Подмена Arduino-ядра для тестов на хосте (env:native): ровно то, чем пользуются
+// модули без железа. Время — виртуальное, его двигает сам тест (HostClockSet/Advance).
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+// ===================== CLOCK =====================
+extern uint32_t hostNowMs;
+extern uint32_t hostNowUs;
+
+inline unsigned long millis() { return hostNowMs; }
+inline unsigned long micros() { return hostNowUs; }
+inline void delay(uint32_t ms) { hostNowMs += ms; hostNowUs += ms * 1000; }
+
+inline void HostClockSet(uint32_t ms) { hostNowMs = ms; hostNowUs = ms * 1000; }
+inline void HostClockAdvance(uint32_t ms) { delay(ms); }
+
+// ===================== STRING =====================
+class String {
+public:
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const char* c, unsigned int n) : s(c, n) {}
+  String(const std::string& x) : s(x) {}
+  String(char c) : s(1, c) {}
+  String(int v, unsigned char base = 10) { fmtInt((long)v, base); }
+  String(unsigned v, unsigned char base = 10) { fmtUInt(v, base); }
+  String(long v, unsigned char base = 10) { fmtInt(v, base); }
+  String(unsigned long v, unsigned char base = 10) { fmtUInt(v, base); }
+
+  unsigned int length() const { return (unsigned int)s.size(); }
+  const char* c_str() const { return s.c_str(); }
+  bool reserve(unsigned int n) { s.reserve(n); return true; }
+  char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  char& operator[](unsigned int i) { return s[i]; }
+
+  bool concat(const char* c, unsigned int n) { s.append(c, n); return true; }
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* c) { if (c) s += c; return *this; }
+  String& operator+=(char c) { s += c; return *this; }
+  String& operator+=(int v) { return *this += String(v); }
+  String& operator+=(unsigned v) { return *this += String(v); }
+
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* c) const { return s == (c ? c : ""); }
+  bool operator!=(const String& o) const { return s != o.s; }
+  bool operator!=(const char* c) const { return !(*this == c); }
+
+  int indexOf(char c, unsigned int from = 0) const { return pos(s.find(c, from)); }
+  int indexOf(const char* c, unsigned int from = 0) const { return pos(s.find(c, from)); }
+  int indexOf(const String& o, unsigned int from = 0) const { return pos(s.find(o.s, from)); }
+  bool startsWith(const String& p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+  String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (to > s.size()) to = (unsigned int)s.size();
+    return from < to ? String(s.substr(from, to - from)) : String();
+  }
+  void remove(unsigned int idx) { if (idx < s.size()) s.erase(idx); }
+  void remove(unsigned int idx, unsigned int n) { if (idx < s.size()) s.erase(idx, n); }
+  void trim() {
+    size_t b = 0, e = s.size();
+    while (b < e && isspace((unsigned char)s[b])) b++;
+    while (e > b && isspace((unsigned char)s[e - 1])) e--;
+    s = s.substr(b, e - b);
+  }
+  long toInt() const { return atol(s.c_str()); }
+
+  friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+  friend String operator+(const String& a, const char* b) { return String(a.s + (b ? b : "")); }
+  friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.s); }
+
+private:
+  std::string s;
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  void fmtInt(long v, unsigned char base) {
+    if (base == 10) { s = std::to_string(v); return; }
+    fmtUInt((unsigned long)v, base);
+  }
+  void fmtUInt(unsigned long v, unsigned char base) {
+    char b[40];
+    snprintf(b, sizeof(b), base == 16 ? "%lx" : "%lu", v);
+    s = b;
+  }
+};
+
+// ===================== SERIAL =====================
+// вывод модулей в тестах не нужен: глушим, HOST_VERBOSE=1 — печатать
+class HostSerial {
+public:
+  int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  void print(const char* s)   { if (verbose) fputs(s, stdout); }
+  void print(const String& s) { print(s.c_str()); }
+  void println(const char* s = "") { if (verbose) printf("%s\n", s); }
+  void println(const String& s) { println(s.c_str()); }
+  bool verbose = false;
+};
+extern HostSerial Serial;
@@ -0,0 +1,22 @@
+#pragma once
+// Интерфейс сетевого клиента Arduino (без Stream/IPAddress): транспорты в тестах
+// дают свою реализацию поверх подставного сервера.
+#include <Arduino.h>
+
+class Client {
+public:
+  virtual ~Client() {}
+  virtual int connect(const char* host, uint16_t port) = 0;
+  virtual size_t write(uint8_t b) { return write(&b, 1); }
+  virtual size_t write(const uint8_t* buf, size_t size) = 0;
+  virtual int available() = 0;
+  virtual int read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+  }
+  virtual int read(uint8_t* buf, size_t size) = 0;
+  virtual void flush() {}
+  virtual void stop() = 0;
+  virtual uint8_t connected() = 0;
+  virtual operator bool() { return connected(); }
+};
@@ -0,0 +1,97 @@
+#pragma once
+// Файловая система в памяти: путь -> байты. Файл за пределами конца при seek+write
+// дополняется нулями, как у LittleFS. HostFsClear() — «форматирование».
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+typedef std::shared_ptr<std::vector<uint8_t>> FileData;
+
+class File {
+public:
+  File() {}
+  File(FileData d, bool writable) : data(d), canWrite(writable) {}
+
+  explicit operator bool() const { return (bool)data; }
+  size_t size() const { return data ? data->size() : 0; }
+  size_t position() const { return pos; }
+
+  bool seek(uint32_t off, SeekMode mode = SeekSet) {
+    if (!data) return false;
+    size_t base = mode == SeekCur ? pos : mode == SeekEnd ? data->size() : 0;
+    pos = base + off;
+    return true;
+  }
+
+  size_t read(uint8_t* buf, size_t n) {
+    if (!data || pos >= data->size()) return 0;
+    n = min(n, data->size() - pos);
+    memcpy(buf, data->data() + pos, n);
+    pos += n;
+    return n;
+  }
+  int read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+
+  size_t write(const uint8_t* buf, size_t n) {
+    if (!data || !canWrite) return 0;
+    if (pos + n > data->size()) data->resize(pos + n, 0);
+    memcpy(data->data() + pos, buf, n);
+    pos += n;
+    return n;
+  }
+  size_t write(uint8_t c) { return write(&c, 1); }
+
+  void flush() {}
+  void close() { data.reset(); pos = 0; }
+
+private:
+  FileData data;
+  bool canWrite = false;
+  size_t pos = 0;
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode = "r", bool create = false) {
+    (void)create;
+    auto it = files.find(path);
+    if (mode[0] == 'w') {
+      FileData d = std::make_shared<std::vector<uint8_t>>();
+      files[path] = d;
+      return File(d, true);
+    }
+    if (it == files.end()) return File();
+    return File(it->second, strchr(mode, '+') != nullptr);
+  }
+  File open(const String& path, const char* mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+
+  bool exists(const char* path) { return files.count(path) != 0; }
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool remove(const char* path) { return files.erase(path) != 0; }
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* from, const char* to) {
+    auto it = files.find(from);
+    if (it == files.end()) return false;
+    files[to] = it->second;
+    files.erase(from);
+    return true;
+  }
+  bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+
+  void clear() { files.clear(); }
+
+private:
+  std::map<std::string, FileData> files;
+};
+
+}  // namespace fs
+
+using fs::File;
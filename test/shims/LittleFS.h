@@ -0,0 +1,11 @@
+#pragma once
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+  bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+};
+
+extern LittleFSFS LittleFS;
+
+inline void HostFsClear() { LittleFS.clear(); }
@@ -0,0 +1,65 @@
+#pragma once
+// NVS в памяти процесса: namespace -> ключ -> байты. Переживает «перезагрузку»
+// модуля (повторный begin), сбрасывается только HostNvsClear() — как флеш.
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+typedef std::map<std::string, std::map<std::string, std::vector<uint8_t>>> HostNvs;
+HostNvs& HostNvsData();
+void HostNvsClear();
+
+// сбой питания на записи во флеш: n-я по счёту запись не выполняется, вместо неё —
+// исключение HostPowerCut (тест ловит его и «перезагружает» модуль); -1 — не рвать
+struct HostPowerCut {};
+extern uint32_t hostNvsWrites;
+extern int32_t  hostNvsCutAt;
+extern bool     hostNvsFull;   // запись не проходит (put* возвращает 0), как у заполненного NVS
+
+class Preferences {
+public:
+  bool begin(const char* ns, bool readOnly = false) { name = ns; ro = readOnly; started = true; return true; }
+  void end() { started = false; }
+
+  bool isKey(const char* key) { return started && space().count(key) != 0; }
+  bool remove(const char* key) { return !ro && space().erase(key) != 0; }
+  bool clear() { if (ro) return false; space().clear(); return true; }
+
+  uint32_t getUInt(const char* key, uint32_t def = 0) { return get(key, def); }
+  size_t putUInt(const char* key, uint32_t v) { return put(key, v); }
+  uint16_t getUShort(const char* key, uint16_t def = 0) { return get(key, def); }
+  size_t putUShort(const char* key, uint16_t v) { return put(key, v); }
+  uint8_t getUChar(const char* key, uint8_t def = 0) { return get(key, def); }
+  size_t putUChar(const char* key, uint8_t v) { return put(key, v); }
+
+  size_t getBytes(const char* key, void* buf, size_t maxLen) {
+    auto it = space().find(key);
+    if (it == space().end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+  size_t putBytes(const char* key, const void* buf, size_t len) {
+    if (ro || hostNvsFull) return 0;
+    if (hostNvsCutAt >= 0 && hostNvsCutAt-- == 0) throw HostPowerCut{};
+    hostNvsWrites++;
+    space()[key].assign((const uint8_t*)buf, (const uint8_t*)buf + len);
+    return len;
+  }
+
+private:
+  std::string name;
+  bool ro = false;
+  bool started = false;
+
+  std::map<std::string, std::vector<uint8_t>>& space() { return HostNvsData()[name]; }
+
+  template <typename T>
+  T get(const char* key, T def) {
+    T v = def;
+    auto it = space().find(key);
+    if (it != space().end() && it->second.size() == sizeof(T)) memcpy(&v, it->second.data(), sizeof(T));
+    return v;
+  }
+  template <typename T>
+  size_t put(const char* key, T v) { return putBytes(key, &v, sizeof(T)); }
+};
@@ -0,0 +1,4 @@
+#pragma once
+#include "FreeRTOS.h"
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
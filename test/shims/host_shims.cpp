@@ -0,0 +1,45 @@
+// Определения для подмен из test/shims и заглушки модулей, которые в тестах
+// на хосте не собираются (metrics, dlog).
+#include <Arduino.h>
+#include <Preferences.h>
+#include <LittleFS.h>
+#include "metrics.h"
+#include "dlog.h"
+
+uint32_t hostNowMs = 0;
+uint32_t hostNowUs = 0;
+
+HostSerial Serial;
+
+int HostSerial::printf(const char* fmt, ...) {
+  if (!verbose) return 0;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vprintf(fmt, ap);
+  va_end(ap);
+  return n;
+}
+
+LittleFSFS LittleFS;
+
+HostNvs& HostNvsData() {
+  static HostNvs nvs;
+  return nvs;
+}
+
+void HostNvsClear() {
+  HostNvsData().clear();
+  hostNvsWrites = 0;
+  hostNvsCutAt = -1;
+  hostNvsFull = false;
+}
+
+uint32_t hostNvsWrites = 0;
+int32_t  hostNvsCutAt = -1;
+bool     hostNvsFull = false;
+
+// ===================== STUBS =====================
+void MetricCount(MetricCounter, uint32_t) {}
+void MetricObserveUs(MetricHist, uint32_t) {}
+
+void dlogPush(uint8_t, const char*, uint8_t, const uint32_t*) {}
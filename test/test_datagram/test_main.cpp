@@ -0,0 +1,405 @@
+// Датаграммный аплинк против эталонного приёмника scripts/udp_ref_receiver.py
+// (правила udp.php и db.php) на настоящем UDP-сокете loopback: кадры, повторы,
+// сопоставление ack с seq, holdoff. Шифрования в обмене нет: blob — JSON как
+// есть (или сжатый lzPack, как на устройстве), decrypt — копия.
+// Приёмник запускается из каталога проекта: нужен python3.
+//   pio test -e native -f test_datagram -v
+#include <Arduino.h>
+#include <unity.h>
+#include <ctype.h>
+#include <string>
+#include <utility>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "datagram.h"
+#include "lz_pack.h"
+
+// сокет мгновенный: сроки ожидания ack сжаты, как в test_modem_baud
+static const uint32_t TIME_SCALE = 10;
+static const uint32_t PAUSE_MS = 20;
+
+// ===================== REFERENCE RECEIVER =====================
+static pid_t refPid = -1;
+static int sock = -1;
+
+static bool startReceiver() {
+  int out[2];
+  if (pipe(out) != 0) return false;
+  refPid = fork();
+  if (refPid == 0) {
+    dup2(out[1], STDOUT_FILENO);
+    close(out[0]);
+    execlp("python3", "python3", "scripts/udp_ref_receiver.py", "0", (char*)nullptr);
+    _exit(127);
+  }
+  close(out[1]);
+
+  // "listening on :PORT"
+  char line[64] = {};
+  size_t len = 0;
+  while (len < sizeof(line) - 1 && read(out[0], line + len, 1) == 1 && line[len] != '\n') len++;
+  close(out[0]);
+  const char* colon = strrchr(line, ':');
+  if (!colon) return false;
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t)atoi(colon + 1));
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sock = socket(AF_INET, SOCK_DGRAM, 0);
+  return sock >= 0 && connect(sock, (sockaddr*)&addr, sizeof(addr)) == 0;
+}
+
+static void stopReceiver() {
+  if (sock >= 0) close(sock);
+  if (refPid > 0) {
+    kill(refPid, SIGTERM);
+    waitpid(refPid, nullptr, 0);
+  }
+}
+
+// управление приёмником: 'C' + команда, ответ 'C' + JSON
+static std::string control(const std::string& cmd) {
+  std::string out = "C" + cmd;
+  TEST_ASSERT_EQUAL(out.size(), send(sock, out.data(), out.size(), 0));
+  char buf[4096];
+  for (;;) {
+    pollfd p = { sock, POLLIN, 0 };
+    TEST_ASSERT_TRUE_MESSAGE(poll(&p, 1, 2000) > 0, "receiver silent");
+    ssize_t n = recv(sock, buf, sizeof(buf), 0);
+    if (n > 0 && buf[0] == 'C') return std::string(buf + 1, n - 1);
+  }
+}
+
+// записи устройства в базе приёмника: (ts, ts_bad) в порядке вставки
+static std::vector<std::pair<uint32_t, int>> rows(const char* dev) {
+  std::string j = control(std::string("rows ") + dev);
+  std::vector<std::pair<uint32_t, int>> r;
+  for (size_t p = 0; p + 1 < j.size(); p++) {
+    unsigned ts;
+    int bad;
+    if (j[p] == '[' && isdigit((unsigned char)j[p + 1]) && sscanf(j.c_str() + p, "[%u, %d]", &ts, &bad) == 2) {
+      r.push_back({ ts, bad });
+    }
+  }
+  return r;
+}
+
+static uint32_t lastAck(const char* dev) {
+  std::string j = control(std::string("rows ") + dev);
+  return strtoul(j.c_str() + j.find("\"last_ack\":") + 11, nullptr, 10);
+}
+
+// ===================== DEVICE OPS =====================
+static int sends;
+
+static bool sockSend(const uint8_t* data, size_t len) {
+  sends++;
+  return send(sock, data, len, 0) == (ssize_t)len;
+}
+
+static int sockRecv(uint8_t* buf, size_t maxLen) {
+  ssize_t n = recv(sock, buf, maxLen, MSG_DONTWAIT);
+  return n < 0 ? 0 : (int)n;
+}
+
+static bool plainCopy(const uint8_t* blob, size_t len, std::vector<uint8_t>& plain) {
+  plain.assign(blob, blob + len);
+  return true;
+}
+
+static void sockPause() {
+  pollfd p = { sock, POLLIN, 0 };
+  poll(&p, 1, PAUSE_MS / TIME_SCALE);
+  HostClockAdvance(PAUSE_MS);
+}
+
+static const DgOps ops = { sockSend, sockRecv, plainCopy, sockPause };
+
+// ===================== PAYLOAD =====================
+static std::string payload(const char* dev, uint32_t seq, long prev, const char* nonce,
+                           uint32_t ts0, int nRecs) {
+  std::string j = std::string("{\"device_id\":\"") + dev + "\",\"nonce\":\"" + nonce + "\",";
+  j += "\"seq\":" + std::to_string(seq) + ",";
+  if (prev >= 0) j += "\"prev\":" + std::to_string(prev) + ",";
+  j += "\"records\":[";
+  for (int i = 0; i < nRecs; i++) {
+    if (i) j += ",";
+    j += "{\"ts\":" + std::to_string(ts0 + i) + ",\"current_mA\":100}";
+  }
+  return j + "]}";
+}
+
+static std::vector<uint8_t> frameOf(const char* dev, uint32_t seq, const std::string& plain) {
+  std::vector<uint8_t> frame;
+  TEST_ASSERT_TRUE(DatagramFrame(frame, dev, seq, std::vector<uint8_t>(plain.begin(), plain.end())));
+  return frame;
+}
+
+static int dgExchange(const std::vector<uint8_t>& frame, uint32_t seq) {
+  DgResult r;
+  return DatagramExchange(ops, frame, seq, r);
+}
+
+void setUp() {
+  HostClockSet(1000);
+  sends = 0;
+  uint8_t drain[512];
+  while (recv(sock, drain, sizeof(drain), MSG_DONTWAIT) > 0) {}
+  control("reset");
+  control("register dev-1");
+}
+
+void tearDown() {}
+
+// ===================== FRAMES =====================
+static void test_frame_layout() {
+  std::string plain = payload("dev-1", 0x01020304, 0, "a1", 1760000000, 8);
+  std::vector<uint8_t> f = frameOf("dev-1", 0x01020304, plain);
+
+  TEST_ASSERT_EQUAL(9 + 5 + plain.size(), f.size());
+  const uint8_t head[] = { 'D', 1, 5, 'd', 'e', 'v', '-', '1', 0x04, 0x03, 0x02, 0x01,
+                           (uint8_t)plain.size(), (uint8_t)(plain.size() >> 8) };
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(head, f.data(), sizeof(head));
+
+  DgResult r;
+  TEST_ASSERT_EQUAL(1, DatagramExchange(ops, f, 0x01020304, r));
+  TEST_ASSERT_EQUAL(1, sends);
+  TEST_ASSERT_TRUE(r.body.indexOf("\"ts\":") >= 0);     // время сервера для TimeSync
+  TEST_ASSERT_EQUAL(8, rows("dev-1").size());
+}
+
+// приёмник требует точной длины: на кадр на байт короче или длиннее — молчание
+// на все попытки
+static void test_length_must_match_exactly() {
+  std::vector<uint8_t> f = frameOf("dev-1", 1, payload("dev-1", 1, 0, "a1", 1760000000, 1));
+  std::vector<uint8_t> shorter(f.begin(), f.end() - 1);
+  std::vector<uint8_t> longer = f;
+  longer.push_back(0);
+
+  uint32_t t0 = millis();
+  TEST_ASSERT_EQUAL(0, dgExchange(shorter, 1));
+  TEST_ASSERT_EQUAL(DG_RETRIES, sends);
+  TEST_ASSERT_GREATER_OR_EQUAL(DG_RETRIES * DG_ACK_TIMEOUT, millis() - t0);
+  TEST_ASSERT_EQUAL(0, dgExchange(longer, 1));
+  TEST_ASSERT_EQUAL(0, rows("dev-1").size());
+  TEST_ASSERT_EQUAL(1, dgExchange(f, 1));
+}
+
+// поля idLen u8 и blobLen u16: что не влезает — не отправляем вовсе
+static void test_frame_limits() {
+  std::vector<uint8_t> frame;
+  std::string id255(255, 'x');
+  TEST_ASSERT_TRUE(DatagramFrame(frame, id255.c_str(), 1, std::vector<uint8_t>(0xFFFF, ' ')));
+  TEST_ASSERT_EQUAL(9 + 255 + 0xFFFF, frame.size());
+  TEST_ASSERT_FALSE(DatagramFrame(frame, std::string(256, 'x').c_str(), 1, {}));
+  TEST_ASSERT_FALSE(DatagramFrame(frame, "dev-1", 1, std::vector<uint8_t>(0x10000, ' ')));
+
+  control("register " + id255);
+  std::string plain = payload(id255.c_str(), 1, 0, "a1", 1760000000, 1);
+  TEST_ASSERT_EQUAL(1, dgExchange(frameOf(id255.c_str(), 1, plain), 1));
+  TEST_ASSERT_EQUAL(1, rows(id255.c_str()).size());
+}
+
+// пакет сжат, как с UPLINK_COMPRESS: приёмник распаковывает (lz_unpack_plain)
+static void test_compressed_payload() {
+  std::string plain = payload("dev-1", 1, 0, "z1", 1760000000, 40);
+  std::vector<uint8_t> packed;
+  TEST_ASSERT_TRUE(lzPack((const uint8_t*)plain.data(), plain.size(), packed));
+  TEST_ASSERT_LESS_THAN(plain.size(), packed.size());
+
+  std::vector<uint8_t> frame;
+  TEST_ASSERT_TRUE(DatagramFrame(frame, "dev-1", 1, packed));
+  TEST_ASSERT_EQUAL(1, dgExchange(frame, 1));
+  TEST_ASSERT_EQUAL(40, rows("dev-1").size());
+}
+
+// ===================== ACK MATCHING =====================
+// поток ответов из памяти: куски по chunk байт, как их отдал бы udpRecv
+static std::vector<uint8_t> stream;
+static size_t streamOff, streamChunk;
+
+static bool streamSend(const uint8_t*, size_t) {
+  return true;
+}
+
+static int streamRecv(uint8_t* buf, size_t maxLen) {
+  size_t n = min(min(streamChunk, stream.size() - streamOff), maxLen);
+  memcpy(buf, stream.data() + streamOff, n);
+  streamOff += n;
+  return (int)n;
+}
+
+static void streamPause() {
+  HostClockAdvance(PAUSE_MS);
+}
+
+static const DgOps streamOps = { streamSend, streamRecv, plainCopy, streamPause };
+
+static std::vector<uint8_t> ackFrame(uint32_t seq, const std::string& json) {
+  std::vector<uint8_t> r = { DG_ACK, DG_VERSION };
+  for (int i = 0; i < 4; i++) r.push_back((uint8_t)(seq >> (8 * i)));
+  r.push_back((uint8_t)json.size());
+  r.push_back((uint8_t)(json.size() >> 8));
+  r.insert(r.end(), json.begin(), json.end());
+  return r;
+}
+
+static int streamExchange(size_t chunk, uint32_t seq) {
+  streamOff = 0;
+  streamChunk = chunk;
+  DgResult r;
+  return DatagramExchange(streamOps, {}, seq, r);
+}
+
+// ответы слитно и по байту: устаревший ack на чужой seq пропускается
+static void test_ack_stream() {
+  stream = ackFrame(6, "{\"status\":\"OK\",\"ack\":6}");
+  std::vector<uint8_t> b = ackFrame(7, "{\"status\":\"OK\",\"ack\":7,\"ts\":1}");
+  stream.insert(stream.end(), b.begin(), b.end());
+
+  for (size_t chunk : { stream.size(), (size_t)1, (size_t)3, (size_t)9 }) {
+    TEST_ASSERT_EQUAL(1, streamExchange(chunk, 7));
+    TEST_ASSERT_EQUAL(1, streamExchange(chunk, 6));
+    TEST_ASSERT_EQUAL(0, streamExchange(chunk, 8));
+  }
+}
+
+// не ответ или заявленная длина больше буфера: сброс, без чтения за концом
+static void test_ack_garbage() {
+  DgAck a;
+  size_t frame;
+  const uint8_t wrongType[] = { 'D', 1, 0, 0, 0, 0, 0, 0 };
+  const uint8_t wrongVer[]  = { 'A', 2 };
+  const uint8_t tooLong[]   = { 'A', 1, 7, 0, 0, 0, 0xF9, 0x00 };   // 8 + 249 > 256
+  const uint8_t fits[]      = { 'A', 1, 7, 0, 0, 0, 0xF8, 0x00 };   // 8 + 248 = 256
+  TEST_ASSERT_EQUAL(DG_GARBAGE, DatagramParseAck(wrongType, 1, 256, a, frame));
+  TEST_ASSERT_EQUAL(DG_GARBAGE, DatagramParseAck(wrongVer, 2, 256, a, frame));
+  TEST_ASSERT_EQUAL(DG_GARBAGE, DatagramParseAck(tooLong, 8, 256, a, frame));
+  TEST_ASSERT_EQUAL(DG_NEED_MORE, DatagramParseAck(fits, 8, 256, a, frame));
+  TEST_ASSERT_EQUAL(DG_NEED_MORE, DatagramParseAck(fits, 7, 256, a, frame));
+}
+
+// ack не на тот seq в теле или статус не OK — отказ, даже если заголовок совпал
+static void test_verdict() {
+  TEST_ASSERT_EQUAL(1, DatagramAckVerdict("{\"status\":\"OK\",\"ack\":5,\"ts\":1}", 5));
+  TEST_ASSERT_EQUAL(-1, DatagramAckVerdict("{\"status\":\"OK\",\"ack\":4,\"ts\":1}", 5));
+  TEST_ASSERT_EQUAL(-1, DatagramAckVerdict("{\"status\":\"gap\",\"ack\":5}", 5));
+  TEST_ASSERT_EQUAL(-1, DatagramAckVerdict("{\"status\":\"OK\"}", 5));
+}
+
+// ===================== RETRIES =====================
+// ack потерялся: повтор той же датаграммы подтверждается, записи не дублируются
+static void test_retransmit_after_lost_ack() {
+  control("drop-ack 1");
+  std::vector<uint8_t> f1 = frameOf("dev-1", 1, payload("dev-1", 1, 0, "n1", 1760000000, 8));
+  TEST_ASSERT_EQUAL(1, dgExchange(f1, 1));
+  TEST_ASSERT_EQUAL(2, sends);
+  TEST_ASSERT_EQUAL(8, rows("dev-1").size());
+  TEST_ASSERT_EQUAL(1, lastAck("dev-1"));
+}
+
+// запрос потерялся: дошла последняя попытка — принят; не дошла ни одна — 0
+static void test_lost_requests() {
+  control("drop-req 2");
+  TEST_ASSERT_EQUAL(1, dgExchange(frameOf("dev-1", 1, payload("dev-1", 1, 0, "n1", 1760000000, 1)), 1));
+  TEST_ASSERT_EQUAL(3, sends);
+
+  control("drop-req 3");
+  TEST_ASSERT_EQUAL(0, dgExchange(frameOf("dev-1", 2, payload("dev-1", 2, 1, "n2", 1760000001, 1)), 2));
+  TEST_ASSERT_EQUAL(6, sends);
+  TEST_ASSERT_EQUAL(1, rows("dev-1").size());
+  TEST_ASSERT_EQUAL(1, lastAck("dev-1"));
+}
+
+// отказы сервера — вердикт -1 с первой попытки (дальше разберётся HTTP-путь)
+static void test_rejections() {
+  // разрыв цепочки: prev впереди ack
+  std::vector<uint8_t> f3 = frameOf("dev-1", 3, payload("dev-1", 3, 2, "n3", 1760000300, 1));
+  TEST_ASSERT_EQUAL(-1, dgExchange(f3, 3));
+  TEST_ASSERT_EQUAL(1, sends);
+  TEST_ASSERT_EQUAL(0, rows("dev-1").size());
+  // отвергнутая по gap при повторе после заполнения цепочки принимается как новая
+  TEST_ASSERT_EQUAL(1, dgExchange(frameOf("dev-1", 2, payload("dev-1", 2, 0, "n2", 1760000200, 1)), 2));
+  TEST_ASSERT_EQUAL(1, dgExchange(f3, 3));
+  TEST_ASSERT_EQUAL(2, rows("dev-1").size());
+
+  // не зарегистрирован
+  TEST_ASSERT_EQUAL(-1, dgExchange(frameOf("dev-9", 1, payload("dev-9", 1, 0, "n1", 1760000000, 1)), 1));
+  // device_id в заголовке и в теле расходятся
+  TEST_ASSERT_EQUAL(-1, dgExchange(frameOf("dev-2", 4, payload("dev-1", 4, 3, "n4", 1760000004, 1)), 4));
+  // seq в заголовке и в теле расходятся
+  TEST_ASSERT_EQUAL(-1, dgExchange(frameOf("dev-1", 5, payload("dev-1", 6, 3, "n5", 1760000005, 1)), 5));
+  TEST_ASSERT_EQUAL(2, rows("dev-1").size());
+}
+
+// ts раньше 2020 (uptime после сброса RTC) не теряется: пишется с ts_bad, и
+// одинаковые ts разных пакетов — обе записи (повторы отсекает цепочка, не ts)
+static void test_bad_ts_kept() {
+  TEST_ASSERT_EQUAL(1, dgExchange(frameOf("dev-1", 1, payload("dev-1", 1, 0, "b1", 100, 2)), 1));
+  TEST_ASSERT_EQUAL(1, dgExchange(frameOf("dev-1", 2, payload("dev-1", 2, 1, "b2", 100, 1)), 2));
+  TEST_ASSERT_EQUAL(1, dgExchange(frameOf("dev-1", 3, payload("dev-1", 3, 2, "b3", 1760000000, 1)), 3));
+
+  auto r = rows("dev-1");
+  TEST_ASSERT_EQUAL(4, r.size());
+  TEST_ASSERT_EQUAL(100, r[2].first);
+  TEST_ASSERT_EQUAL(1, r[0].second);
+  TEST_ASSERT_EQUAL(1, r[2].second);
+  TEST_ASSERT_EQUAL(0, r[3].second);
+}
+
+// ===================== HOLDOFF =====================
+// DG_FAILS_TO_HOLDOFF обменов без ответа — только HTTP на DG_HOLDOFF; ответ
+// (даже отказ) серию обнуляет
+static void test_holdoff() {
+  DgHoldoff h{};
+  control("drop-req 100");
+  std::vector<uint8_t> f = frameOf("dev-1", 1, payload("dev-1", 1, 0, "h1", 1760000000, 1));
+
+  for (uint8_t i = 1; i < DG_FAILS_TO_HOLDOFF; i++) {
+    TEST_ASSERT_EQUAL(0, dgExchange(f, 1));
+    TEST_ASSERT_FALSE(DatagramFailed(h, millis()));
+  }
+  DatagramReached(h);
+  for (uint8_t i = 1; i < DG_FAILS_TO_HOLDOFF; i++) TEST_ASSERT_FALSE(DatagramFailed(h, millis()));
+  TEST_ASSERT_TRUE(DatagramAllowed(h, millis()));
+
+  TEST_ASSERT_EQUAL(0, dgExchange(f, 1));
+  TEST_ASSERT_TRUE(DatagramFailed(h, millis()));
+  TEST_ASSERT_FALSE(DatagramAllowed(h, millis()));
+  TEST_ASSERT_FALSE(DatagramAllowed(h, millis() + DG_HOLDOFF - 1));
+
+  HostClockAdvance(DG_HOLDOFF);
+  TEST_ASSERT_TRUE(DatagramAllowed(h, millis()));
+  control("drop-req 0");
+  TEST_ASSERT_EQUAL(1, dgExchange(f, 1));
+}
+
+int main(int, char**) {
+  if (!startReceiver()) {
+    fprintf(stderr, "test_datagram: can't start scripts/udp_ref_receiver.py (python3, cwd = project)\n");
+    stopReceiver();
+    return 1;
+  }
+  UNITY_BEGIN();
+  RUN_TEST(test_frame_layout);
+  RUN_TEST(test_length_must_match_exactly);
+  RUN_TEST(test_frame_limits);
+  RUN_TEST(test_compressed_payload);
+  RUN_TEST(test_ack_stream);
+  RUN_TEST(test_ack_garbage);
+  RUN_TEST(test_verdict);
+  RUN_TEST(test_retransmit_after_lost_ack);
+  RUN_TEST(test_lost_requests);
+  RUN_TEST(test_rejections);
+  RUN_TEST(test_bad_ts_kept);
+  RUN_TEST(test_holdoff);
+  int rc = UNITY_END();
+  stopReceiver();
+  return rc;
+}
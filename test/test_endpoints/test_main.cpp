@@ -0,0 +1,186 @@
+// Выбор сервера аплинка: разбор списка, перебор по маске (каждый — не больше
+// одного раза за соединение), карантин с ростом срока, возврат на основной после
+// случайной неудачи и кэш DNS.
+//   pio test -e native -f test_endpoints -v
+#include <Arduino.h>
+#include <unity.h>
+#include "endpoints.h"
+
+static int resolveCalls;
+static bool resolveOk;
+
+static bool fakeResolve(const String& host, String& ip) {
+  resolveCalls++;
+  if (!resolveOk) return false;
+  ip = "192.0.2." + String((int)host.length());
+  return true;
+}
+
+// у каждого теста свой порт по умолчанию: список пересобирается с чистым состоянием
+static uint16_t defPort = 8000;
+
+static void configure(const char* list) {
+  EndpointsConfigure(list, defPort);
+}
+
+// перебор, как в httpOpen, когда не подключается никто: сколько было попыток
+static int failAll() {
+  uint32_t tried = 0;
+  int attempts = 0;
+  for (size_t i = 0; i < EndpointsCount(); i++) {
+    int ep = EndpointsPick(tried);
+    if (ep < 0) break;
+    TEST_ASSERT_FALSE(tried & (1UL << ep));
+    attempts++;
+    EndpointsReport(ep, false);
+    tried |= 1UL << ep;
+  }
+  TEST_ASSERT_EQUAL(-1, EndpointsPick(tried));
+  return attempts;
+}
+
+void setUp() {
+  HostClockSet(1000);
+  resolveCalls = 0;
+  resolveOk = true;
+  defPort++;
+}
+
+void tearDown() {}
+
+// ===================== TESTS =====================
+static void test_parse_list() {
+  EndpointsConfigure(" a.example:8080, 10.0.0.1 ,, b.example:0,c.example,d.example", 80);
+  TEST_ASSERT_EQUAL(4, EndpointsCount());       // не больше MAX_ENDPOINTS
+  TEST_ASSERT_EQUAL_STRING("a.example", EndpointsGet(0).host.c_str());
+  TEST_ASSERT_EQUAL(8080, EndpointsGet(0).port);
+  TEST_ASSERT_EQUAL_STRING("10.0.0.1", EndpointsGet(1).ip.c_str());   // IP-литерал без DNS
+  TEST_ASSERT_EQUAL(80, EndpointsGet(1).port);
+  TEST_ASSERT_EQUAL(80, EndpointsGet(2).port);                         // :0 — порт по умолчанию
+  TEST_ASSERT_EQUAL_STRING("c.example", EndpointsGet(3).host.c_str());
+}
+
+// каждый сервер — не больше одного раза за соединение, все до одного
+static void test_pick_each_once() {
+  configure("a.example,b.example,c.example,d.example");
+  TEST_ASSERT_EQUAL(4, failAll());
+
+  // после двух неудач подряд все в карантине: маска всё равно не даёт повторов
+  TEST_ASSERT_EQUAL(4, failAll());
+  TEST_ASSERT_GREATER_THAN(0, EndpointsGet(3).downUntilMs);
+}
+
+// две неудачи подряд — карантин; срок растёт и упирается в потолок
+static void test_quarantine_grows() {
+  configure("a.example,b.example");
+  EndpointsReport(0, false);
+  TEST_ASSERT_EQUAL(0, EndpointsGet(0).downUntilMs);
+  EndpointsReport(0, false);
+  TEST_ASSERT_EQUAL(1000 + 60000, EndpointsGet(0).downUntilMs);
+  TEST_ASSERT_EQUAL(1, EndpointsPick());
+
+  uint32_t prev = 60000;
+  for (int i = 0; i < 8; i++) {
+    EndpointsReport(0, false);
+    uint32_t down = EndpointsGet(0).downUntilMs - millis();
+    TEST_ASSERT_GREATER_OR_EQUAL(prev, down);
+    TEST_ASSERT_LESS_OR_EQUAL(600000, down);
+    prev = down;
+  }
+  TEST_ASSERT_EQUAL(600000, prev);
+}
+
+// все в карантине — тот, кто выйдет раньше; вышел — снова в выборе, RTT меряется заново
+static void test_all_down_then_back() {
+  configure("a.example,b.example");
+  EndpointsReport(1, false);
+  EndpointsReport(1, false);
+  HostClockAdvance(10000);
+  EndpointsReport(0, false);
+  EndpointsReport(0, false);
+  TEST_ASSERT_EQUAL(1, EndpointsPick());        // 1 выходит раньше
+  TEST_ASSERT_EQUAL(0, EndpointsPick(1UL << 1));
+
+  HostClockAdvance(60000);
+  TEST_ASSERT_EQUAL(0, EndpointsGet(0).latencyMs);
+  TEST_ASSERT_EQUAL(0, EndpointsPick());        // оба здоровы: основной
+  TEST_ASSERT_EQUAL(0, EndpointsGet(0).downUntilMs);
+}
+
+// тот же список и порт — состояние сохраняется; сменился порт — пересборка
+static void test_configure_same() {
+  configure("a.example,b.example");
+  EndpointsReport(0, true, 700);
+  configure("a.example,b.example");
+  TEST_ASSERT_EQUAL(700, EndpointsGet(0).latencyMs);
+
+  EndpointsConfigure("a.example,b.example", defPort + 1000);
+  TEST_ASSERT_EQUAL(0, EndpointsGet(0).latencyMs);
+  TEST_ASSERT_EQUAL(defPort + 1000, EndpointsGet(0).port);
+}
+
+// одна неудача основного: уходим на резервный, через REMEASURE_MS основной
+// пробуется снова и, если здоров, возвращает себе трафик
+static void test_failback_to_primary() {
+  configure("a.example,b.example");
+  EndpointsReport(0, true, 800);
+  EndpointsReport(1, true, 900);
+  TEST_ASSERT_EQUAL(0, EndpointsPick());
+
+  EndpointsReport(0, false);                    // (800*3 + 15000) / 4
+  TEST_ASSERT_EQUAL(0, EndpointsGet(0).downUntilMs);
+  TEST_ASSERT_EQUAL(1, EndpointsPick());
+
+  // резервный работает, основной не мерится
+  for (int i = 0; i < 10; i++) {
+    HostClockAdvance(25000);
+    TEST_ASSERT_EQUAL(1, EndpointsPick());
+    EndpointsReport(1, true, 900);
+  }
+  HostClockAdvance(300000 - 10 * 25000);
+  TEST_ASSERT_EQUAL(0, EndpointsPick());        // оценка устарела: пробуем основной
+  EndpointsReport(0, true, 800);
+  TEST_ASSERT_EQUAL(800, EndpointsGet(0).latencyMs);   // новый замер, без хвоста неудачи
+
+  for (int i = 0; i < 20; i++) {
+    HostClockAdvance(25000);
+    TEST_ASSERT_EQUAL(0, EndpointsPick());
+    EndpointsReport(0, true, 800);
+  }
+}
+
+// DNS: кэш на час, сброс после неудачи обмена
+static void test_dns_cache() {
+  configure("a.example,10.1.2.3");
+  String ip;
+  TEST_ASSERT_TRUE(EndpointsResolve(0, fakeResolve, ip));
+  TEST_ASSERT_TRUE(EndpointsResolve(0, fakeResolve, ip));
+  TEST_ASSERT_EQUAL(1, resolveCalls);
+
+  EndpointsReport(0, false);
+  TEST_ASSERT_TRUE(EndpointsResolve(0, fakeResolve, ip));
+  TEST_ASSERT_EQUAL(2, resolveCalls);
+
+  HostClockAdvance(3600UL * 1000UL);
+  TEST_ASSERT_TRUE(EndpointsResolve(0, fakeResolve, ip));
+  TEST_ASSERT_EQUAL(3, resolveCalls);
+
+  resolveOk = false;
+  TEST_ASSERT_TRUE(EndpointsResolve(1, fakeResolve, ip));     // литерал — без DNS
+  TEST_ASSERT_EQUAL_STRING("10.1.2.3", ip.c_str());
+  EndpointsReport(0, false);
+  TEST_ASSERT_FALSE(EndpointsResolve(0, fakeResolve, ip));
+  TEST_ASSERT_EQUAL(4, resolveCalls);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_list);
+  RUN_TEST(test_pick_each_once);
+  RUN_TEST(test_quarantine_grows);
+  RUN_TEST(test_all_down_then_back);
+  RUN_TEST(test_configure_same);
+  RUN_TEST(test_failback_to_primary);
+  RUN_TEST(test_dns_cache);
+  return UNITY_END();
+}
@@ -0,0 +1,187 @@
+// Разбор HTTP-ответа кусками любой длины: модем отдаёт байты как придётся.
+// Каждый образец скармливается целиком, по байту и с разрезом в каждой позиции —
+// результат обязан совпасть.
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "http_resp.h"
+
+struct Fixture {
+  const char* name;
+  const char* raw;
+  int         status;
+  const char* body;
+  bool        keepAlive;
+  uint32_t    date;
+  size_t      tail;     // байт следующего ответа за концом (конвейер keep-alive)
+};
+
+static const Fixture FIXTURES[] = {
+  { "content-length",
+    "HTTP/1.1 200 OK\r\nContent-Length: 16\r\nDate: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n{\"status\":\"OK\"}\n",
+    200, "{\"status\":\"OK\"}\n", true, 784111777, 0 },
+  { "chunked",
+    "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n7;ext=1\r\n, world\r\n0\r\nX-Trailer: 1\r\n\r\n",
+    200, "hello, world", true, 0, 0 },
+  { "bare-lf",
+    "HTTP/1.1 201 Created\nContent-Length: 2\n\nok",
+    201, "ok", true, 0, 0 },
+  { "http10-close",
+    "HTTP/1.0 200 OK\r\nContent-Length: 3\r\n\r\nabc",
+    200, "abc", false, 0, 0 },
+  { "connection-close",
+    "HTTP/1.1 500 Internal Server Error\r\nconnection: Close\r\ncontent-length: 4\r\n\r\nfail",
+    500, "fail", false, 0, 0 },
+  { "no-content",
+    "HTTP/1.1 204 No Content\r\nContent-Length: 10\r\n\r\n",
+    204, "", true, 0, 0 },
+  { "100-continue",
+    "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok",
+    200, "ok", true, 0, 0 },
+  { "103-early-hints",
+    "HTTP/1.1 103 Early Hints\r\nLink: </a.css>\r\n\r\nHTTP/1.1 100 Continue\r\n\r\n"
+    "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nok\r\n0\r\n\r\n",
+    200, "ok", true, 0, 0 },
+  { "pipelined",
+    "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nokHTTP/1.1 200 OK\r\n",
+    200, "ok", true, 0, 17 },
+  { "chunked-pipelined",
+    "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nA\r\n0\r\n\r\nHTTP",
+    200, "A", true, 0, 4 },
+};
+
+struct Result {
+  bool        done;
+  int         status;
+  std::string body;
+  bool        keepAlive;
+  uint32_t    date;
+  size_t      consumed;
+};
+
+// режем raw по позициям cuts (по возрастанию); всё, что парсер не взял, — остаток
+static Result feedSplit(const char* raw, const std::vector<size_t>& cuts) {
+  HttpResp r;
+  HttpRespReset(r);
+  size_t len = strlen(raw), from = 0, consumed = 0;
+  std::vector<size_t> ends = cuts;
+  ends.push_back(len);
+  for (size_t end : ends) {
+    if (end <= from) continue;
+    size_t n = HttpRespFeed(r, (const uint8_t*)raw + from, end - from);
+    consumed += n;
+    if (n < end - from) break;   // ответ кончился посреди куска
+    from = end;
+  }
+  return { HttpRespDone(r), r.status, r.body.c_str(), r.keepAlive, r.date, consumed };
+}
+
+static void checkResult(const Fixture& f, const Result& got, const char* how) {
+  char where[96];
+  snprintf(where, sizeof(where), "%s (%s)", f.name, how);
+  if (!got.done || got.status != f.status || got.body != f.body || got.keepAlive != f.keepAlive ||
+      got.date != f.date || got.consumed != strlen(f.raw) - f.tail) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), "%s: done=%d status=%d body='%s' keep=%d date=%u consumed=%u",
+             where, got.done, got.status, got.body.c_str(), got.keepAlive, (unsigned)got.date,
+             (unsigned)got.consumed);
+    TEST_FAIL_MESSAGE(msg);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ===================== FIXTURES =====================
+static void test_whole() {
+  for (const Fixture& f : FIXTURES) checkResult(f, feedSplit(f.raw, {}), "whole");
+}
+
+static void test_byte_at_a_time() {
+  for (const Fixture& f : FIXTURES) {
+    std::vector<size_t> cuts;
+    for (size_t i = 1; i < strlen(f.raw); i++) cuts.push_back(i);
+    checkResult(f, feedSplit(f.raw, cuts), "bytewise");
+  }
+}
+
+// два разреза в любых местах: CRLF, размер чанка и тело рвутся где угодно
+static void test_every_split() {
+  for (const Fixture& f : FIXTURES) {
+    size_t len = strlen(f.raw);
+    for (size_t a = 1; a < len; a++) {
+      for (size_t b = a; b < len; b++) {
+        checkResult(f, feedSplit(f.raw, { a, b }), "split");
+      }
+    }
+  }
+}
+
+// ===================== ERRORS / CLOSE =====================
+static void test_body_to_close() {
+  const char* raw = "HTTP/1.1 200 OK\r\n\r\npart1";
+  HttpResp r;
+  HttpRespReset(r);
+  HttpRespFeed(r, (const uint8_t*)raw, strlen(raw));
+  TEST_ASSERT_FALSE(HttpRespDone(r));
+  HttpRespFeed(r, (const uint8_t*)"part2", 5);
+  HttpRespFinishOnClose(r);
+  TEST_ASSERT_TRUE(HttpRespDone(r));
+  TEST_ASSERT_FALSE(r.keepAlive);
+  TEST_ASSERT_EQUAL_STRING("part1part2", r.body.c_str());
+}
+
+static void test_truncated_is_error() {
+  const char* raw = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort";
+  HttpResp r;
+  HttpRespReset(r);
+  HttpRespFeed(r, (const uint8_t*)raw, strlen(raw));
+  HttpRespFinishOnClose(r);
+  TEST_ASSERT_TRUE(HttpRespFailed(r));
+}
+
+static void test_garbage_and_limits() {
+  HttpResp r;
+  HttpRespReset(r);
+  HttpRespFeed(r, (const uint8_t*)"+CME ERROR: 3\r\n", 15);
+  TEST_ASSERT_TRUE(HttpRespFailed(r));
+
+  std::string longLine = "HTTP/1.1 200 OK\r\nX: " + std::string(HTTP_RESP_MAX_LINE, 'a') + "\r\n\r\n";
+  HttpRespReset(r);
+  HttpRespFeed(r, (const uint8_t*)longLine.data(), longLine.size());
+  TEST_ASSERT_TRUE(HttpRespFailed(r));
+
+  std::string big = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(HTTP_RESP_MAX_BODY + 1) + "\r\n\r\n" +
+                    std::string(HTTP_RESP_MAX_BODY + 1, 'b');
+  HttpRespReset(r);
+  HttpRespFeed(r, (const uint8_t*)big.data(), big.size());
+  TEST_ASSERT_TRUE(HttpRespFailed(r));
+
+  const char* badChunk = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n";
+  HttpRespReset(r);
+  HttpRespFeed(r, (const uint8_t*)badChunk, strlen(badChunk));
+  TEST_ASSERT_TRUE(HttpRespFailed(r));
+}
+
+// 101 — дальше не HTTP: разбор закончен, остаток не трогаем
+static void test_switching_protocols() {
+  const char* raw = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n\r\n\x81\x02hi";
+  HttpResp r;
+  HttpRespReset(r);
+  size_t n = HttpRespFeed(r, (const uint8_t*)raw, strlen(raw));
+  TEST_ASSERT_TRUE(HttpRespDone(r));
+  TEST_ASSERT_EQUAL(101, r.status);
+  TEST_ASSERT_EQUAL(strlen(raw) - 4, n);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_whole);
+  RUN_TEST(test_byte_at_a_time);
+  RUN_TEST(test_every_split);
+  RUN_TEST(test_body_to_close);
+  RUN_TEST(test_truncated_is_error);
+  RUN_TEST(test_garbage_and_limits);
+  RUN_TEST(test_switching_protocols);
+  return UNITY_END();
+}
@@ -0,0 +1,177 @@
+// LZSS упаковщик против эталонной распаковки (построчный перевод lz_unpack_plain
+// из crypto.php) + степень сжатия и скорость на типичном пакете бэклога.
+//   pio test -e native -f test_lz -v     (-v — чтобы видеть строки ratio/ns_per_byte)
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include <random>
+#include "lz_pack.h"
+
+// ===================== REFERENCE =====================
+// те же проверки и тот же порядок, что на сервере; "" — успех
+static const char* lzUnpack(const std::vector<uint8_t>& plain, std::vector<uint8_t>& out) {
+  out.clear();
+  if (plain.size() < 6 || plain[0] != 'Z') { out = plain; return ""; }
+  if (plain[1] != 1) return "lz_version_bad";
+
+  uint32_t origLen = plain[2] | (plain[3] << 8) | (plain[4] << 16) | ((uint32_t)plain[5] << 24);
+  const uint8_t* in = plain.data() + 6;
+  size_t n = plain.size() - 6;
+  size_t i = 0;
+
+  while (i < n && out.size() < origLen) {
+    uint8_t ctrl = in[i++];
+    for (int b = 0; b < 8 && i < n && out.size() < origLen; b++) {
+      if ((ctrl >> b) & 1) {
+        if (i + 1 >= n) return "lz_truncated";
+        uint16_t code = (uint16_t)((in[i] << 8) | in[i + 1]);
+        i += 2;
+        size_t dist = (code >> 4) + 1;
+        size_t len  = (code & 0x0F) + 3;
+        if (dist > out.size()) return "lz_dist_bad";
+        size_t start = out.size() - dist;
+        for (size_t k = 0; k < len; k++) out.push_back(out[start + k]);
+      } else {
+        out.push_back(in[i++]);
+      }
+    }
+  }
+
+  if (out.size() != origLen) return "lz_len_bad";
+  return "";
+}
+
+// false — не сжалось (пакет уходит как есть), проверять нечего
+static bool roundtrip(const std::vector<uint8_t>& src) {
+  std::vector<uint8_t> packed, back;
+  if (!lzPack(src.data(), src.size(), packed)) return false;
+  TEST_ASSERT_LESS_THAN(src.size(), packed.size());
+  TEST_ASSERT_EQUAL_STRING("", lzUnpack(packed, back));
+  TEST_ASSERT_EQUAL(src.size(), back.size());
+  TEST_ASSERT_EQUAL_MEMORY(src.data(), back.data(), src.size());
+  return true;
+}
+
+// пакет /data как у buildDataJson: 8 записей с каналами, соседние отличаются мало
+static std::vector<uint8_t> batchJson(size_t records) {
+  std::string s = "{\"device_id\":\"A1B2C3D4E5F6\",\"nonce\":\"9f3c21aa\",\"seq\":1042,\"prev\":1041,\"records\":[";
+  char buf[192];
+  for (size_t i = 0; i < records; i++) {
+    snprintf(buf, sizeof(buf),
+             "%s{\"ts\":%u,\"current_mA\":%d,\"power_dW\":%d,\"temp_cC\":%d,\"ch_cA\":[%d,%d,%d],\"t_cC\":[%d,%d]}",
+             i ? "," : "", 1760000000u + (unsigned)i * 10, 12345 + (int)(i * 37) % 200,
+             27150 + (int)(i * 53) % 400, 2150 + (int)i % 3, 412 + (int)i % 5, 409, 413 + (int)i % 2,
+             2150 + (int)i % 3, 1875);
+    s += buf;
+  }
+  s += "]}";
+  return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ===================== ROUNDTRIP =====================
+static void test_batch_roundtrip() {
+  roundtrip(batchJson(1));
+  TEST_ASSERT_TRUE(roundtrip(batchJson(8)));
+  TEST_ASSERT_TRUE(roundtrip(batchJson(64)));
+}
+
+// длинные повторы: ссылка перекрывает сама себя (dist < len)
+static void test_overlapping_runs() {
+  std::vector<uint8_t> src(3000, 'a');
+  TEST_ASSERT_TRUE(roundtrip(src));
+  for (size_t i = 0; i < src.size(); i++) src[i] = "ab"[i % 2];
+  TEST_ASSERT_TRUE(roundtrip(src));
+}
+
+// окно 4 КБ: повтор дальше окна обязан уйти литералами, а не битой ссылкой
+static void test_window_edge() {
+  std::mt19937 rng(7);
+  std::vector<uint8_t> block(4096 + 17);
+  for (auto& b : block) b = (uint8_t)rng();
+  std::vector<uint8_t> src = block;
+  src.insert(src.end(), block.begin(), block.end());
+  roundtrip(src);
+
+  std::vector<uint8_t> exact(4096);
+  for (auto& b : exact) b = (uint8_t)rng();
+  src = exact;
+  src.insert(src.end(), exact.begin(), exact.begin() + 100);
+  roundtrip(src);
+}
+
+// полуслучайные данные с повторами разной длины и дистанции
+static void test_fuzz_roundtrip() {
+  std::mt19937 rng(12345);
+  for (int round = 0; round < 300; round++) {
+    std::vector<uint8_t> src;
+    size_t target = 3 + rng() % 6000;
+    while (src.size() < target) {
+      if (src.size() > 4 && rng() % 3) {
+        size_t dist = 1 + rng() % min<size_t>(src.size(), 5000);
+        size_t len = 1 + rng() % 40;
+        size_t start = src.size() - dist;
+        for (size_t k = 0; k < len; k++) src.push_back(src[start + k]);
+      } else {
+        src.push_back((uint8_t)("{}\":,0123456789abc"[rng() % 18]));
+      }
+    }
+    roundtrip(src);
+  }
+}
+
+static void test_limits() {
+  std::vector<uint8_t> packed;
+  const uint8_t two[2] = { 'a', 'a' };
+  TEST_ASSERT_FALSE(lzPack(two, sizeof(two), packed));
+  TEST_ASSERT_FALSE(lzPack(nullptr, 100, packed));
+
+  // позиции в хеше — uint16_t: 64 КБ ещё сжимаем, больше — нет
+  std::vector<uint8_t> src(0xFFFF, 'x');
+  TEST_ASSERT_TRUE(roundtrip(src));
+  src.push_back('x');
+  TEST_ASSERT_FALSE(lzPack(src.data(), src.size(), packed));
+  TEST_ASSERT_EQUAL(0, packed.size());
+}
+
+// случайные байты не сжимаются: lzPack отказывается, пакет уходит несжатым
+static void test_incompressible() {
+  std::mt19937 rng(99);
+  std::vector<uint8_t> src(600), packed;
+  for (auto& b : src) b = (uint8_t)rng();
+  TEST_ASSERT_FALSE(lzPack(src.data(), src.size(), packed));
+}
+
+// ===================== RATIO / SPEED =====================
+// типичный пакет из 8 записей: сжатие должно окупать хотя бы треть объёма
+static void test_batch_ratio_and_speed() {
+  std::vector<uint8_t> src = batchJson(8), packed;
+  TEST_ASSERT_TRUE(lzPack(src.data(), src.size(), packed));
+  TEST_ASSERT_LESS_THAN(src.size() * 2 / 3, packed.size());
+
+  const int reps = 2000;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < reps; i++) lzPack(src.data(), src.size(), packed);
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / reps / src.size();
+
+  // время хоста: для ESP32 цифры даёт стенд PERF_BENCH (lz_pack_600), здесь — для сравнения правок
+  char msg[128];
+  snprintf(msg, sizeof(msg), "lz batch8: %u -> %u bytes (ratio %.2f), %.1f ns/byte host",
+           (unsigned)src.size(), (unsigned)packed.size(), (double)src.size() / packed.size(), ns);
+  TEST_MESSAGE(msg);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_batch_roundtrip);
+  RUN_TEST(test_overlapping_runs);
+  RUN_TEST(test_window_edge);
+  RUN_TEST(test_fuzz_roundtrip);
+  RUN_TEST(test_limits);
+  RUN_TEST(test_incompressible);
+  RUN_TEST(test_batch_ratio_and_speed);
+  return UNITY_END();
+}
@@ -0,0 +1,256 @@
+// Согласование скорости против поддельного SIM900 на псевдотерминале. Прошивка
+// говорит в подчинённую сторону pty (скорость — её termios), модем сидит на
+// ведущей и смотрит, на какой скорости открыт UART: не совпала со своей — байты
+// теряются в обе стороны, как на настоящем проводе.
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "modem_baud.h"
+
+// pty мгновенный: сроки AT сжаты, чтобы перебор скоростей не тянулся секундами
+static const uint32_t TIME_SCALE = 10;
+
+static const struct { uint32_t baud; speed_t speed; } SPEEDS[] = {
+  { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 }, { 115200, B115200 },
+};
+
+static speed_t toSpeed(uint32_t baud) {
+  for (auto& s : SPEEDS) if (s.baud == baud) return s.speed;
+  return B0;
+}
+
+static uint32_t fromSpeed(speed_t sp) {
+  for (auto& s : SPEEDS) if (s.speed == sp) return s.baud;
+  return 0;
+}
+
+static void sleepMs(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// ===================== FAKE SIM900 =====================
+struct FakeSim900 {
+  int      master = -1;
+  int      probe = -1;          // своя копия подчинённой стороны — только читать её скорость
+  uint32_t baud = 0;            // 0 — автобод: подхватит скорость первого AT
+  uint32_t saved = 0;           // профиль после AT&W
+  uint32_t maxReliable = 0;     // выше этой скорости ответы модема доходят мусором (длинный кабель)
+  bool     rejectIpr = false;   // скорость не поддерживается: ERROR
+  bool     dead = false;        // питание не подано
+  uint32_t iprCount = 0;
+
+  std::atomic<bool> stop{false};
+  std::thread th;
+  std::string line;
+
+  uint32_t hostBaud() {
+    termios t;
+    if (tcgetattr(probe, &t) != 0) return 0;
+    return fromSpeed(cfgetospeed(&t));
+  }
+
+  void reply(const char* s) {
+    std::string out = std::string("\r\n") + s + "\r\n";
+    bool garbled = hostBaud() != baud || (maxReliable && baud > maxReliable);
+    if (garbled) out.assign(out.size(), '\xF0');
+    if (write(master, out.data(), out.size()) < 0) {}
+  }
+
+  void command(const std::string& cmd) {
+    if (cmd == "AT") {
+      reply("OK");
+    } else if (cmd.rfind("AT+IPR=", 0) == 0) {
+      iprCount++;
+      if (rejectIpr) { reply("ERROR"); return; }
+      reply("OK");            // ответ — ещё на старой скорости
+      baud = strtoul(cmd.c_str() + 7, nullptr, 10);
+    } else if (cmd == "AT&W") {
+      saved = baud;
+      reply("OK");
+    } else {
+      reply("ERROR");
+    }
+  }
+
+  void onByte(char c) {
+    uint32_t hb = hostBaud();
+    if (dead) return;
+    if (!baud && c == 'A') baud = hb;   // автобод ловит скорость по "AT"
+    if (hb != baud) { line.clear(); return; }
+    if (c == '\r') {
+      if (!line.empty()) command(line);
+      line.clear();
+    } else if (c != '\n') {
+      line += c;
+    }
+  }
+
+  void run() {
+    while (!stop) {
+      pollfd p = { master, POLLIN, 0 };
+      if (poll(&p, 1, 2) <= 0) continue;
+      char buf[64];
+      ssize_t n = read(master, buf, sizeof(buf));
+      for (ssize_t i = 0; i < n; i++) onByte(buf[i]);
+    }
+  }
+};
+
+static FakeSim900* sim = nullptr;
+static int uart = -1;     // «SerialAT» прошивки
+
+// ===================== HOST UART =====================
+static void hostUartBegin(uint32_t baud) {
+  termios t;
+  tcgetattr(uart, &t);
+  cfmakeraw(&t);
+  cfsetispeed(&t, toSpeed(baud));
+  cfsetospeed(&t, toSpeed(baud));
+  tcsetattr(uart, TCSANOW, &t);
+  tcflush(uart, TCIOFLUSH);
+  sleepMs(50 / TIME_SCALE);
+}
+
+// "AT"+cmd, ждём OK/ERROR в пределах срока
+static bool hostExchange(const char* cmd, uint32_t timeoutMs) {
+  std::string out = std::string("AT") + cmd + "\r";
+  if (write(uart, out.data(), out.size()) < 0) return false;
+
+  std::string in;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs / TIME_SCALE);
+  while (std::chrono::steady_clock::now() < deadline) {
+    pollfd p = { uart, POLLIN, 0 };
+    if (poll(&p, 1, 1) <= 0) continue;
+    char buf[64];
+    ssize_t n = read(uart, buf, sizeof(buf));
+    if (n > 0) in.append(buf, n);
+    if (in.find("OK\r\n") != std::string::npos) return true;
+    if (in.find("ERROR\r\n") != std::string::npos) return false;
+  }
+  return false;
+}
+
+static bool hostTestAT(uint32_t timeoutMs) {
+  return hostExchange("", timeoutMs);
+}
+
+static bool hostCommand(const char* cmd, uint32_t timeoutMs) {
+  return hostExchange(cmd, timeoutMs);
+}
+
+static const BaudOps ops = { hostUartBegin, hostTestAT, hostCommand };
+
+static uint32_t uartBaud() {
+  termios t;
+  tcgetattr(uart, &t);
+  return fromSpeed(cfgetospeed(&t));
+}
+
+// ===================== FIXTURE =====================
+void setUp() {
+  sim = new FakeSim900();
+  sim->master = posix_openpt(O_RDWR | O_NOCTTY);
+  TEST_ASSERT_TRUE_MESSAGE(sim->master >= 0, "no pty");
+  grantpt(sim->master);
+  unlockpt(sim->master);
+  uart = open(ptsname(sim->master), O_RDWR | O_NOCTTY);
+  sim->probe = open(ptsname(sim->master), O_RDWR | O_NOCTTY);
+  TEST_ASSERT_TRUE_MESSAGE(uart >= 0 && sim->probe >= 0, "no pty slave");
+  hostUartBegin(9600);
+}
+
+// модем запускается после настройки сценария
+static void startSim() {
+  sim->th = std::thread([] { sim->run(); });
+}
+
+void tearDown() {
+  sim->stop = true;
+  if (sim->th.joinable()) sim->th.join();
+  close(uart);
+  close(sim->probe);
+  close(sim->master);
+  delete sim;
+  sim = nullptr;
+}
+
+// ===================== TESTS =====================
+// модем в автободе: первая же проба на целевой, IPR не нужен
+static void test_autobaud_locks_on_target() {
+  startSim();
+  TEST_ASSERT_EQUAL(115200, ModemBaudNegotiate(ops, 115200));
+  TEST_ASSERT_EQUAL(115200, sim->baud);
+  TEST_ASSERT_EQUAL(0, sim->iprCount);
+  TEST_ASSERT_EQUAL(115200, uartBaud());
+}
+
+// сохранён на 9600: находим перебором, переводим на целевую и сохраняем
+static void test_fixed_baud_switched_and_saved() {
+  sim->baud = 9600;
+  startSim();
+  TEST_ASSERT_EQUAL(115200, ModemBaudNegotiate(ops, 115200));
+  TEST_ASSERT_EQUAL(115200, sim->baud);
+  TEST_ASSERT_EQUAL(115200, sim->saved);
+  TEST_ASSERT_EQUAL(115200, uartBaud());
+  TEST_ASSERT_TRUE(ModemLinkVerify(ops, 3));
+}
+
+// целевая не поддерживается: остаёмся на найденной, профиль не трогаем
+static void test_ipr_rejected_stays_on_found() {
+  sim->baud = 19200;
+  sim->rejectIpr = true;
+  startSim();
+  TEST_ASSERT_EQUAL(19200, ModemBaudNegotiate(ops, 115200));
+  TEST_ASSERT_EQUAL(19200, sim->baud);
+  TEST_ASSERT_EQUAL(0, sim->saved);
+  TEST_ASSERT_EQUAL(19200, uartBaud());
+}
+
+// модем перешёл, но на 115200 его ответы не доходят: вернуть его на найденную
+// командой на новой скорости, &W не делать
+static void test_unreliable_target_reverted() {
+  sim->baud = 9600;
+  sim->maxReliable = 57600;
+  startSim();
+  TEST_ASSERT_EQUAL(9600, ModemBaudNegotiate(ops, 115200));
+  TEST_ASSERT_EQUAL(9600, sim->baud);
+  TEST_ASSERT_EQUAL(0, sim->saved);
+  TEST_ASSERT_EQUAL(2, sim->iprCount);
+  TEST_ASSERT_EQUAL(9600, uartBaud());
+  TEST_ASSERT_TRUE(ModemLinkVerify(ops, 3));
+}
+
+// модема нет: 0, UART остаётся на целевой
+static void test_dead_modem() {
+  sim->dead = true;
+  startSim();
+  TEST_ASSERT_EQUAL(0, ModemBaudNegotiate(ops, 115200));
+  TEST_ASSERT_EQUAL(115200, uartBaud());
+}
+
+// целевая ниже найденной (сборка с -D TINY_GSM_BAUD=57600)
+static void test_lower_target() {
+  sim->baud = 115200;
+  startSim();
+  TEST_ASSERT_EQUAL(57600, ModemBaudNegotiate(ops, 57600));
+  TEST_ASSERT_EQUAL(57600, sim->baud);
+  TEST_ASSERT_EQUAL(57600, sim->saved);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_autobaud_locks_on_target);
+  RUN_TEST(test_fixed_baud_switched_and_saved);
+  RUN_TEST(test_ipr_rejected_stays_on_found);
+  RUN_TEST(test_unreliable_target_reverted);
+  RUN_TEST(test_dead_modem);
+  RUN_TEST(test_lower_target);
+  return UNITY_END();
+}
@@ -0,0 +1,222 @@
+// Планировщик сна на виртуальных часах: цикл powerTask (power.cpp) повторён без
+// железа — клиенты с периодом и длительностью работы, light sleep двигает часы.
+// Проверяем, что никто не просыпается поздно, сна нет, пока кто-то занят,
+// переполнение millis не ломает сроки, а учёт бодрствования сходится с фактом.
+//   pio test -e native -f test_power_sched -v
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "power_sched.h"
+
+// ===================== VIRTUAL BOARD =====================
+struct SimClient {
+  uint32_t periodMs;
+  uint32_t workMs;
+  uint32_t due;
+  uint32_t busyUntil;
+  uint32_t wakes;
+  uint32_t maxLateMs;
+};
+
+static PowerSched sched;
+static PowerMeter meter;
+static std::vector<SimClient> clients;
+static std::vector<uint32_t> hours;    // lastAwakeMs по закрытым часам
+static uint64_t sleptTotal, awakeTotal;
+
+static void addClient(uint32_t periodMs, uint32_t workMs) {
+  uint8_t i = clients.size();
+  clients.push_back({ periodMs, workMs, (uint32_t)millis() + periodMs, 0, 0, 0 });
+  sched.timed |= 1u << i;
+  sched.due[i] = clients[i].due;
+}
+
+static void advance(uint32_t ms, bool sleeping) {
+  HostClockAdvance(ms);
+  (sleeping ? sleptTotal : awakeTotal) += ms;
+}
+
+// задачи работают параллельно с powerTask: закончил — отметился (PowerIdleUntil) и разбудил его
+static uint32_t finishWork() {
+  uint32_t nearest = UINT32_MAX;
+  for (uint8_t i = 0; i < clients.size(); i++) {
+    SimClient& c = clients[i];
+    if (!(sched.busy & (1u << i))) continue;
+    int32_t left = (int32_t)(c.busyUntil - millis());
+    if (left > 0) {
+      nearest = min(nearest, (uint32_t)left);
+      continue;
+    }
+    c.due += c.periodMs;              // без дрейфа: от срока, а не от конца работы
+    sched.busy &= ~(1u << i);
+    sched.timed |= 1u << i;
+    sched.due[i] = c.due;
+  }
+  return nearest;
+}
+
+// powerTask: учёт часа, план, побудка клиентов, сон или ожидание
+static void runFor(uint32_t ms) {
+  uint32_t end = millis() + ms;
+  while ((int32_t)(millis() - end) < 0) {
+    uint32_t untilDone = finishWork();
+    uint32_t now = millis();
+    if (PowerMeterRoll(meter, now)) hours.push_back(meter.lastAwakeMs);
+
+    PowerPlan p = PowerSchedPlan(sched, now);
+    sched.timed &= ~p.wake;
+    sched.busy |= p.wake;
+    if (p.wake) {
+      for (uint8_t i = 0; i < clients.size(); i++) {
+        if (!(p.wake & (1u << i))) continue;
+        SimClient& c = clients[i];
+        c.wakes++;
+        c.maxLateMs = max(c.maxLateMs, now - c.due);
+        c.busyUntil = now + c.workMs;
+      }
+      continue;
+    }
+
+    if (p.sleepMs) {
+      TEST_ASSERT_EQUAL(0, sched.busy);
+      advance(p.sleepMs, true);
+      PowerMeterSlept(meter, p.sleepMs);
+      continue;
+    }
+    advance(max(1u, min(p.waitMs, untilDone)), false);
+  }
+}
+
+void setUp() {
+  sched = PowerSched{};
+  meter = PowerMeter{};
+  clients.clear();
+  hours.clear();
+  sleptTotal = awakeTotal = 0;
+  HostClockSet(0);
+}
+
+void tearDown() {}
+
+// ===================== PLAN =====================
+static void test_plan_basics() {
+  PowerSched s{};
+  // никого: просыпаемся раз в минуту
+  PowerPlan p = PowerSchedPlan(s, 1000);
+  TEST_ASSERT_EQUAL(PWR_MAX_SLEEP_MS - PWR_WAKE_GUARD_MS, p.sleepMs);
+
+  s.timed = 1;
+  s.due[0] = 1000 + 5000;
+  p = PowerSchedPlan(s, 1000);
+  TEST_ASSERT_EQUAL(0, p.wake);
+  TEST_ASSERT_EQUAL(5000 - PWR_WAKE_GUARD_MS, p.sleepMs);
+
+  // занятый клиент не даёт спать, но срок другого остаётся ожиданием
+  s.busy = 2;
+  p = PowerSchedPlan(s, 1000);
+  TEST_ASSERT_EQUAL(0, p.sleepMs);
+  TEST_ASSERT_EQUAL(5000, p.waitMs);
+  s.busy = 0;
+
+  // сон короче выгоды — просто ждём
+  p = PowerSchedPlan(s, 1000 + 5000 - PWR_WAKE_GUARD_MS - PWR_MIN_SLEEP_MS);
+  TEST_ASSERT_EQUAL(0, p.sleepMs);
+  TEST_ASSERT_EQUAL(PWR_WAKE_GUARD_MS + PWR_MIN_SLEEP_MS, p.waitMs);
+
+  // WiFi STA держит радио: вместо сна ждём тот же срок
+  s.keepRadio = true;
+  p = PowerSchedPlan(s, 1000);
+  TEST_ASSERT_EQUAL(0, p.sleepMs);
+  TEST_ASSERT_EQUAL(5000, p.waitMs);
+  s.keepRadio = false;
+
+  // срок наступил или прошёл — будим, пересмотр сразу
+  p = PowerSchedPlan(s, 1000 + 5000);
+  TEST_ASSERT_EQUAL(1, p.wake);
+  TEST_ASSERT_EQUAL(0, p.waitMs);
+  TEST_ASSERT_EQUAL(0, p.sleepMs);
+}
+
+// срок по ту сторону переполнения millis
+static void test_plan_millis_wrap() {
+  PowerSched s{};
+  s.timed = 3;
+  uint32_t now = 0xFFFFFF00u;
+  s.due[0] = now + 1000;        // после переполнения: 0x2E8
+  s.due[1] = now - 5;           // уже прошёл
+  PowerPlan p = PowerSchedPlan(s, now);
+  TEST_ASSERT_EQUAL(2, p.wake);
+
+  s.timed = 1;
+  p = PowerSchedPlan(s, now);
+  TEST_ASSERT_EQUAL(1000 - PWR_WAKE_GUARD_MS, p.sleepMs);
+  p = PowerSchedPlan(s, now + 1000);
+  TEST_ASSERT_EQUAL(1, p.wake);
+}
+
+// ===================== METER =====================
+static void test_meter_hours() {
+  PowerMeter m{};
+  TEST_ASSERT_FALSE(PowerMeterRoll(m, 500));          // первый вызов — начало часа
+  PowerMeterSlept(m, 3000000);
+  TEST_ASSERT_FALSE(PowerMeterRoll(m, 500 + PWR_METER_WINDOW_MS - 1));
+  TEST_ASSERT_TRUE(PowerMeterRoll(m, 500 + PWR_METER_WINDOW_MS));
+  TEST_ASSERT_EQUAL(PWR_METER_WINDOW_MS - 3000000, m.lastAwakeMs);
+
+  // сон через границу часа: целиком в закрываемый час, бодрствование не уходит в минус
+  PowerMeterSlept(m, PWR_METER_WINDOW_MS + 60000);
+  TEST_ASSERT_TRUE(PowerMeterRoll(m, 500 + 2 * PWR_METER_WINDOW_MS + 10));
+  TEST_ASSERT_EQUAL(0, m.lastAwakeMs);
+  TEST_ASSERT_EQUAL(0, m.sleptMs);
+}
+
+// ===================== DUTY CYCLE =====================
+// опрос раз в секунду по 30 мс: бодрствуем только работу и запас на пробуждение
+static void test_sampler_duty_cycle() {
+  addClient(1000, 30);
+  runFor(3 * PWR_METER_WINDOW_MS + 1000);
+
+  TEST_ASSERT_EQUAL(3 * 3600, clients[0].wakes);
+  TEST_ASSERT_EQUAL(0, clients[0].maxLateMs);
+  TEST_ASSERT_EQUAL(3, hours.size());
+  for (uint32_t a : hours) {
+    // 30 мс работы + PWR_WAKE_GUARD_MS на каждую секунду
+    TEST_ASSERT_GREATER_OR_EQUAL(3600 * (30 + PWR_WAKE_GUARD_MS) - 1000, a);
+    TEST_ASSERT_LESS_OR_EQUAL(3600 * (30 + PWR_WAKE_GUARD_MS) + 1000, a);
+  }
+}
+
+// опрос + пакетный аплинк (20 с каждые 5 минут) через переполнение millis:
+// сроки не опаздывают, учёт часа сходится с фактом
+static void test_sampler_and_uplink_across_wrap() {
+  HostClockSet(0xFFFFFFFFu - 30 * 60000u);
+  addClient(1000, 30);
+  addClient(300000, 20000);
+  runFor(4 * PWR_METER_WINDOW_MS + 1000);
+
+  TEST_ASSERT_EQUAL(0, clients[0].maxLateMs);
+  TEST_ASSERT_EQUAL(0, clients[1].maxLateMs);
+  TEST_ASSERT_EQUAL(4 * 12, clients[1].wakes);
+  TEST_ASSERT_EQUAL(4, hours.size());
+
+  uint64_t metered = 0;
+  for (uint32_t a : hours) metered += a;
+  // часы закрываются на шаге цикла, а не точно на границе: расхождение — хвост последнего часа
+  TEST_ASSERT_LESS_OR_EQUAL(PWR_MAX_SLEEP_MS, awakeTotal > metered ? awakeTotal - metered : metered - awakeTotal);
+
+  char msg[128];
+  snprintf(msg, sizeof(msg), "awake per hour: %u s (%.1f%%)", (unsigned)(hours[1] / 1000),
+           100.0 * hours[1] / PWR_METER_WINDOW_MS);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN(PWR_METER_WINDOW_MS / 8, hours[1]);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_plan_basics);
+  RUN_TEST(test_plan_millis_wrap);
+  RUN_TEST(test_meter_hours);
+  RUN_TEST(test_sampler_duty_cycle);
+  RUN_TEST(test_sampler_and_uplink_across_wrap);
+  return UNITY_END();
+}
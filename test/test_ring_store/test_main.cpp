@@ -0,0 +1,186 @@
+// Кольцо на подменах LittleFS/NVS из test/shims: pio test -e native -f test_ring_store
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <unity.h>
+#include "ring_store.h"
+
+static const size_t FILE_SIZE = 16 + 40 * 64;   // заголовок + 64 записи
+
+static SampleRec rec(uint32_t ts) {
+  SampleRec r{};
+  r.ts = ts;
+  r.current_mA = (int32_t)ts * 10;
+  r.nCurrent = 1;
+  r.nTemp = 1;
+  return r;
+}
+
+void setUp() {
+  HostFsClear();
+  HostNvsClear();
+}
+
+void tearDown() {}
+
+// ===================== BASICS =====================
+static void test_append_peek_drop() {
+  TEST_ASSERT_TRUE(RingStoreBegin("/queue.bin", FILE_SIZE));
+  for (uint32_t i = 1; i <= 10; i++) TEST_ASSERT_TRUE(RingStoreAppend(rec(i)));
+  TEST_ASSERT_EQUAL(10, RingStoreCountApprox());
+
+  std::vector<SampleRec> out;
+  TEST_ASSERT_EQUAL(4, RingStorePeek(2, out, 4));
+  TEST_ASSERT_EQUAL(4, out.size());
+  TEST_ASSERT_EQUAL(3, out[0].ts);
+
+  TEST_ASSERT_TRUE(RingStoreDrop(3));
+  TEST_ASSERT_EQUAL(7, RingStoreCountApprox());
+  TEST_ASSERT_EQUAL(3, RingStoreTail());
+}
+
+static void test_overflow_keeps_newest() {
+  TEST_ASSERT_TRUE(RingStoreBegin("/queue.bin", FILE_SIZE));
+  for (uint32_t i = 1; i <= 100; i++) RingStoreAppend(rec(i));
+  TEST_ASSERT_EQUAL(64, RingStoreCountApprox());
+
+  std::vector<SampleRec> out;
+  RingStoreReadBatch(out, 1);
+  TEST_ASSERT_EQUAL(1, out.size());
+  TEST_ASSERT_EQUAL(37, out[0].ts);
+}
+
+// ===================== BENCH ISOLATION =====================
+// стенд PERF_BENCH открывает своё кольцо: очередь и её head/tail после него целы
+static void test_bench_ring_does_not_touch_queue() {
+  TEST_ASSERT_TRUE(RingStoreBegin("/queue.bin", FILE_SIZE));
+  for (uint32_t i = 1; i <= 5; i++) RingStoreAppend(rec(i));
+  RingStoreDrop(2);
+
+  TEST_ASSERT_TRUE(RingStoreBegin("/bench.bin", FILE_SIZE, "ringbench"));
+  TEST_ASSERT_EQUAL(0, RingStoreCountApprox());
+  RingStoreDrop(RingStoreCountApprox());
+  for (uint32_t i = 1000; i < 1100; i++) RingStoreAppend(rec(i));
+
+  TEST_ASSERT_TRUE(RingStoreBegin("/queue.bin", FILE_SIZE));
+  TEST_ASSERT_EQUAL(3, RingStoreCountApprox());
+  TEST_ASSERT_EQUAL(2, RingStoreTail());
+
+  std::vector<SampleRec> out;
+  RingStoreReadBatch(out, 8);
+  TEST_ASSERT_EQUAL(3, out.size());
+  TEST_ASSERT_EQUAL(3, out[0].ts);
+  TEST_ASSERT_EQUAL(5, out[2].ts);
+}
+
+// ===================== V1 MIGRATION =====================
+#pragma pack(push, 1)
+struct RecV1 {          // RecBinV1 из ring_store.cpp: одноканальная запись, 24 байта
+  uint32_t ts;
+  int32_t  current_mA;
+  int32_t  power_dW;
+  int16_t  temp_cC;
+  uint16_t flags;
+  uint32_t crc32;
+  uint8_t  pad[4];
+};
+#pragma pack(pop)
+
+// очередь v1 как её оставила старая прошивка: записи [tail, head) в кольце на cap
+static void writeV1Queue(uint32_t cap, uint32_t tail, uint32_t head, uint32_t corruptTs = 0) {
+  File f = LittleFS.open("/queue.bin", "w");
+  const uint32_t magic = 0x52494E47, zero = 0;
+  const uint16_t ver = 1, rs = sizeof(RecV1);
+  f.write((const uint8_t*)&magic, 4);
+  f.write((const uint8_t*)&ver, 2);
+  f.write((const uint8_t*)&rs, 2);
+  f.write((const uint8_t*)&cap, 4);
+  f.write((const uint8_t*)&zero, 4);
+  for (uint32_t i = tail; i != head; i++) {
+    RecV1 v{};
+    v.ts = 1000 + i;
+    v.current_mA = (int32_t)i * 10;
+    v.temp_cC = 2150;
+    v.crc32 = RingStoreCrc32((const uint8_t*)&v, offsetof(RecV1, crc32));
+    if (v.ts == corruptTs) v.crc32 ^= 1;
+    f.seek(16 + (i % cap) * sizeof(RecV1));
+    f.write((const uint8_t*)&v, sizeof(v));
+  }
+  f.close();
+
+  Preferences p;
+  p.begin("ring", false);
+  p.putUInt("head", head);
+  p.putUInt("tail", tail);
+  p.end();
+}
+
+static std::vector<SampleRec> readAll() {
+  std::vector<SampleRec> out;
+  RingStorePeek(0, out, RingStoreCountApprox());
+  return out;
+}
+
+// неотправленное переносится по порядку, битая запись пропускается, .v1 убран
+static void test_v1_migrated() {
+  writeV1Queue(32, 40, 60, 1050);     // кольцо v1 уже обернулось
+  TEST_ASSERT_TRUE(RingStoreBegin("/queue.bin", FILE_SIZE));
+  TEST_ASSERT_FALSE(LittleFS.exists("/queue.bin.v1"));
+
+  std::vector<SampleRec> out = readAll();
+  TEST_ASSERT_EQUAL(19, out.size());
+  TEST_ASSERT_EQUAL(1040, out[0].ts);
+  TEST_ASSERT_EQUAL(400, out[0].current_mA);
+  TEST_ASSERT_EQUAL(2150, out[0].temp_cC);
+  for (size_t i = 1; i < out.size(); i++) {
+    TEST_ASSERT_GREATER_THAN(out[i - 1].ts, out[i].ts);
+    TEST_ASSERT_NOT_EQUAL(1050, out[i].ts);
+  }
+
+  // повторный старт — уже v2, ничего не переносится второй раз
+  TEST_ASSERT_TRUE(RingStoreBegin("/queue.bin", FILE_SIZE));
+  TEST_ASSERT_EQUAL(19, RingStoreCountApprox());
+}
+
+// в v2 помещается меньше, чем было в v1: остаются свежие
+static void test_v1_larger_than_v2_keeps_newest() {
+  writeV1Queue(200, 0, 150);
+  TEST_ASSERT_TRUE(RingStoreBegin("/queue.bin", FILE_SIZE));
+  std::vector<SampleRec> out = readAll();
+  TEST_ASSERT_EQUAL(64, out.size());
+  TEST_ASSERT_EQUAL(1000 + 150 - 64, out.front().ts);
+  TEST_ASSERT_EQUAL(1000 + 149, out.back().ts);
+}
+
+// питание пропало посреди переноса (на записи head в NVS): после перезагрузки
+// перенос начинается заново, в итоге всё на месте и без дублей
+static void test_v1_migration_survives_power_cut() {
+  for (int32_t cut = 0; cut < 12; cut++) {
+    HostFsClear();
+    HostNvsClear();
+    writeV1Queue(64, 0, 40);
+    hostNvsCutAt = cut;
+    try {
+      RingStoreBegin("/queue.bin", FILE_SIZE);
+    } catch (const HostPowerCut&) {
+    }
+    hostNvsCutAt = -1;
+
+    TEST_ASSERT_TRUE(RingStoreBegin("/queue.bin", FILE_SIZE));
+    TEST_ASSERT_FALSE(LittleFS.exists("/queue.bin.v1"));
+    std::vector<SampleRec> out = readAll();
+    TEST_ASSERT_EQUAL(40, out.size());
+    for (size_t i = 0; i < out.size(); i++) TEST_ASSERT_EQUAL(1000 + i, out[i].ts);
+  }
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_append_peek_drop);
+  RUN_TEST(test_overflow_keeps_newest);
+  RUN_TEST(test_bench_ring_does_not_touch_queue);
+  RUN_TEST(test_v1_migrated);
+  RUN_TEST(test_v1_larger_than_v2_keeps_newest);
+  RUN_TEST(test_v1_migration_survives_power_cut);
+  return UNITY_END();
+}
@@ -0,0 +1,100 @@
+// Аренда seq при сбоях питания: питание пропадает в случайный момент — между
+// выдачами или прямо на записи потолка в NVS. После каждой «перезагрузки»
+// номера продолжаются без повторов, а NVS пишется раз на SEQ_LEASE номеров.
+#include <Arduino.h>
+#include <Preferences.h>
+#include <unity.h>
+#include <random>
+#include <set>
+#include "seq_lease.h"
+
+void setUp() {
+  HostNvsClear();
+}
+
+void tearDown() {}
+
+static void test_first_boot_starts_at_one() {
+  uint32_t seq = SeqLeaseBegin();
+  TEST_ASSERT_EQUAL(1, seq);
+  TEST_ASSERT_EQUAL(1, SeqTake(seq));
+  TEST_ASSERT_EQUAL(2, SeqTake(seq));
+  TEST_ASSERT_EQUAL(3, seq);
+}
+
+// одна запись NVS на блок, а не на каждый запрос
+static void test_one_write_per_lease() {
+  uint32_t seq = SeqLeaseBegin();
+  uint32_t before = hostNvsWrites;
+  for (int i = 0; i < 64 * 20; i++) SeqTake(seq);
+  TEST_ASSERT_LESS_OR_EQUAL(20 + 1, hostNvsWrites - before);
+}
+
+// перезагрузка без сбоя: продолжаем с потолка, номера растут
+static void test_reboot_skips_to_ceiling() {
+  uint32_t seq = SeqLeaseBegin();
+  for (int i = 0; i < 10; i++) SeqTake(seq);
+  uint32_t last = seq - 1;
+
+  seq = SeqLeaseBegin();
+  TEST_ASSERT_GREATER_THAN(last, seq);
+  TEST_ASSERT_LESS_OR_EQUAL(1 + SEQ_LEASE, seq);
+}
+
+// случайные сбои: между выдачами и на самой записи потолка
+static void test_random_power_cuts_never_reuse_seq() {
+  std::mt19937 rng(2024);
+  std::set<uint32_t> issued;
+  uint32_t lastIssued = 0;
+  int cutsOnWrite = 0;
+
+  for (int boot = 0; boot < 2000; boot++) {
+    // рвём либо на k-й записи NVS, либо после n выдач (запись могла и не понадобиться)
+    bool onWrite = rng() % 2;
+    hostNvsCutAt = onWrite ? (int32_t)(rng() % 3) : -1;
+    uint32_t takes = rng() % 200;
+
+    try {
+      uint32_t seq = SeqLeaseBegin();
+      for (uint32_t i = 0; i < takes; i++) {
+        uint32_t s = SeqTake(seq);
+        // выданный номер уходит в пакет: повтор — это отказ сервера по nonce/цепочке
+        TEST_ASSERT_TRUE(issued.insert(s).second);
+        TEST_ASSERT_GREATER_THAN(lastIssued, s);
+        lastIssued = s;
+      }
+    } catch (const HostPowerCut&) {
+      cutsOnWrite++;
+    }
+    hostNvsCutAt = -1;
+  }
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "%u seq issued over 2000 boots, %d cuts on NVS write",
+           (unsigned)issued.size(), cutsOnWrite);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_GREATER_THAN(100, cutsOnWrite);
+}
+
+// NVS временно не пишет: аренда не считается продлённой, пока запись не пройдёт
+static void test_failed_write_is_retried() {
+  uint32_t seq = SeqLeaseBegin();
+  while (seq < SEQ_LEASE - 2) SeqTake(seq);
+
+  hostNvsFull = true;
+  for (int i = 0; i < 4; i++) SeqTake(seq);     // потолок не продлился
+  hostNvsFull = false;
+  uint32_t last = SeqTake(seq);                 // продлится на этой выдаче
+
+  TEST_ASSERT_GREATER_THAN(last, SeqLeaseBegin());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_boot_starts_at_one);
+  RUN_TEST(test_one_write_per_lease);
+  RUN_TEST(test_reboot_skips_to_ceiling);
+  RUN_TEST(test_random_power_cuts_never_reuse_seq);
+  RUN_TEST(test_failed_write_is_retried);
+  return UNITY_END();
+}
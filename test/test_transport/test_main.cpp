@@ -0,0 +1,402 @@
+// Выбор канала и конвейер выгрузки поверх петлевых транспортов: каждый — Client,
+// который разбирает настоящий HTTP-запрос и отдаёт его подставному серверу в том
+// же процессе. Скорость и задержка канала — на виртуальных часах, поэтому замер
+// TransportReport и время выгрузки сравнимы с GPRS/Ethernet на железе.
+//   pio test -e native -f test_transport -v
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <unity.h>
+#include <deque>
+#include <set>
+#include <string>
+#include "transport.h"
+#include "uplink_fsm.h"       // DATA_BATCH_MAX
+#include "uplink_window.h"
+
+// ===================== STAND-IN SERVER =====================
+// правила POST /data из index (2).php: nonce, цепочка seq/prev, кумулятивный ack
+struct StandIn {
+  uint32_t ack = 0;
+  std::set<std::string> nonces;
+  std::set<uint32_t> stored;
+  uint32_t inserted = 0;
+
+  // тело — "seq prev nonce ts,ts,..." вместо JSON+AES
+  int handle(const std::string& req, std::string& body) {
+    uint32_t seq, prev, nonce;
+    int n = 0;
+    sscanf(req.c_str(), "%u %u %x %n", &seq, &prev, &nonce, &n);
+    char nb[16];
+    snprintf(nb, sizeof(nb), "%08x", nonce);
+
+    bool fresh = nonces.insert(nb).second;
+    if (!fresh && seq <= ack) return ok(body);
+    if (prev > ack) {
+      body = "{\"status\":\"gap\",\"ack\":" + std::to_string(ack) + "}";
+      return 409;
+    }
+    for (const char* p = req.c_str() + n; *p;) {
+      char* end;
+      uint32_t ts = strtoul(p, &end, 10);
+      if (end == p) break;
+      inserted++;
+      stored.insert(ts);
+      p = *end == ',' ? end + 1 : end;
+    }
+    if (seq > ack) ack = seq;
+    return ok(body);
+  }
+
+  int ok(std::string& body) {
+    body = "{\"status\":\"OK\",\"ack\":" + std::to_string(ack) + "}";
+    return 200;
+  }
+};
+
+static StandIn srv;
+
+// ===================== LOOPBACK TRANSPORT =====================
+class LoopbackClient : public Client {
+public:
+  uint32_t bytesPerS = 1000;
+  uint32_t oneWayMs = 1000;
+  bool*    linkUp = nullptr;
+  int      dropAfterRequests = -1;  // обрыв канала после стольких запросов
+  uint32_t requests = 0;
+
+  int connect(const char*, uint16_t) override {
+    if (!*linkUp) return 0;
+    HostClockAdvance(3 * oneWayMs);   // рукопожатие TCP
+    open = true;
+    rx.clear();
+    replies.clear();
+    return 1;
+  }
+
+  // запись блокирует на время передачи, как AT+CIPSEND у модема или W5x00 по SPI
+  size_t write(const uint8_t* buf, size_t size) override {
+    if (!connected()) return 0;
+    if (dropAfterRequests >= 0 && (int)requests >= dropAfterRequests) {
+      *linkUp = false;
+      open = false;
+      return 0;
+    }
+    HostClockAdvance((uint32_t)((uint64_t)size * 1000 / bytesPerS));
+    rx.append((const char*)buf, size);
+    serve();
+    return size;
+  }
+
+  int available() override {
+    if (replies.empty() || (int32_t)(millis() - replies.front().atMs) < 0) return 0;
+    return (int)(replies.front().raw.size() - replies.front().pos);
+  }
+
+  int read(uint8_t* buf, size_t size) override {
+    int n = min((int)size, available());
+    if (n <= 0) return 0;
+    Reply& r = replies.front();
+    memcpy(buf, r.raw.data() + r.pos, n);
+    r.pos += n;
+    if (r.pos == r.raw.size()) replies.pop_front();
+    return n;
+  }
+
+  void stop() override { open = false; }
+  uint8_t connected() override { return open && *linkUp; }
+
+private:
+  struct Reply { uint32_t atMs; std::string raw; size_t pos; };
+  bool open = false;
+  std::string rx;
+  std::deque<Reply> replies;
+
+  // разбор запросов HTTP/1.1 из потока: заголовки до пустой строки, тело по Content-Length
+  void serve() {
+    for (;;) {
+      size_t hdrEnd = rx.find("\r\n\r\n");
+      if (hdrEnd == std::string::npos) return;
+      size_t cl = rx.find("Content-Length: ");
+      TEST_ASSERT_TRUE(rx.compare(0, 16, "POST /data HTTP/") == 0);
+      TEST_ASSERT_TRUE(cl != std::string::npos && cl < hdrEnd);
+      size_t len = strtoul(rx.c_str() + cl + 16, nullptr, 10);
+      if (rx.size() < hdrEnd + 4 + len) return;
+
+      std::string body;
+      int status = srv.handle(rx.substr(hdrEnd + 4, len), body);
+      rx.erase(0, hdrEnd + 4 + len);
+      requests++;
+
+      char hdr[128];
+      snprintf(hdr, sizeof(hdr), "HTTP/1.1 %d X\r\nContent-Length: %u\r\nConnection: keep-alive\r\n\r\n",
+               status, (unsigned)body.size());
+      replies.push_back({ (uint32_t)millis() + 2 * oneWayMs, hdr + body, 0 });
+    }
+  }
+};
+
+class LoopbackTransport : public Transport {
+public:
+  LoopbackTransport(const char* n, uint32_t prior, uint32_t bps, uint32_t oneWayMs) : nm(n) {
+    priorBps = prior;
+    cl.bytesPerS = bps;
+    cl.oneWayMs = oneWayMs;
+    cl.linkUp = &up;
+  }
+
+  const char* name() const override { return nm; }
+  bool begin() override { return true; }
+  bool linkUp() override { return up; }
+  bool resolve(const String&, String& ip) override { ip = "127.0.0.1"; return true; }
+  Client& client() override { return cl; }
+
+  bool up = false;
+  LoopbackClient cl;
+
+private:
+  const char* nm;
+};
+
+// априорные оценки — как у настоящих каналов; скорость и RTT — типичные
+static LoopbackTransport gsm("gsm", 1000, 4000, 1000);
+static LoopbackTransport eth("eth", 500000, 1000000, 5);
+static LoopbackTransport wifi("wifi", 200000, 300000, 20);
+
+static void resetLink(LoopbackTransport& t) {
+  t.up = false;
+  t.rateBps = 0;
+  t.cl.stop();
+  t.cl.dropAfterRequests = -1;
+  t.cl.requests = 0;
+}
+
+// ===================== PIPELINE =====================
+// то же, что httpOpen/httpSendRequest/httpReadResponse в gsm_uplink.cpp: канал
+// выбирается на каждое соединение, замер — запись запроса + приход ответа
+static Transport* net = nullptr;
+static std::deque<uint32_t> sentWriteUs;
+static std::deque<size_t> sentBytes;
+static std::vector<uint32_t> seqsTaken;
+static uint32_t total;
+
+static bool build(const std::vector<SampleRec>& batch, uint32_t seq, uint32_t prev, std::vector<uint8_t>& blob) {
+  char head[48];
+  snprintf(head, sizeof(head), "%u %u %08x ", (unsigned)seq, (unsigned)prev, (unsigned)rand());
+  std::string s = head;
+  for (size_t i = 0; i < batch.size(); i++) s += (i ? "," : "") + std::to_string(batch[i].ts);
+  s.append(300, ' ');               // размер как у настоящего пакета после LZ+AES
+  blob.assign(s.begin(), s.end());
+  return true;
+}
+
+static uint32_t takeSeq(uint32_t& seq) {
+  seqsTaken.push_back(seq);
+  return seq++;
+}
+
+static bool pipeOpen() {
+  net = TransportSelect();
+  if (!net) return false;
+  net->client().stop();
+  sentWriteUs.clear();
+  sentBytes.clear();
+  String ip;
+  return net->resolve("example.org", ip) && net->client().connect(ip.c_str(), 80);
+}
+
+static bool pipeSend(const uint8_t* blob, size_t len) {
+  std::string req = "POST /data HTTP/1.1\r\nHost: example.org\r\nConnection: keep-alive\r\n"
+                    "Content-Type: application/octet-stream\r\nContent-Length: " + std::to_string(len) + "\r\n\r\n";
+  req.append((const char*)blob, len);
+  uint32_t t0 = micros();
+  if (net->client().write((const uint8_t*)req.data(), req.size()) != req.size()) return false;
+  sentWriteUs.push_back(micros() - t0);
+  sentBytes.push_back(req.size());
+  return true;
+}
+
+static bool pipeRecv(HttpResp& resp) {
+  HttpRespReset(resp);
+  Client& cl = net->client();
+  uint32_t t0 = millis();
+  uint32_t rxT0 = 0;
+  while (!HttpRespDone(resp) && !HttpRespFailed(resp)) {
+    uint8_t buf[256];
+    int n = cl.available() > 0 ? cl.read(buf, sizeof(buf)) : 0;
+    if (n > 0) {
+      if (!rxT0) rxT0 = micros() | 1;
+      HttpRespFeed(resp, buf, n);
+      continue;
+    }
+    if (!cl.connected()) return false;
+    if (millis() - t0 > 15000) return false;
+    HostClockAdvance(20);
+  }
+  if (!HttpRespDone(resp) || sentBytes.empty()) return false;
+  TransportReport(net, sentBytes.front() + resp.body.length(), sentWriteUs.front() + (micros() - rxT0));
+  sentBytes.pop_front();
+  sentWriteUs.pop_front();
+  return true;
+}
+
+static void pipeClose() {
+  if (net) net->client().stop();
+}
+
+static void onBody(const String&) {}
+
+static const WindowOps ops = { build, takeSeq, pipeOpen, pipeSend, pipeRecv, pipeClose, onBody };
+
+// ===================== HELPERS =====================
+static uint32_t seq, lastAck;
+
+static void fillRing(uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    SampleRec r{};
+    r.ts = 1760000000 + total;
+    r.nCurrent = 1;
+    r.nTemp = 1;
+    RingStoreAppend(r);
+    total++;
+  }
+}
+
+static int drainAll(int maxSessions = 50) {
+  for (int i = 0; i < maxSessions; i++) {
+    if (UplinkWindowSend(seq, lastAck) == WIN_EMPTY) return i;
+  }
+  return -1;
+}
+
+static void assertAllDeliveredOnce() {
+  TEST_ASSERT_EQUAL(0, RingStoreCountApprox());
+  TEST_ASSERT_EQUAL(total, srv.stored.size());
+  TEST_ASSERT_EQUAL(total, srv.inserted);
+  for (size_t i = 1; i < seqsTaken.size(); i++) TEST_ASSERT_GREATER_THAN(seqsTaken[i - 1], seqsTaken[i]);
+}
+
+// время выгрузки n записей по одному каналу, мс виртуального времени
+static uint32_t drainTime(LoopbackTransport& t, uint32_t n) {
+  resetLink(gsm);
+  resetLink(eth);
+  resetLink(wifi);
+  t.up = true;
+  fillRing(n);
+  uint32_t t0 = millis();
+  TEST_ASSERT_GREATER_OR_EQUAL(0, drainAll());
+  return millis() - t0;
+}
+
+void setUp() {
+  HostFsClear();
+  HostNvsClear();
+  HostClockSet(0);
+  RingStoreBegin("/queue.bin", 16 + 40 * 1024);
+  srv = StandIn{};
+  resetLink(gsm);
+  resetLink(eth);
+  resetLink(wifi);
+  net = nullptr;
+  seqsTaken.clear();
+  total = 0;
+  seq = 1;
+  lastAck = 0;
+  UplinkWindowInit(ops);
+}
+
+void tearDown() {}
+
+// ===================== TESTS =====================
+// среди поднятых; до замеров — по априорной оценке
+static void test_select_by_link_and_prior() {
+  TEST_ASSERT_TRUE(TransportSelect() == nullptr);
+  gsm.up = true;
+  TEST_ASSERT_TRUE(TransportSelect() == &gsm);
+  wifi.up = true;
+  TEST_ASSERT_TRUE(TransportSelect() == &wifi);
+  eth.up = true;
+  TEST_ASSERT_TRUE(TransportSelect() == &eth);
+  eth.up = false;
+  TEST_ASSERT_TRUE(TransportSelect() == &wifi);
+}
+
+// замер важнее оценки: Ethernet за медленным аплинком проигрывает WiFi
+static void test_measured_rate_overrides_prior() {
+  eth.up = wifi.up = true;
+  TransportReport(&eth, 2000, 1000000);
+  TEST_ASSERT_EQUAL(2000, eth.rateBps);
+  TEST_ASSERT_TRUE(TransportSelect() == &wifi);
+
+  // EWMA 3/4: один быстрый обмен не перевешивает историю сразу
+  TransportReport(&eth, 1000000, 1000000);
+  TEST_ASSERT_EQUAL((2000 * 3 + 1000000) / 4, eth.rateBps);
+  TEST_ASSERT_TRUE(TransportSelect() == &eth);
+
+  // пустой обмен не замер, нулевое время не делит на ноль
+  uint32_t r = eth.rateBps;
+  TransportReport(&eth, 0, 5);
+  TEST_ASSERT_EQUAL(r, eth.rateBps);
+  TransportReport(&eth, 100, 0);
+  TEST_ASSERT_GREATER_THAN(r, eth.rateBps);
+}
+
+// замер по конвейеру — скорость канала, а не RTT: ожидание сервера в него не входит
+static void test_pipeline_measures_link_rate() {
+  drainTime(gsm, 80);
+  assertAllDeliveredOnce();
+  TEST_ASSERT_GREATER_THAN(4000 / 2, gsm.rateBps);
+  TEST_ASSERT_LESS_OR_EQUAL(4000 * 2, gsm.rateBps);
+}
+
+// посреди сеанса GPRS пропал, поднялся Ethernet: следующее соединение идёт по нему,
+// с кольца снято только подтверждённое — ни потерь, ни дублей
+static void test_switch_mid_session_loses_nothing() {
+  gsm.up = true;
+  gsm.cl.dropAfterRequests = 6;
+  fillRing(400);
+  TEST_ASSERT_EQUAL(WIN_FAIL, UplinkWindowSend(seq, lastAck));
+  TEST_ASSERT_GREATER_THAN(0, lastAck);
+  TEST_ASSERT_GREATER_THAN(0, RingStoreCountApprox());
+
+  eth.up = true;
+  TEST_ASSERT_GREATER_OR_EQUAL(0, drainAll());
+  assertAllDeliveredOnce();
+  TEST_ASSERT_EQUAL(6, gsm.cl.requests);
+  TEST_ASSERT_GREATER_THAN(0, eth.cl.requests);
+  TEST_ASSERT_TRUE(net == &eth);
+}
+
+// выгрузка бэклога по каждому каналу отдельно
+static void test_bench_links() {
+  const uint32_t N = 800;
+  uint32_t tGsm = drainTime(gsm, N);
+  assertAllDeliveredOnce();
+  setUp();
+  uint32_t tWifi = drainTime(wifi, N);
+  assertAllDeliveredOnce();
+  setUp();
+  uint32_t tEth = drainTime(eth, N);
+  assertAllDeliveredOnce();
+
+  char msg[192];
+  snprintf(msg, sizeof(msg), "%u records: gsm %u ms, wifi %u ms, eth %u ms (eth x%.0f vs gsm)",
+           (unsigned)N, (unsigned)tGsm, (unsigned)tWifi, (unsigned)tEth, (double)tGsm / tEth);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN(tGsm / 100, tEth);
+  TEST_ASSERT_LESS_THAN(tGsm, tWifi);
+}
+
+int main(int, char**) {
+  TransportAdd(&gsm);
+  TransportAdd(&eth);
+  TransportAdd(&wifi);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_select_by_link_and_prior);
+  RUN_TEST(test_measured_rate_overrides_prior);
+  RUN_TEST(test_pipeline_measures_link_rate);
+  RUN_TEST(test_switch_mid_session_loses_nothing);
+  RUN_TEST(test_bench_links);
+  return UNITY_END();
+}
@@ -0,0 +1,287 @@
+// Автомат аплинка против поддельного модема на виртуальных часах: сценарий задаёт,
+// когда есть связь, сколько длится обмен и сколько записей копится в кольце.
+// Меряются пропускная способность и время восстановления после пропадания связи.
+//   pio test -e native -f test_uplink_fsm -v
+#include <Arduino.h>
+#include <unity.h>
+#include <random>
+#include <vector>
+#include "uplink_fsm.h"
+
+// ===================== FAKE MODEM =====================
+struct Window { uint32_t from, to; };   // связь есть в [from, to)
+
+struct FakeModem {
+  std::vector<Window> up;
+  bool     modemAlive   = true;
+  bool     otherLink    = false;  // Ethernet/WiFi при мёртвом модеме
+  uint32_t initMs       = 8000;
+  uint32_t reconnectMs  = 20000;
+  uint32_t rttMs        = 1500;
+  uint32_t timeoutMs    = 15000;  // обмен без связи
+  uint32_t recordEveryMs = 10000; // стадия хранения кладёт запись
+
+  uint32_t produced  = 0;
+  uint32_t backlog   = 0;
+  uint32_t delivered = 0;
+  uint32_t sessions  = 0;
+  uint32_t lastSessionMs = 0;
+  uint32_t rests     = 0;
+  bool     resting   = false;
+  uint32_t nextRecordMs = 0;
+  bool     dataCmd   = false;     // UplinkFsmNoteStored просит разбудить
+
+  std::vector<std::pair<uint32_t, UplinkCmd>> commands;  // время -> команда
+  std::vector<uint32_t> okAt;       // моменты успешной выгрузки
+  std::vector<uint32_t> backoffs;   // backoffWaitMs при каждом входе в BACKOFF
+  std::vector<uint32_t> maxDelay;   // наибольшая задержка записи к моменту выгрузки
+  std::vector<uint32_t> pendingTs;  // время появления каждой записи в кольце
+  std::mt19937 rng{1};
+};
+
+static FakeModem fm;
+
+static bool linkNow() {
+  if (fm.resting) return false;
+  uint32_t now = millis();
+  for (const Window& w : fm.up) {
+    if (now >= w.from && now < w.to) return true;
+  }
+  return false;
+}
+
+// время идёт — стадия хранения добавляет записи
+static void advance(uint32_t ms) {
+  uint32_t end = millis() + ms;
+  while ((int32_t)(fm.nextRecordMs - end) <= 0) {
+    HostClockSet(fm.nextRecordMs);
+    fm.produced++;
+    fm.backlog++;
+    fm.pendingTs.push_back(millis());
+    if (UplinkFsmNoteStored(1)) fm.dataCmd = true;
+    fm.nextRecordMs += fm.recordEveryMs;
+  }
+  HostClockSet(end);
+}
+
+static void deliver(uint32_t n) {
+  uint32_t now = millis();
+  for (uint32_t i = 0; i < n; i++) fm.maxDelay.push_back(now - fm.pendingTs[i]);
+  fm.pendingTs.erase(fm.pendingTs.begin(), fm.pendingTs.begin() + n);
+  fm.backlog -= n;
+  fm.delivered += n;
+}
+
+// обмен: rtt при связи, таймаут — без неё
+static bool exchange() {
+  bool ok = linkNow();
+  advance(ok ? fm.rttMs : fm.timeoutMs);
+  return ok && linkNow();
+}
+
+static bool opModemInit() { advance(fm.initMs); fm.resting = false; return fm.modemAlive; }
+static bool opLinkUp() { return fm.otherLink; }
+static bool opSessionBegin() {
+  if (!linkNow() && !fm.otherLink) return false;
+  fm.sessions++;
+  fm.lastSessionMs = millis();
+  return true;
+}
+static bool opModemReady() { return fm.modemAlive; }
+static void opReconnect() { advance(fm.reconnectMs); }
+static void opSync(Uplink&) { exchange(); }
+static bool opSendLatest(Uplink&) {
+  bool ok = fm.otherLink || exchange();
+  if (ok) fm.okAt.push_back(millis());
+  return ok;
+}
+static SendResult opSendData(Uplink&) {
+  if (!fm.backlog) return SEND_EMPTY;
+  if (!fm.otherLink && !exchange()) return SEND_FAIL;
+  deliver(min<uint32_t>(fm.backlog, DATA_BATCH_MAX));
+  fm.okAt.push_back(millis());
+  return SEND_OK;
+}
+static SendResult opSendBackfill() { return SEND_EMPTY; }
+static void opModemRest() { fm.resting = true; fm.rests++; }
+static void opModemWake() { fm.resting = false; }
+
+// ждёт команду, запись на пороге пакета или срок — что раньше
+static UplinkCmd opWaitCommand(uint32_t waitMs) {
+  uint32_t until = millis() + waitMs;
+  while ((int32_t)(millis() - until) < 0) {
+    if (!fm.commands.empty() && (int32_t)(fm.commands.front().first - millis()) <= 0) {
+      UplinkCmd c = fm.commands.front().second;
+      fm.commands.erase(fm.commands.begin());
+      return c;
+    }
+    fm.dataCmd = false;
+    advance(min<uint32_t>(100, until - millis()));
+    if (fm.dataCmd) return UL_CMD_DATA;
+  }
+  return UL_CMD_NONE;
+}
+
+static void opUploaded() {}
+static uint32_t opRandom() { return fm.rng(); }
+
+static const UplinkOps fakeOps = {
+  opModemInit, opLinkUp, opSessionBegin, opModemReady, opReconnect, opSync,
+  opSendLatest, opSendData, opSendBackfill, opModemRest, opModemWake,
+  opWaitCommand, opUploaded, opRandom,
+};
+
+// ===================== DRIVER =====================
+static Uplink u;
+static uint32_t worstOverrunMs;   // насколько состояние пережило свой срок
+
+// цикл gsmTask: шаг автомата + vTaskDelay(10)
+static void runUntil(uint32_t untilMs) {
+  while ((int32_t)(millis() - untilMs) < 0) {
+    UplinkState before = u.state;
+    UplinkFsmStep(u);
+    if (u.state == UL_BACKOFF && before != UL_BACKOFF) fm.backoffs.push_back(u.backoffWaitMs);
+    if (u.state == before) {
+      int32_t over = (int32_t)(millis() - u.enteredMs - UplinkStateDeadlineMs(u));
+      if (over > (int32_t)worstOverrunMs) worstOverrunMs = over;
+    }
+    advance(10);
+  }
+}
+
+static uint32_t firstOkAfter(uint32_t t) {
+  for (uint32_t ok : fm.okAt) {
+    if (ok >= t) return ok;
+  }
+  return UINT32_MAX;
+}
+
+static void report(const char* name) {
+  char msg[160];
+  uint32_t worst = 0;
+  for (uint32_t d : fm.maxDelay) worst = max(worst, d);
+  snprintf(msg, sizeof(msg), "%s: produced=%u delivered=%u sessions=%u rests=%u worst_delay=%us overrun=%ums",
+           name, (unsigned)fm.produced, (unsigned)fm.delivered, (unsigned)fm.sessions, (unsigned)fm.rests,
+           (unsigned)(worst / 1000), (unsigned)worstOverrunMs);
+  TEST_MESSAGE(msg);
+}
+
+static const uint32_t HOUR = 3600000;
+
+void setUp() {
+  fm = FakeModem{};
+  HostClockSet(0);
+  fm.nextRecordMs = fm.recordEveryMs;
+  worstOverrunMs = 0;
+  UplinkFsmSetMaxLatency(0);
+  UplinkFsmInit(u, fakeOps, 100);
+}
+
+void tearDown() {}
+
+// ===================== SCENARIOS =====================
+// стабильная связь: всё доставлено, задержка записи — не больше интервала отправки
+static void test_steady_link() {
+  fm.up = { { 0, 10 * HOUR } };
+  runUntil(HOUR);
+  report("steady");
+
+  TEST_ASSERT_EQUAL(0, fm.backoffs.size());
+  TEST_ASSERT_GREATER_OR_EQUAL(fm.produced - DATA_BATCH_MAX, fm.delivered);
+  for (uint32_t d : fm.maxDelay) TEST_ASSERT_LESS_OR_EQUAL(90000, d);
+}
+
+// связь пропала на 10 минут: backoff растёт, после возврата связи выгрузка
+// возобновляется не позже самой длинной паузы backoff, ничего не теряется
+static void test_link_flap_recovery() {
+  const uint32_t downFrom = 20 * 60000, downTo = 30 * 60000;
+  fm.up = { { 0, downFrom }, { downTo, 10 * HOUR } };
+  runUntil(HOUR);
+  report("flap");
+
+  uint32_t recovery = firstOkAfter(downTo) - downTo;
+  char msg[64];
+  snprintf(msg, sizeof(msg), "flap: recovery %u ms", (unsigned)recovery);
+  TEST_MESSAGE(msg);
+
+  TEST_ASSERT_GREATER_THAN(0, fm.backoffs.size());
+  TEST_ASSERT_LESS_OR_EQUAL(300000 * 5 / 4 + 5000 + fm.reconnectMs + 3 * fm.timeoutMs, recovery);
+  TEST_ASSERT_GREATER_OR_EQUAL(fm.produced - DATA_BATCH_MAX, fm.delivered);
+  TEST_ASSERT_LESS_OR_EQUAL(fm.reconnectMs + fm.timeoutMs, worstOverrunMs);
+}
+
+// частые короткие обрывы (30 с связи нет каждые 3 минуты)
+static void test_frequent_flaps() {
+  for (uint32_t t = 0; t < 2 * HOUR; t += 180000) fm.up.push_back({ t, t + 150000 });
+  runUntil(2 * HOUR);
+  report("flaps");
+
+  TEST_ASSERT_GREATER_THAN(fm.produced * 9 / 10, fm.delivered);
+  TEST_ASSERT_LESS_OR_EQUAL(fm.reconnectMs + fm.timeoutMs, worstOverrunMs);
+}
+
+// связи нет совсем: паузы растут экспонентой 5 с .. 300 с, джиттер ±25%
+static void test_backoff_growth() {
+  runUntil(2 * HOUR);
+  report("no link");
+
+  TEST_ASSERT_GREATER_THAN(6, fm.backoffs.size());
+  uint32_t base = 5000;
+  for (uint32_t w : fm.backoffs) {
+    TEST_ASSERT_GREATER_OR_EQUAL(base - base / 4, w);
+    TEST_ASSERT_LESS_OR_EQUAL(base + base / 4, w);
+    base = min<uint32_t>(base * 2, 300000);
+  }
+  TEST_ASSERT_EQUAL(0, fm.delivered);
+  TEST_ASSERT_LESS_OR_EQUAL(fm.reconnectMs + fm.timeoutMs, worstOverrunMs);
+}
+
+// команда «отправить сейчас» прерывает ожидание в IDLE
+static void test_send_now_wakes_idle() {
+  fm.up = { { 0, 10 * HOUR } };
+  fm.recordEveryMs = HOUR;          // данные не будят, только срок и команда
+  fm.nextRecordMs = HOUR;
+  // сеансы по сроку — в 8 с, 38 с, 68 с (подъём модема 8 с, интервал 30 с);
+  // команда посреди интервала начинает сеанс сразу, не дожидаясь 98 с
+  const uint32_t cmdAt = 75000;
+  fm.commands.push_back({ cmdAt, UL_CMD_SEND_NOW });
+  runUntil(cmdAt + 1000);
+  TEST_ASSERT_EQUAL(4, fm.sessions);
+  TEST_ASSERT_GREATER_OR_EQUAL(cmdAt, fm.lastSessionMs);
+  TEST_ASSERT_LESS_OR_EQUAL(cmdAt + 100, fm.lastSessionMs);
+}
+
+// пакетный режим: модем спит между сеансами, задержка записи ограничена uplinkMaxS
+static void test_burst_mode() {
+  fm.up = { { 0, 10 * HOUR } };
+  UplinkFsmSetMaxLatency(600000);
+  runUntil(3 * HOUR);
+  report("burst");
+
+  TEST_ASSERT_GREATER_THAN(10, fm.rests);
+  TEST_ASSERT_LESS_THAN(3 * HOUR / 60000, fm.sessions);   // реже, чем раз в минуту
+  for (uint32_t d : fm.maxDelay) TEST_ASSERT_LESS_OR_EQUAL(600000 + 60000, d);
+  UplinkFsmSetMaxLatency(0);
+}
+
+// модем не поднялся, но есть Ethernet: работаем без GPRS
+static void test_dead_modem_other_link() {
+  fm.modemAlive = false;
+  fm.otherLink = true;
+  runUntil(HOUR);
+  report("ethernet");
+
+  TEST_ASSERT_GREATER_OR_EQUAL(fm.produced - DATA_BATCH_MAX, fm.delivered);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_steady_link);
+  RUN_TEST(test_link_flap_recovery);
+  RUN_TEST(test_frequent_flaps);
+  RUN_TEST(test_backoff_growth);
+  RUN_TEST(test_send_now_wakes_idle);
+  RUN_TEST(test_burst_mode);
+  RUN_TEST(test_dead_modem_other_link);
+  return UNITY_END();
+}
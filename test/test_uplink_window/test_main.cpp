@@ -0,0 +1,296 @@
+// Конвейерная выгрузка против подставного сервера: правила цепочки seq/prev и
+// кумулятивного ack — те же, что у POST /data в index (2).php. Сеть — виртуальная:
+// задержка в одну сторону, скорость канала, потеря ответа или обрыв по сценарию.
+//   pio test -e native -f test_uplink_window -v
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <unity.h>
+#include <deque>
+#include <set>
+#include <string>
+#include "uplink_fsm.h"       // DATA_BATCH_MAX
+#include "uplink_window.h"
+
+// ===================== STAND-IN SERVER =====================
+struct StandIn {
+  bool registered = true;
+  uint32_t ack = 0;
+  std::set<std::string> nonces;
+  std::set<uint32_t> stored;        // ts принятых записей (в тесте уникальны; дубль виден по inserted)
+  uint32_t inserted = 0;            // вставок, включая попытки дубля
+  uint32_t replays = 0;             // повтор того же блоба (nonce уже был)
+  uint32_t gaps = 0;
+  std::set<uint32_t> failOnce;      // seq, на которые один раз ответить 500
+
+  // тело запроса в тесте — "seq prev nonce ts,ts,..." вместо JSON+AES
+  int handle(const std::string& req, std::string& body) {
+    uint32_t seq, prev, nonce;
+    int n = 0;
+    sscanf(req.c_str(), "%u %u %x %n", &seq, &prev, &nonce, &n);
+    char nb[16];
+    snprintf(nb, sizeof(nb), "%08x", nonce);
+
+    if (!registered) { body = "{\"status\":\"notreg\"}"; return 403; }
+    if (failOnce.erase(seq)) { body = "{\"status\":\"error\"}"; return 500; }
+
+    bool fresh = nonces.insert(nb).second;
+    if (!fresh) replays++;
+    if (!fresh && seq <= ack) return ok(body);
+    if (prev > ack) {
+      gaps++;
+      body = "{\"status\":\"gap\",\"ack\":" + std::to_string(ack) + "}";
+      return 409;
+    }
+
+    for (const char* p = req.c_str() + n; *p;) {
+      char* end;
+      uint32_t ts = strtoul(p, &end, 10);
+      if (end == p) break;
+      inserted++;
+      stored.insert(ts);
+      p = *end == ',' ? end + 1 : end;
+    }
+    if (seq > ack) ack = seq;
+    return ok(body);
+  }
+
+  int ok(std::string& body) {
+    body = "{\"status\":\"OK\",\"ack\":" + std::to_string(ack) + "}";
+    return 200;
+  }
+};
+
+// ===================== VIRTUAL NETWORK =====================
+struct Net {
+  uint32_t oneWayMs = 1000;         // GPRS: RTT ~2 с
+  uint32_t bytesPerS = 4000;
+  uint32_t timeoutMs = 15000;
+  int      dropAfterSends = -1;     // обрыв: столько запросов дойдёт, дальше — ни запросов, ни ответов
+  int      loseResponseOf = -1;     // номер запроса, ответ на который потеряется (сервер его обработал)
+
+  bool open = false;
+  int sends = 0;
+  uint32_t linkFreeMs = 0;          // канал вверх занят до
+  struct Reply { uint32_t atMs; bool lost; std::string raw; };
+  std::deque<Reply> replies;
+};
+
+static StandIn srv;
+static Net net;
+static std::vector<uint32_t> seqsTaken;
+static uint32_t total;              // записей положено в кольцо
+
+static bool build(const std::vector<SampleRec>& batch, uint32_t seq, uint32_t prev, std::vector<uint8_t>& blob) {
+  char head[48];
+  snprintf(head, sizeof(head), "%u %u %08x ", (unsigned)seq, (unsigned)prev, (unsigned)rand());
+  std::string s = head;
+  for (size_t i = 0; i < batch.size(); i++) s += (i ? "," : "") + std::to_string(batch[i].ts);
+  s.append(300, ' ');               // размер как у настоящего пакета из 8 записей после LZ+AES
+  blob.assign(s.begin(), s.end());
+  return true;
+}
+
+static uint32_t takeSeq(uint32_t& seq) {
+  seqsTaken.push_back(seq);
+  return seq++;
+}
+
+static bool netOpen() {
+  HostClockAdvance(3 * net.oneWayMs);   // TCP handshake через модем
+  net.open = true;
+  net.replies.clear();
+  net.linkFreeMs = millis();
+  return true;
+}
+
+static bool netSend(const uint8_t* blob, size_t len) {
+  if (!net.open) return false;
+  int idx = net.sends++;
+  if (net.dropAfterSends >= 0 && idx >= net.dropAfterSends) {
+    net.open = false;
+    return false;
+  }
+  // запись в модем блокирует на время передачи; ответ сервера — через RTT после прихода
+  uint32_t txMs = (uint32_t)(len * 1000 / net.bytesPerS);
+  uint32_t start = max((uint32_t)millis(), net.linkFreeMs);
+  net.linkFreeMs = start + txMs;
+  HostClockSet(net.linkFreeMs);
+
+  std::string body;
+  int status = srv.handle(std::string((const char*)blob, len), body);
+  char hdr[128];
+  snprintf(hdr, sizeof(hdr), "HTTP/1.1 %d X\r\nContent-Length: %u\r\nConnection: keep-alive\r\n\r\n",
+           status, (unsigned)body.size());
+  net.replies.push_back({ net.linkFreeMs + 2 * net.oneWayMs, idx == net.loseResponseOf, hdr + body });
+  return true;
+}
+
+static bool netRecv(HttpResp& resp) {
+  // кольцо не теряет ничего: неподтверждённое ещё в нём
+  TEST_ASSERT_GREATER_OR_EQUAL(total, RingStoreCountApprox() + srv.stored.size());
+
+  if (!net.open || net.replies.empty() || net.replies.front().lost) {
+    HostClockAdvance(net.timeoutMs);
+    net.open = false;
+    return false;
+  }
+  Net::Reply r = net.replies.front();
+  net.replies.pop_front();
+  if ((int32_t)(r.atMs - millis()) > 0) HostClockSet(r.atMs);
+
+  HttpRespReset(resp);
+  HttpRespFeed(resp, (const uint8_t*)r.raw.data(), r.raw.size());
+  return HttpRespDone(resp);
+}
+
+static void netClose() {
+  net.open = false;
+}
+
+static void onBody(const String&) {}
+
+static const WindowOps ops = { build, takeSeq, netOpen, netSend, netRecv, netClose, onBody };
+
+// ===================== HELPERS =====================
+static uint32_t seq, lastAck;
+
+static void fillRing(uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    SampleRec r{};
+    r.ts = 1760000000 + total;
+    r.nCurrent = 1;
+    r.nTemp = 1;
+    RingStoreAppend(r);
+    total++;
+  }
+}
+
+// сеансы подряд, пока кольцо не опустеет; число сеансов
+static int drainAll(int maxSessions = 50) {
+  for (int i = 0; i < maxSessions; i++) {
+    net.sends = 0;
+    if (UplinkWindowSend(seq, lastAck) == WIN_EMPTY) return i;
+  }
+  return -1;
+}
+
+static void assertAllDeliveredOnce() {
+  TEST_ASSERT_EQUAL(0, RingStoreCountApprox());
+  TEST_ASSERT_EQUAL(total, srv.stored.size());
+  for (size_t i = 1; i < seqsTaken.size(); i++) TEST_ASSERT_GREATER_THAN(seqsTaken[i - 1], seqsTaken[i]);
+}
+
+void setUp() {
+  HostFsClear();
+  HostNvsClear();
+  HostClockSet(0);
+  RingStoreBegin("/queue.bin", 16 + 40 * 512);
+  srv = StandIn{};
+  net = Net{};
+  seqsTaken.clear();
+  total = 0;
+  seq = 1;
+  lastAck = 0;
+  UplinkWindowInit(ops);
+}
+
+void tearDown() {}
+
+// ===================== TESTS =====================
+static void test_drain_in_one_session() {
+  fillRing(200);
+  TEST_ASSERT_EQUAL(1, drainAll());
+  assertAllDeliveredOnce();
+  TEST_ASSERT_EQUAL(0, srv.replays);
+  TEST_ASSERT_EQUAL(srv.ack, lastAck);
+}
+
+// выигрыш конвейера: окно 4 против stop-and-wait на одной и той же сети
+static void test_window_speedup() {
+  fillRing(200);
+  uint32_t t0 = millis();
+  UplinkWindowInit(ops, 1);
+  drainAll();
+  uint32_t stopAndWait = millis() - t0;
+  assertAllDeliveredOnce();
+
+  setUp();
+  fillRing(200);
+  t0 = millis();
+  drainAll();
+  uint32_t windowed = millis() - t0;
+  assertAllDeliveredOnce();
+
+  char msg[128];
+  snprintf(msg, sizeof(msg), "200 records, RTT %u ms: window 1 -> %u ms, window %u -> %u ms (x%.1f)",
+           (unsigned)(2 * net.oneWayMs), (unsigned)stopAndWait, (unsigned)UPLINK_WINDOW, (unsigned)windowed,
+           (double)stopAndWait / windowed);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN(stopAndWait / 2, windowed);
+}
+
+// ответ потерян, хотя сервер пакет принял: повтор тем же блобом подтверждается без дублей
+static void test_lost_ack_is_resent_as_same_blob() {
+  fillRing(80);
+  net.loseResponseOf = 2;
+  // сеанс сорвался (FSM уйдёт в backoff), но два пакета до потерянного подтверждены
+  TEST_ASSERT_EQUAL(WIN_FAIL, UplinkWindowSend(seq, lastAck));
+  TEST_ASSERT_EQUAL(80 - 2 * DATA_BATCH_MAX, RingStoreCountApprox());
+  net.loseResponseOf = -1;
+  drainAll();
+  assertAllDeliveredOnce();
+  TEST_ASSERT_GREATER_THAN(0, srv.replays);
+  TEST_ASSERT_EQUAL(total, srv.inserted);   // ни одна запись не легла дважды
+}
+
+// сервер не принял пакет: следующие в окне получают gap, сеанс дочитывает ответы,
+// следующий сеанс начинает с непринятого
+static void test_gap_after_server_error() {
+  fillRing(80);
+  srv.failOnce.insert(3);
+  drainAll();
+  assertAllDeliveredOnce();
+  TEST_ASSERT_GREATER_THAN(0, srv.gaps);
+  TEST_ASSERT_EQUAL(total, srv.inserted);
+}
+
+// обрыв посреди окна: с кольца снято только подтверждённое, остаток — в следующем сеансе
+static void test_connection_drop() {
+  fillRing(120);
+  net.dropAfterSends = 5;
+  TEST_ASSERT_EQUAL(WIN_FAIL, UplinkWindowSend(seq, lastAck));
+  // сервер принял больше, чем успел подтвердить: с кольца снято только покрытое ack
+  TEST_ASSERT_GREATER_THAN(lastAck, srv.ack);
+  TEST_ASSERT_EQUAL(total - lastAck * DATA_BATCH_MAX, RingStoreCountApprox());
+
+  net.dropAfterSends = 0;   // в следующем сеансе — ни одного запроса
+  TEST_ASSERT_EQUAL(WIN_FAIL, UplinkWindowSend(seq, lastAck));
+
+  net.dropAfterSends = -1;
+  drainAll();
+  assertAllDeliveredOnce();
+}
+
+// устройство не зарегистрировано: кольцо не трогаем, заготовки выбрасываем
+static void test_notreg() {
+  fillRing(20);
+  srv.registered = false;
+  TEST_ASSERT_EQUAL(WIN_NOTREG, UplinkWindowSend(seq, lastAck));
+  TEST_ASSERT_EQUAL(20, RingStoreCountApprox());
+
+  srv.registered = true;
+  drainAll();
+  assertAllDeliveredOnce();
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_drain_in_one_session);
+  RUN_TEST(test_window_speedup);
+  RUN_TEST(test_lost_ack_is_resent_as_same_blob);
+  RUN_TEST(test_gap_after_server_error);
+  RUN_TEST(test_connection_drop);
+  RUN_TEST(test_notreg);
+  return UNITY_END();
+}
@@ -0,0 +1,125 @@
+<?php
+// udp.php — приёмник датаграммного аплинка (кадры — src/datagram.h, обмен — DATAGRAM в src/gsm_uplink.cpp)
+// запуск: php udp.php [port]   (порт по умолчанию UDP_PORT из config.php или 5684)
+//
+// запрос: 'D' | ver | idLen | device_id | seq u32 LE | blobLen u16 LE | blob
+// ответ:  'A' | ver | seq u32 LE | blobLen u16 LE | aes_encrypt_blob(json)
+// blob — тот же формат, что и тело POST /data; правила приёма те же
+// эталон для тестов прошивки — scripts/udp_ref_receiver.py: правила менять вместе
+
+declare(strict_types=1);
+
+require_once __DIR__ . "/config.php";
+require_once __DIR__ . "/crypto.php";
+require_once __DIR__ . "/logger.php";
+require_once __DIR__ . "/db.php";
+
+const DG_REQ = "D";
+const DG_ACK = "A";
+const DG_VERSION = 1;
+
+function dg_ack(int $seq, array $data): string {
+    $data["ts"] = time();
+    $blob = aes_encrypt_blob(SERVER_CRYPTO_PASS, json_encode($data, JSON_UNESCAPED_UNICODE));
+    return DG_ACK . chr(DG_VERSION) . pack("V", $seq) . pack("v", strlen($blob)) . $blob;
+}
+
+/**
+ * Разбор и приём одной датаграммы.
+ * @return string|null ответ или null (мусор — не отвечаем)
+ */
+function dg_handle(string $pkt): ?string {
+    $n = strlen($pkt);
+    if ($n < 3 || $pkt[0] !== DG_REQ || ord($pkt[1]) !== DG_VERSION) return null;
+
+    $idLen = ord($pkt[2]);
+    if ($n < 3 + $idLen + 6) return null;
+    $hdrId   = substr($pkt, 3, $idLen);
+    $seq     = unpack("V", substr($pkt, 3 + $idLen, 4))[1];
+    $blobLen = unpack("v", substr($pkt, 7 + $idLen, 2))[1];
+    if ($n !== 9 + $idLen + $blobLen) return null;
+
+    [$ok, $plain, $err] = aes_decrypt_blob(SERVER_CRYPTO_PASS, substr($pkt, 9 + $idLen));
+    if ($ok) [$ok, $plain, $err] = lz_unpack_plain($plain);
+    if (!$ok) {
+        if (DEBUG_LOG) log_line("UDP_BADENC", ["err" => $err]);
+        return null;   // без ключа ответить всё равно нечем
+    }
+
+    $payload   = json_decode($plain, true);
+    $device_id = $payload["device_id"] ?? "";
+    $nonce     = $payload["nonce"] ?? "";
+    $records   = $payload["records"] ?? null;
+
+    if (!is_string($device_id) || $device_id !== $hdrId ||
+        !is_string($nonce) || $nonce === "" ||
+        !is_array($records) || (int)($payload["seq"] ?? -1) !== $seq) {
+        return dg_ack($seq, ["status" => "badreq"]);
+    }
+
+    if (!is_registered($device_id)) {
+        return dg_ack($seq, ["status" => "notreg"]);
+    }
+
+    $chained = isset($payload["prev"]);
+    $prev = (int)($payload["prev"] ?? 0);
+
+    // повтор той же датаграммы (потерялся ack) — уже записано, подтверждаем снова.
+    // nonce запоминается только вместе с записью (ниже, в той же транзакции):
+    // датаграмма, отвергнутая по gap, при повторе принимается как новая
+    if (nonce_seen($device_id, $nonce)) {
+        if (DEBUG_LOG) log_line("UDP_RETRANSMIT", ["device_id" => $device_id, "seq" => $seq]);
+        return dg_ack($seq, ["status" => "OK", "ack" => $seq]);
+    }
+
+    $ack = last_ack($device_id);
+    if ($chained && $prev > $ack) {
+        return dg_ack($seq, ["status" => "gap", "ack" => $ack]);
+    }
+
+    $db = pdo();
+    $db->beginTransaction();
+
+    $ins = data_insert_stmt();
+
+    $saved = 0;
+    foreach ($records as $r) {
+        if (is_array($r)) $saved += data_insert($ins, $device_id, $r);
+    }
+
+    if ($chained && $seq > $ack) set_last_ack($device_id, $seq);
+    nonce_store($device_id, $nonce);
+    $db->commit();
+
+    if (DEBUG_LOG) {
+        log_line("UDP_DATA_SAVED", ["device_id" => $device_id, "seq" => $seq, "saved_rows" => $saved]);
+    }
+
+    return dg_ack($seq, ["status" => "OK", "ack" => $seq]);
+}
+
+// -------------------------
+// main loop
+// -------------------------
+$port = (int)($argv[1] ?? (defined("UDP_PORT") ? UDP_PORT : 5684));
+$sock = stream_socket_server("udp://0.0.0.0:" . $port, $errno, $errstr, STREAM_SERVER_BIND);
+if (!$sock) {
+    fwrite(STDERR, "bind failed: $errstr ($errno)\n");
+    exit(1);
+}
+
+init_db();
+fwrite(STDERR, "udp uplink listening on :$port\n");
+
+while (true) {
+    $pkt = stream_socket_recvfrom($sock, 65535, 0, $peer);
+    if ($pkt === false || $pkt === "") continue;
+
+    try {
+        $reply = dg_handle($pkt);
+        if ($reply !== null) stream_socket_sendto($sock, $reply, 0, $peer);
+    } catch (Throwable $e) {
+        if (defined("DEBUG_LOG") && DEBUG_LOG) log_exception($e, "UDP");
+        if (pdo()->inTransaction()) pdo()->rollBack();
+    }
+}